@@ -0,0 +1,195 @@
+// Rejeu d'une capture du chemin de réception (PacketCapture) dans PacketManager et TopologyDatabase,
+// aussi vite que possible : débit maximal de traitement des paquets et reconstitution hors ligne de
+// la LSDB du routeur capturé. L'horloge protocolaire est virtuelle et suit les horodatages de la
+// capture : âges des LSA, temporisations et retransmissions se déroulent comme sur le routeur.
+// Les émissions (acks, relais) sont comptées puis jetées. Résultats en JSON sur stdout.
+//
+//   packet_replay <capture> [--lsdb]
+#include "../src/PacketCapture.hpp"
+#include "../src/PacketManager.hpp"
+#include "../src/LinkStateManager.hpp"
+#include "../src/TopologyDatabase.hpp"
+#include "../src/TimerWheel.hpp"
+#include "../src/Metrics.hpp"
+#include "../src/Transport.hpp"
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    // Livre un datagramme de la capture à la fois ; les émissions ne sortent pas du processus
+    class ReplayTransport : public Transport
+    {
+    public:
+        void push(const PacketCaptureReader::Record &record) { ready.push_back(&record); }
+
+        bool open(int) override { return true; }
+        void close() override {}
+
+        ssize_t receive(char *buffer, size_t size, std::string &senderIp) override
+        {
+            if (ready.empty())
+                return 0;
+            const PacketCaptureReader::Record *record = ready.front();
+            ready.pop_front();
+            size_t len = std::min(size, record->payload.size());
+            std::memcpy(buffer, record->payload.data(), len);
+            senderIp = record->senderIp;
+            return static_cast<ssize_t>(len);
+        }
+
+        bool send(const std::string &, int, const std::string &payload) override
+        {
+            sent++;
+            sentBytes += payload.size();
+            return true;
+        }
+
+        // Rejeu pas à pas : jamais d'attente
+        void wait(std::chrono::nanoseconds) override {}
+        void wake() override {}
+
+        size_t sent = 0;
+        size_t sentBytes = 0;
+
+    private:
+        std::deque<const PacketCaptureReader::Record *> ready;
+    };
+
+    double millis(Clock::duration d)
+    {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+
+    uint64_t counterValue(MetricsRegistry &metrics, const std::string &name, const MetricsRegistry::Labels &labels)
+    {
+        return metrics.counter(name, "", labels).get();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string path;
+    bool dumpLsdb = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--lsdb")
+        {
+            dumpLsdb = true;
+        }
+        else if (path.empty() && arg[0] != '-')
+        {
+            path = arg;
+        }
+        else
+        {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty())
+    {
+        std::cerr << "usage: " << argv[0] << " <capture> [--lsdb]" << std::endl;
+        return 1;
+    }
+
+    PacketCaptureReader reader;
+    std::string error;
+    if (!reader.open(path, error))
+    {
+        std::cerr << path << ": " << error << std::endl;
+        return 1;
+    }
+    const auto &header = reader.header();
+    const std::string hostname = header.hostname;
+    const int port = static_cast<int>(header.port);
+
+    // Chargement complet avant la mesure : le débit ne dépend pas du disque
+    std::vector<PacketCaptureReader::Record> records;
+    PacketCaptureReader::Record record;
+    size_t bytes = 0;
+    while (reader.next(record))
+    {
+        bytes += record.payload.size();
+        records.push_back(std::move(record));
+    }
+    std::cerr << "replaying " << records.size() << " packets captured by " << hostname << std::endl;
+
+    VirtualClock clock;
+    TimerWheel timers(clock);
+    MetricsRegistry metrics;
+    ReplayTransport transport;
+    PacketManager pm(timers, metrics, transport);
+    LinkStateManager lsm(timers);
+    TopologyDatabase topoDb(timers);
+
+    // Instants de la capture décalés sur l'origine de l'horloge virtuelle
+    const auto captureStart = ProtocolClock::time_point(std::chrono::nanoseconds(header.protocolClockNs));
+    const auto origin = clock.now();
+
+    // Les réponses NEIGHBOR_RESPONSE s'affichent sur stdout, réservé au rapport
+    std::cout.setstate(std::ios::badbit);
+    auto start = Clock::now();
+    for (const auto &captured : records)
+    {
+        clock.advanceTo(origin + (captured.at - captureStart));
+        timers.advance(clock.now());
+        transport.push(captured);
+        pm.pollPackets(port, lsm, hostname, topoDb);
+    }
+    auto elapsed = Clock::now() - start;
+
+    std::cout.clear();
+
+    json accepted = json::object();
+    for (const char *type : {"HELLO", "LSA", "LSA_COMPRESSED", "LSA_FULL_COMPRESSED", "LS_ACK", "LS_REQUEST",
+                             "DB_DESCRIPTION", "DIGEST_QUERY", "DIGEST_REPLY", "NEIGHBOR_REQUEST",
+                             "NEIGHBOR_RESPONSE", "other"})
+    {
+        if (uint64_t count = counterValue(metrics, "ospf_packets_received_total", {{"type", type}}))
+            accepted[type] = count;
+    }
+    json dropped = json::object();
+    for (const char *reason : {"hmac_invalid", "hmac_missing", "malformed"})
+    {
+        dropped[reason] = counterValue(metrics, "ospf_packets_dropped_total", {{"reason", reason}});
+    }
+
+    double wallMs = millis(elapsed);
+    double seconds = wallMs / 1000.0;
+    json report = {
+        {"benchmark", "packet_replay"},
+        {"format_version", 1},
+        {"capture", path},
+        {"hostname", hostname},
+        {"packets", records.size()},
+        {"bytes", bytes},
+        {"captured_span_ms", records.empty() ? 0.0 : millis(records.back().at - records.front().at)},
+        {"wall_time_ms", wallMs},
+        {"packets_per_sec", seconds > 0 ? records.size() / seconds : 0.0},
+        {"mbytes_per_sec", seconds > 0 ? bytes / seconds / 1e6 : 0.0},
+        {"accepted", accepted},
+        {"dropped", dropped},
+        {"datagrams_sent", transport.sent},
+        {"lsdb", {{"lsa_count", topoDb.getLSACount()}, {"digest_root", topoDb.getDigestRoot()}}}};
+    if (dumpLsdb)
+    {
+        json lsdb = json::object();
+        for (const auto &[host, lsa] : topoDb.lsaMap)
+        {
+            lsdb[host] = lsa;
+        }
+        report["lsdb"]["lsas"] = lsdb;
+    }
+    std::cout << report.dump(2) << std::endl;
+    return 0;
+}
@@ -0,0 +1,391 @@
+// Banc d'essai SPF/LSDB : topologies synthétiques chargées via TopologyDatabase::updateLSA,
+// puis mesure de l'ingestion, de computeRoutingTable et de l'empreinte mémoire.
+// Résultats en JSON sur stdout (progression sur stderr) pour suivre les régressions.
+//
+//   spf_benchmark [--topologies grid,ring,geometric,clos] [--sizes 10,100,1000,10000,50000]
+//                 [--runs N] [--seed S]
+#include "../src/TopologyDatabase.hpp"
+#include "../src/TimerWheel.hpp"
+#include "../src/Metrics.hpp"
+#include "../src/utils.hpp"
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    struct Topology
+    {
+        std::vector<std::vector<size_t>> adjacency; // routeur -> voisins (liens symétriques)
+        size_t source = 0;                         // Routeur dont on calcule la table
+    };
+
+    void link(Topology &topo, size_t a, size_t b)
+    {
+        if (a == b)
+            return;
+        topo.adjacency[a].push_back(b);
+        topo.adjacency[b].push_back(a);
+    }
+
+    // Grille 4-connexe au plus proche du carré
+    Topology makeGrid(size_t n)
+    {
+        Topology topo;
+        topo.adjacency.resize(n);
+        size_t width = std::max<size_t>(1, static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(n)))));
+        for (size_t i = 0; i < n; i++)
+        {
+            if ((i + 1) % width != 0 && i + 1 < n)
+                link(topo, i, i + 1);
+            if (i + width < n)
+                link(topo, i, i + width);
+        }
+        return topo;
+    }
+
+    Topology makeRing(size_t n)
+    {
+        Topology topo;
+        topo.adjacency.resize(n);
+        for (size_t i = 0; n > 2 && i < n; i++)
+        {
+            link(topo, i, (i + 1) % n);
+        }
+        if (n == 2)
+            link(topo, 0, 1);
+        return topo;
+    }
+
+    // Graphe géométrique aléatoire dans le carré unité, rayon au-dessus du seuil de connexité
+    // (r² = 2 ln n / πn) ; voisinage trouvé par maillage de cellules de côté r.
+    // Les composantes isolées restantes sont raccordées à leur voisin d'indice précédent.
+    Topology makeGeometric(size_t n, std::mt19937_64 &rng)
+    {
+        Topology topo;
+        topo.adjacency.resize(n);
+        if (n < 2)
+            return topo;
+
+        std::uniform_real_distribution<double> coord(0.0, 1.0);
+        std::vector<std::pair<double, double>> points(n);
+        for (auto &p : points)
+        {
+            p = {coord(rng), coord(rng)};
+        }
+
+        double radius = std::sqrt(2.0 * std::log(static_cast<double>(n)) / (M_PI * n));
+        size_t cells = std::max<size_t>(1, static_cast<size_t>(1.0 / radius));
+        std::vector<std::vector<size_t>> grid(cells * cells);
+        auto cellOf = [&](double v)
+        { return std::min(cells - 1, static_cast<size_t>(v * cells)); };
+        for (size_t i = 0; i < n; i++)
+        {
+            grid[cellOf(points[i].second) * cells + cellOf(points[i].first)].push_back(i);
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            size_t cx = cellOf(points[i].first), cy = cellOf(points[i].second);
+            for (size_t y = cy > 0 ? cy - 1 : 0; y <= std::min(cells - 1, cy + 1); y++)
+            {
+                for (size_t x = cx > 0 ? cx - 1 : 0; x <= std::min(cells - 1, cx + 1); x++)
+                {
+                    for (size_t j : grid[y * cells + x])
+                    {
+                        if (j <= i)
+                            continue;
+                        double dx = points[i].first - points[j].first, dy = points[i].second - points[j].second;
+                        if (dx * dx + dy * dy <= radius * radius)
+                            link(topo, i, j);
+                    }
+                }
+            }
+        }
+
+        // Raccordement : chaque composante est reliée à la précédente par un seul lien
+        std::vector<size_t> component(n, SIZE_MAX);
+        size_t previousRoot = SIZE_MAX;
+        for (size_t root = 0; root < n; root++)
+        {
+            if (component[root] != SIZE_MAX)
+                continue;
+            std::vector<size_t> stack{root};
+            component[root] = root;
+            while (!stack.empty())
+            {
+                size_t u = stack.back();
+                stack.pop_back();
+                for (size_t v : topo.adjacency[u])
+                {
+                    if (component[v] == SIZE_MAX)
+                    {
+                        component[v] = root;
+                        stack.push_back(v);
+                    }
+                }
+            }
+            if (previousRoot != SIZE_MAX)
+                link(topo, previousRoot, root);
+            previousRoot = root;
+        }
+        return topo;
+    }
+
+    // Leaf-spine à deux étages : chaque feuille reliée à chaque spine
+    Topology makeClos(size_t n)
+    {
+        Topology topo;
+        topo.adjacency.resize(n);
+        size_t spines = std::clamp<size_t>(static_cast<size_t>(std::sqrt(static_cast<double>(n)) / 4), 2, 32);
+        spines = std::min(spines, n > 1 ? n - 1 : 1);
+        for (size_t leaf = spines; leaf < n; leaf++)
+        {
+            for (size_t spine = 0; spine < spines; spine++)
+            {
+                link(topo, leaf, spine);
+            }
+        }
+        topo.source = spines < n ? spines : 0; // Calcul depuis une feuille
+        return topo;
+    }
+
+    std::string routerName(size_t i)
+    {
+        return "R_" + std::to_string(i);
+    }
+
+    // LSA au format de RoutingDaemon::originateLSA : un réseau /24 par routeur, coûts variés
+    std::vector<json> buildLSAs(const Topology &topo, int sequence, std::mt19937_64 &rng)
+    {
+        std::uniform_int_distribution<int> cost(1, 10);
+        std::vector<json> lsas;
+        lsas.reserve(topo.adjacency.size());
+        for (size_t i = 0; i < topo.adjacency.size(); i++)
+        {
+            std::vector<std::string> neighbors;
+            std::vector<double> capacities;
+            std::vector<int> costs;
+            for (size_t j : topo.adjacency[i])
+            {
+                neighbors.push_back(routerName(j));
+                capacities.push_back(1000.0);
+                costs.push_back(cost(rng));
+            }
+
+            uint32_t base = 0x0A000000u + (static_cast<uint32_t>(i) << 8); // 10.x.y.0/24
+            std::string network = std::to_string(base >> 24) + "." + std::to_string((base >> 16) & 0xFF) + "." +
+                                  std::to_string((base >> 8) & 0xFF) + ".0/24";
+
+            json lsa = {
+                {"type", "LSA"},
+                {"hostname", routerName(i)},
+                {"sequence_number", sequence},
+                {"age", 0},
+                {"interfaces", json::array()},
+                {"neighbors", neighbors},
+                {"networks", {network}},
+                {"network_interfaces", json::array()},
+                {"link_capacities", capacities},
+                {"link_costs", costs},
+                {"link_states", std::vector<bool>(neighbors.size(), true)}};
+            lsa["hmac"] = toHex(computeHMAC(lsa.dump(), "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV"));
+            lsas.push_back(std::move(lsa));
+        }
+        return lsas;
+    }
+
+    // Mémoire résidente (octets), 0 si /proc indisponible
+    size_t residentBytes()
+    {
+        std::ifstream statm("/proc/self/statm");
+        size_t pages = 0, resident = 0;
+        if (!(statm >> pages >> resident))
+            return 0;
+        return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    // Octets alloués sur le tas : insensible à la mémoire libérée mais conservée par l'allocateur
+    // entre deux cas, contrairement au RSS. 0 hors glibc.
+    size_t heapBytes()
+    {
+#ifdef __GLIBC__
+        struct mallinfo2 info = mallinfo2();
+        return info.uordblks + info.hblkhd;
+#else
+        return 0;
+#endif
+    }
+
+    double millis(Clock::duration d)
+    {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+
+    json runCase(const std::string &name, size_t n, int runs, uint64_t seed)
+    {
+        std::mt19937_64 rng(seed ^ (n * 0x9E3779B97F4A7C15ull));
+        Topology topo = name == "grid"        ? makeGrid(n)
+                        : name == "ring"      ? makeRing(n)
+                        : name == "geometric" ? makeGeometric(n, rng)
+                                              : makeClos(n);
+
+        size_t links = 0;
+        for (const auto &neighbors : topo.adjacency)
+        {
+            links += neighbors.size();
+        }
+        links /= 2;
+
+        auto lsas = buildLSAs(topo, 1, rng);
+        size_t encodedBytes = 0;
+        for (const auto &lsa : lsas)
+        {
+            encodedBytes += lsa.dump().size();
+        }
+
+        // La roue n'est pas démarrée : les temporisations de vieillissement restent en attente
+        TimerWheel timers;
+        size_t heapBefore = heapBytes();
+        auto db = std::make_unique<TopologyDatabase>(timers);
+
+        auto ingestStart = Clock::now();
+        for (const auto &lsa : lsas)
+        {
+            db->updateLSA(lsa);
+        }
+        auto ingestTime = Clock::now() - ingestStart;
+        size_t heapAfter = heapBytes();
+
+        // Réinstallation d'instances plus récentes (chemin de mise à jour, pas d'insertion)
+        auto refreshed = buildLSAs(topo, 2, rng);
+        auto updateStart = Clock::now();
+        for (const auto &lsa : refreshed)
+        {
+            db->updateLSA(lsa);
+        }
+        auto updateTime = Clock::now() - updateStart;
+        refreshed.clear();
+
+        // computeRoutingTable écrit la LSDB sur stdout : flux neutralisé pendant la mesure
+        LatencyHistogram spf;
+        size_t routes = 0;
+        std::cout.setstate(std::ios::badbit);
+        for (int run = 0; run < runs; run++)
+        {
+            auto start = Clock::now();
+            auto table = db->computeRoutingTable(routerName(topo.source));
+            spf.record(Clock::now() - start);
+            routes = table.table.size();
+        }
+        std::cout.clear();
+
+        double ingestMs = millis(ingestTime);
+        return {
+            {"topology", name},
+            {"routers", n},
+            {"links", links},
+            {"lsa_bytes", encodedBytes},
+            {"ingest_ms", ingestMs},
+            {"ingest_lsa_per_sec", ingestMs > 0 ? n / (ingestMs / 1000.0) : 0.0},
+            {"update_ms", millis(updateTime)},
+            {"spf_runs", spf.count()},
+            {"spf_p50_ms", millis(spf.quantile(0.5))},
+            {"spf_p99_ms", millis(spf.quantile(0.99))},
+            {"spf_mean_ms", spf.count() ? millis(spf.sum()) / spf.count() : 0.0},
+            {"routes", routes},
+            {"lsdb_heap_bytes", heapAfter > heapBefore ? heapAfter - heapBefore : 0},
+            {"rss_bytes", residentBytes()}};
+    }
+
+    std::vector<std::string> parseList(const std::string &value)
+    {
+        return split(value, ',');
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> topologies = {"grid", "ring", "geometric", "clos"};
+    std::vector<size_t> sizes = {10, 100, 1000, 10000, 50000};
+    int runs = 0; // 0 : adapté à la taille
+    uint64_t seed = 42;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string value = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--topologies" && !value.empty())
+        {
+            topologies = parseList(value);
+            i++;
+        }
+        else if (arg == "--sizes" && !value.empty())
+        {
+            sizes.clear();
+            for (const auto &size : parseList(value))
+            {
+                sizes.push_back(std::stoul(size));
+            }
+            i++;
+        }
+        else if (arg == "--runs" && !value.empty())
+        {
+            runs = std::stoi(value);
+            i++;
+        }
+        else if (arg == "--seed" && !value.empty())
+        {
+            seed = std::stoull(value);
+            i++;
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0]
+                      << " [--topologies grid,ring,geometric,clos] [--sizes 10,100,...] [--runs N] [--seed S]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    for (const auto &name : topologies)
+    {
+        if (name != "grid" && name != "ring" && name != "geometric" && name != "clos")
+        {
+            std::cerr << "Unknown topology: " << name << std::endl;
+            return 1;
+        }
+    }
+
+    json results = json::array();
+    for (const auto &name : topologies)
+    {
+        for (size_t n : sizes)
+        {
+            int caseRuns = runs > 0 ? runs : (n <= 1000 ? 50 : n <= 10000 ? 10 : 3);
+            std::cerr << "bench " << name << " n=" << n << " runs=" << caseRuns << std::endl;
+            results.push_back(runCase(name, n, caseRuns, seed));
+        }
+    }
+
+    json report = {
+        {"benchmark", "spf_lsdb"},
+        {"format_version", 1},
+        {"seed", seed},
+        {"hardware_threads", std::thread::hardware_concurrency()},
+        {"results", results}};
+    std::cout << report.dump(2) << std::endl;
+    return 0;
+}
@@ -0,0 +1,709 @@
+// Simulateur de réseau : des centaines de RoutingDaemon dans un seul processus, reliés par
+// SimFabric (latence, perte, débit) avec un plan de transfert StubFib par routeur.
+// Mesure le temps de convergence (tables complètes et chemins cohérents de bout en bout)
+// et le nombre de messages, au démarrage puis après l'événement du scénario, ainsi que la
+// distribution des latences de propagation des LSA (origination -> acceptation, SPF, FIB) sur
+// l'ensemble des routeurs. Par défaut sur
+// horloge virtuelle : démons pas à pas, résultat reproductible pour une graine donnée et
+// heures de fonctionnement simulées en secondes (--soak-s). Rapport JSON sur stdout ;
+// --trace écrit les spans de tous les routeurs (un processus chacun) au format Chrome/Perfetto.
+//
+//   network_simulator [--topology line|ring|grid|clos] [--routers N] [--latency-ms L]
+//                     [--loss P] [--bandwidth-mbps B] [--seed S] [--timeout-s T]
+//                     [--scenario boot|link-failure|router-stop] [--flood-reduction]
+//                     [--soak-s D] [--clock virtual|real] [--trace FILE]
+#include "SimFabric.hpp"
+#include "../src/RoutingDaemon.hpp"
+#include "../src/FibBackend.hpp"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <functional>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    constexpr int PROTOCOL_PORT = 5000;
+    // Anneau de spans par routeur et par thread, réduit : des centaines de démons par processus
+    constexpr int TRACE_EVENTS_PER_THREAD = 4096;
+    constexpr std::chrono::milliseconds POLL_INTERVAL{50};
+    constexpr std::chrono::milliseconds SOAK_CHECK_INTERVAL{1000};
+
+    struct SimLink
+    {
+        size_t a = 0;
+        size_t b = 0;
+        Ipv4Prefix subnet;
+        bool up = true;
+    };
+
+    struct SimRouter
+    {
+        std::vector<LocalInterfaceAddress> addresses;
+        std::set<std::string> attached; // Préfixes directement connectés
+        StubFib *fib = nullptr;         // Possédé par le démon
+        const Transport *transport = nullptr; // Idem
+        std::unique_ptr<RoutingDaemon> daemon;
+        bool active = false;
+    };
+
+    struct Network
+    {
+        std::vector<SimRouter> routers;
+        std::vector<SimLink> links;
+        std::map<std::string, size_t> ipOwner;          // Adresse d'interface -> routeur
+        std::map<std::string, std::vector<size_t>> owners; // Préfixe -> routeurs connectés
+    };
+
+    std::vector<std::pair<size_t, size_t>> makeEdges(const std::string &topology, size_t n)
+    {
+        std::vector<std::pair<size_t, size_t>> edges;
+        if (topology == "line" || topology == "ring")
+        {
+            for (size_t i = 0; i + 1 < n; i++)
+                edges.push_back({i, i + 1});
+            if (topology == "ring" && n > 2)
+                edges.push_back({n - 1, 0});
+        }
+        else if (topology == "grid")
+        {
+            size_t width = std::max<size_t>(1, static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(n)))));
+            for (size_t i = 0; i < n; i++)
+            {
+                if ((i + 1) % width != 0 && i + 1 < n)
+                    edges.push_back({i, i + 1});
+                if (i + width < n)
+                    edges.push_back({i, i + width});
+            }
+        }
+        else if (topology == "clos")
+        {
+            // Feuilles reliées à chaque épine
+            size_t spines = std::min<size_t>(8, std::max<size_t>(2, n / 10));
+            for (size_t leaf = spines; leaf < n; leaf++)
+            {
+                for (size_t spine = 0; spine < spines; spine++)
+                    edges.push_back({spine, leaf});
+            }
+        }
+        return edges;
+    }
+
+    std::string address(uint32_t ip)
+    {
+        return std::to_string(ip >> 24) + "." + std::to_string((ip >> 16) & 255) + "." +
+               std::to_string((ip >> 8) & 255) + "." + std::to_string(ip & 255);
+    }
+
+    // Lien k : 10.(k>>8).(k&255).0/24 (.1 et .2) ; réseau terminal du routeur i : 172.(16+(i>>8)).(i&255).0/24
+    Network buildNetwork(const std::string &topology, size_t n)
+    {
+        Network net;
+        net.routers.resize(n);
+        auto attach = [&net](size_t router, uint32_t ip)
+        {
+            auto &r = net.routers[router];
+            std::string ipStr = address(ip);
+            std::string prefix = Ipv4Prefix::fromAddress(ip, 24).toString();
+            r.addresses.push_back({ipStr, "sim" + std::to_string(r.addresses.size()), 24});
+            r.attached.insert(prefix);
+            net.ipOwner[ipStr] = router;
+            net.owners[prefix].push_back(router);
+        };
+
+        for (size_t i = 0; i < n; i++)
+        {
+            attach(i, (172u << 24) | ((16u + (i >> 8)) << 16) | ((i & 255) << 8) | 1u);
+        }
+        for (const auto &[a, b] : makeEdges(topology, n))
+        {
+            uint32_t base = (10u << 24) | (static_cast<uint32_t>(net.links.size()) << 8);
+            net.links.push_back({a, b, Ipv4Prefix::fromAddress(base, 24), true});
+            attach(a, base | 1u);
+            attach(b, base | 2u);
+        }
+        return net;
+    }
+
+    // Connexité des routeurs actifs sur les liens montés, sans l'élément exclu
+    bool connectedWithout(const Network &net, size_t skipRouter, size_t skipLink)
+    {
+        size_t n = net.routers.size();
+        std::vector<std::vector<size_t>> adjacency(n);
+        for (size_t k = 0; k < net.links.size(); k++)
+        {
+            const auto &link = net.links[k];
+            if (k == skipLink || !link.up || link.a == skipRouter || link.b == skipRouter)
+                continue;
+            adjacency[link.a].push_back(link.b);
+            adjacency[link.b].push_back(link.a);
+        }
+        size_t start = skipRouter == 0 ? 1 : 0;
+        std::vector<bool> seen(n, false);
+        std::vector<size_t> stack = {start};
+        seen[start] = true;
+        size_t reached = 1;
+        while (!stack.empty())
+        {
+            size_t current = stack.back();
+            stack.pop_back();
+            for (size_t next : adjacency[current])
+            {
+                if (!seen[next])
+                {
+                    seen[next] = true;
+                    reached++;
+                    stack.push_back(next);
+                }
+            }
+        }
+        return reached == n - (skipRouter < n ? 1 : 0);
+    }
+
+    // Latences de propagation des LSA rapportées par tous les démons, une instance par phase.
+    // Démons à threads : un rappel tardif peut viser la phase précédente, qui reste allouée.
+    class PropagationRecorder
+    {
+    public:
+        void beginPhase()
+        {
+            phases.push_back(std::make_unique<Stages>());
+            current.store(phases.back().get());
+        }
+
+        void observe(const RoutingDaemon::LsaPropagation &p)
+        {
+            Stages *stages = current.load();
+            if (!stages)
+                return;
+            stages->accepted.record(std::chrono::nanoseconds(p.acceptedNs - p.originatedNs));
+            stages->spf.record(std::chrono::nanoseconds(p.spfNs - p.originatedNs));
+            stages->fib.record(std::chrono::nanoseconds(p.fibNs - p.originatedNs));
+        }
+
+        // Quantiles de la phase courante, en millisecondes
+        json report() const
+        {
+            const Stages *stages = current.load();
+            json out = json::object();
+            if (!stages)
+                return out;
+            for (const auto &[name, histogram] : {std::pair<const char *, const LatencyHistogram *>{"accepted", &stages->accepted},
+                                                  {"spf", &stages->spf},
+                                                  {"fib", &stages->fib}})
+            {
+                auto ms = [histogram = histogram](double q)
+                { return std::chrono::duration<double, std::milli>(histogram->quantile(q)).count(); };
+                out[name] = {{"count", histogram->count()}, {"p50_ms", ms(0.5)}, {"p90_ms", ms(0.9)},
+                             {"p99_ms", ms(0.99)}, {"max_ms", ms(1.0)}};
+            }
+            return out;
+        }
+
+    private:
+        struct Stages
+        {
+            LatencyHistogram accepted;
+            LatencyHistogram spf;
+            LatencyHistogram fib;
+        };
+        std::vector<std::unique_ptr<Stages>> phases;
+        std::atomic<Stages *> current{nullptr};
+    };
+
+    struct ConvergenceState
+    {
+        bool converged = false;
+        size_t missingRoutes = 0; // Préfixes attendus absents de la FIB
+        size_t staleRoutes = 0;   // Routes vers des préfixes disparus
+        size_t brokenPaths = 0;   // Chemin incohérent (boucle, lien coupé, routeur arrêté)
+    };
+
+    // Chaque routeur actif doit joindre chaque préfixe annoncé par un routeur actif en suivant
+    // les next-hops des FIB, sans emprunter de lien coupé ni de routeur arrêté
+    ConvergenceState checkConvergence(const Network &net)
+    {
+        ConvergenceState state;
+        size_t n = net.routers.size();
+        std::vector<std::map<std::string, FibBackend::Route>> fibs(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            if (net.routers[i].active)
+                fibs[i] = net.routers[i].fib->snapshot();
+        }
+
+        std::map<std::string, size_t> linkIndex;
+        for (size_t k = 0; k < net.links.size(); k++)
+            linkIndex[net.links[k].subnet.toString()] = k;
+
+        for (const auto &[prefix, attachedRouters] : net.owners)
+        {
+            bool announced = false;
+            for (size_t owner : attachedRouters)
+                announced = announced || net.routers[owner].active;
+
+            // 0 : inconnu, 1 : en cours, 2 : joint, 3 : échec
+            std::vector<int> status(n, 0);
+            std::function<bool(size_t)> reaches = [&](size_t router) -> bool
+            {
+                if (net.routers[router].attached.count(prefix))
+                    return true;
+                if (status[router] == 1 || status[router] == 3)
+                    return false;
+                if (status[router] == 2)
+                    return true;
+                status[router] = 1;
+
+                bool ok = false;
+                auto route = fibs[router].find(prefix);
+                if (route != fibs[router].end())
+                {
+                    auto owner = net.ipOwner.find(route->second.nextHop);
+                    Ipv4Prefix hopNet;
+                    if (owner != net.ipOwner.end() && net.routers[owner->second].active &&
+                        Ipv4Prefix::parse(route->second.nextHop, hopNet))
+                    {
+                        std::string hopPrefix = Ipv4Prefix::fromAddress(hopNet.network, 24).toString();
+                        auto link = linkIndex.find(hopPrefix);
+                        ok = link != linkIndex.end() && net.links[link->second].up &&
+                             net.routers[router].attached.count(hopPrefix) && reaches(owner->second);
+                    }
+                }
+                status[router] = ok ? 2 : 3;
+                return ok;
+            };
+
+            for (size_t i = 0; i < n; i++)
+            {
+                const auto &router = net.routers[i];
+                if (!router.active || router.attached.count(prefix))
+                    continue;
+                bool installed = fibs[i].count(prefix) > 0;
+                if (!announced)
+                {
+                    state.staleRoutes += installed ? 1 : 0;
+                    continue;
+                }
+                if (!installed)
+                    state.missingRoutes++;
+                else if (!reaches(i))
+                    state.brokenPaths++;
+            }
+        }
+        state.converged = state.missingRoutes == 0 && state.staleRoutes == 0 && state.brokenPaths == 0;
+        return state;
+    }
+
+    json messageDelta(const SimFabric::Stats &before, const SimFabric::Stats &after)
+    {
+        json byType = json::object();
+        for (const auto &[type, count] : after.byType)
+        {
+            auto it = before.byType.find(type);
+            uint64_t delta = count - (it == before.byType.end() ? 0 : it->second);
+            if (delta > 0)
+                byType[type] = delta;
+        }
+        return {
+            {"sent", after.sent - before.sent},
+            {"delivered", after.delivered - before.delivered},
+            {"lost", after.lost - before.lost},
+            {"unreachable", after.unreachable - before.unreachable},
+            {"overflow", after.overflow - before.overflow},
+            {"bytes", after.bytes - before.bytes},
+            {"by_type", byType}};
+    }
+
+    // Fait avancer le réseau : démons à threads en temps réel, ou pas à pas sur horloge
+    // virtuelle (sauts d'échéance en échéance, exécution reproductible)
+    class Simulation
+    {
+    public:
+        Simulation(Network &net, SimFabric &fabric, VirtualClock *clock) : net(net), fabric(fabric), clock(clock) {}
+
+        ProtocolClock::time_point now() const { return clock ? clock->now() : Clock::now(); }
+
+        RoutingDaemon::ExecutionMode mode() const
+        {
+            return clock ? RoutingDaemon::ExecutionMode::Stepped : RoutingDaemon::ExecutionMode::Threaded;
+        }
+
+        // Appelle check() tous les 'interval' jusqu'à ce qu'il renvoie true ou jusqu'à 'until'
+        bool runUntil(ProtocolClock::time_point until, const std::function<bool()> &check,
+                      std::chrono::milliseconds interval = POLL_INTERVAL)
+        {
+            if (!clock)
+            {
+                while (true)
+                {
+                    if (check())
+                        return true;
+                    if (Clock::now() >= until)
+                        return false;
+                    std::this_thread::sleep_for(interval);
+                }
+            }
+
+            // Seuls les routeurs qui ont reçu un datagramme ou atteint leur échéance avancent ;
+            // premier pas pour tous (démarrage, événement du scénario)
+            std::vector<ProtocolClock::time_point> deadlines(net.routers.size(), ProtocolClock::time_point::min());
+            std::unordered_map<const Transport *, size_t> byTransport;
+            for (size_t i = 0; i < net.routers.size(); i++)
+                byTransport[net.routers[i].transport] = i;
+
+            auto nextCheck = clock->now();
+            while (true)
+            {
+                auto current = clock->now();
+                for (const Transport *receiver : fabric.deliverDue())
+                    deadlines[byTransport.at(receiver)] = current;
+                for (size_t i = 0; i < net.routers.size(); i++)
+                {
+                    auto &router = net.routers[i];
+                    if (router.active && deadlines[i] <= current)
+                    {
+                        router.daemon->step();
+                        deadlines[i] = router.daemon->nextDeadline();
+                    }
+                }
+
+                if (current >= nextCheck)
+                {
+                    if (check())
+                        return true;
+                    nextCheck = current + interval;
+                }
+                if (current >= until)
+                    return false;
+
+                auto next = std::min(until, nextCheck);
+                if (auto delivery = fabric.nextDelivery())
+                    next = std::min(next, *delivery);
+                for (size_t i = 0; i < net.routers.size(); i++)
+                {
+                    if (net.routers[i].active)
+                        next = std::min(next, deadlines[i]);
+                }
+                clock->advanceTo(std::max(next, current + std::chrono::microseconds(1)));
+            }
+        }
+
+        void stopRouter(SimRouter &router)
+        {
+            router.active = false;
+            router.daemon->stop();
+        }
+
+        void stopAll()
+        {
+            std::vector<std::thread> stoppers;
+            for (auto &router : net.routers)
+            {
+                if (!router.active)
+                    continue;
+                if (clock)
+                {
+                    stopRouter(router); // Aucun thread à joindre
+                    continue;
+                }
+                router.active = false;
+                stoppers.emplace_back([&router]()
+                                      { router.daemon->stop(); });
+            }
+            for (auto &stopper : stoppers)
+                stopper.join();
+        }
+
+    private:
+        Network &net;
+        SimFabric &fabric;
+        VirtualClock *clock; // nullptr : temps réel
+    };
+
+    template <typename Duration>
+    int64_t toMillis(Duration duration)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    }
+
+    // Attend la convergence (ou le délai) après l'événement déjà appliqué
+    json measurePhase(const std::string &name, Simulation &sim, Network &net, SimFabric &fabric,
+                      PropagationRecorder &propagation, std::chrono::seconds timeout,
+                      const std::function<void()> &event)
+    {
+        propagation.beginPhase();
+        auto before = fabric.getStats();
+        auto wallStart = Clock::now();
+        auto start = sim.now();
+        event();
+
+        ConvergenceState state;
+        sim.runUntil(start + timeout, [&]()
+                     { state = checkConvergence(net);
+                       return state.converged; });
+        auto elapsed = toMillis(sim.now() - start);
+        std::cerr << name << ": " << (state.converged ? "converged" : "timeout") << " after "
+                  << elapsed << " ms" << std::endl;
+
+        return {
+            {"phase", name},
+            {"converged", state.converged},
+            {"time_to_convergence_ms", elapsed},
+            {"wall_time_ms", toMillis(Clock::now() - wallStart)},
+            {"missing_routes", state.missingRoutes},
+            {"stale_routes", state.staleRoutes},
+            {"broken_paths", state.brokenPaths},
+            {"lsa_propagation", propagation.report()},
+            {"messages", messageDelta(before, fabric.getStats())}};
+    }
+
+    // Fonctionnement prolongé sans événement : rafraîchissements et vieillissement des LSA
+    json soakPhase(Simulation &sim, Network &net, SimFabric &fabric, PropagationRecorder &propagation,
+                   std::chrono::seconds duration)
+    {
+        propagation.beginPhase();
+        auto before = fabric.getStats();
+        auto wallStart = Clock::now();
+        size_t checks = 0;
+        size_t unconverged = 0;
+        ConvergenceState state;
+        sim.runUntil(sim.now() + duration, [&]()
+                     { state = checkConvergence(net);
+                       checks++;
+                       unconverged += state.converged ? 0 : 1;
+                       return false; },
+                     SOAK_CHECK_INTERVAL);
+        std::cerr << "soak: " << unconverged << "/" << checks << " checks not converged" << std::endl;
+
+        return {
+            {"phase", "soak"},
+            {"duration_s", duration.count()},
+            {"wall_time_ms", toMillis(Clock::now() - wallStart)},
+            {"converged", state.converged},
+            {"checks", checks},
+            {"unconverged_checks", unconverged},
+            {"lsa_propagation", propagation.report()},
+            {"messages", messageDelta(before, fabric.getStats())}};
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string topology = "ring";
+    std::string scenario = "boot";
+    size_t routerCount = 50;
+    SimFabric::LinkProfile profile;
+    uint64_t seed = 42;
+    std::chrono::seconds timeout{180};
+    std::chrono::seconds soak{0};
+    bool floodReduction = false;
+    bool virtualTime = true;
+    std::string tracePath;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string value = i + 1 < argc ? argv[i + 1] : "";
+        bool hasValue = !value.empty();
+        if (arg == "--topology" && hasValue)
+            topology = value;
+        else if (arg == "--scenario" && hasValue)
+            scenario = value;
+        else if (arg == "--routers" && hasValue)
+            routerCount = std::stoul(value);
+        else if (arg == "--latency-ms" && hasValue)
+            profile.latency = std::chrono::microseconds(static_cast<int64_t>(std::stod(value) * 1000));
+        else if (arg == "--loss" && hasValue)
+            profile.loss = std::stod(value);
+        else if (arg == "--bandwidth-mbps" && hasValue)
+            profile.bandwidthMbps = std::stod(value);
+        else if (arg == "--seed" && hasValue)
+            seed = std::stoull(value);
+        else if (arg == "--timeout-s" && hasValue)
+            timeout = std::chrono::seconds(std::stoi(value));
+        else if (arg == "--soak-s" && hasValue)
+            soak = std::chrono::seconds(std::stoll(value));
+        else if (arg == "--clock" && (value == "virtual" || value == "real"))
+            virtualTime = value == "virtual";
+        else if (arg == "--trace" && hasValue)
+            tracePath = value;
+        else if (arg == "--flood-reduction")
+        {
+            floodReduction = true;
+            continue;
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0]
+                      << " [--topology line|ring|grid|clos] [--routers N] [--latency-ms L] [--loss P]"
+                      << " [--bandwidth-mbps B] [--seed S] [--timeout-s T] [--soak-s D]"
+                      << " [--scenario boot|link-failure|router-stop] [--flood-reduction]"
+                      << " [--clock virtual|real] [--trace FILE]" << std::endl;
+            return 1;
+        }
+        i++;
+    }
+
+    if (topology != "line" && topology != "ring" && topology != "grid" && topology != "clos")
+    {
+        std::cerr << "Unknown topology: " << topology << std::endl;
+        return 1;
+    }
+    if (scenario != "boot" && scenario != "link-failure" && scenario != "router-stop")
+    {
+        std::cerr << "Unknown scenario: " << scenario << std::endl;
+        return 1;
+    }
+    if (routerCount < 2 || routerCount > 4096)
+    {
+        std::cerr << "--routers must be between 2 and 4096" << std::endl;
+        return 1;
+    }
+
+    // Horloge, tissu et agrégation des latences survivent aux démons et à leurs transports
+    VirtualClock virtualClock;
+    const ProtocolClock &clock = virtualTime ? static_cast<const ProtocolClock &>(virtualClock) : ProtocolClock::steady();
+    SimFabric fabric(profile, seed, clock);
+    PropagationRecorder propagation;
+    Network net = buildNetwork(topology, routerCount);
+    if (net.links.size() > 65536)
+    {
+        std::cerr << "Too many links for the 10.x.y.0/24 plan: " << net.links.size() << std::endl;
+        return 1;
+    }
+
+    // Élément du scénario choisi parmi ceux qui ne partitionnent pas le réseau
+    std::mt19937_64 rng(seed);
+    size_t target = 0;
+    if (scenario != "boot")
+    {
+        bool routerStop = scenario == "router-stop";
+        std::vector<size_t> candidates;
+        size_t count = routerStop ? net.routers.size() : net.links.size();
+        for (size_t k = 0; k < count; k++)
+        {
+            if (routerStop ? connectedWithout(net, k, SIZE_MAX) : connectedWithout(net, SIZE_MAX, k))
+                candidates.push_back(k);
+        }
+        if (candidates.empty())
+        {
+            std::cerr << "No " << (routerStop ? "router" : "link") << " can fail without partitioning "
+                      << topology << std::endl;
+            return 1;
+        }
+        target = candidates[std::uniform_int_distribution<size_t>(0, candidates.size() - 1)(rng)];
+    }
+
+    if (!virtualTime)
+        fabric.start();
+    Simulation sim(net, fabric, virtualTime ? &virtualClock : nullptr);
+
+    for (size_t i = 0; i < net.routers.size(); i++)
+    {
+        auto &router = net.routers[i];
+        RouterConfig config;
+        config.hostname = "R" + std::to_string(i + 1);
+        for (const auto &addr : router.addresses)
+        {
+            config.interfaces.push_back(addr.ip);
+            config.interfacesNames.push_back(addr.name);
+        }
+        config.port = PROTOCOL_PORT;
+        config.bfdEnabled = false;     // Socket UDP réelle : hors du tissu simulé
+        config.metricsEnabled = false; // Un seul port HTTP par machine
+        config.floodReduction = floodReduction;
+        config.traceEnabled = !tracePath.empty();
+        config.traceEventsPerThread = TRACE_EVENTS_PER_THREAD;
+
+        auto fib = std::make_unique<StubFib>(router.addresses);
+        router.fib = fib.get();
+        auto transport = fabric.attach(router.addresses);
+        router.transport = transport.get();
+        router.daemon = std::make_unique<RoutingDaemon>(config, std::move(transport), std::move(fib), clock);
+        router.daemon->setPropagationObserver([&propagation](const RoutingDaemon::LsaPropagation &p)
+                                              { propagation.observe(p); });
+    }
+
+    std::cerr << "simulating " << topology << " with " << net.routers.size() << " routers and "
+              << net.links.size() << " links" << std::endl;
+
+    // Les démons écrivent abondamment sur cout : silence jusqu'au rapport
+    std::cout.setstate(std::ios::badbit);
+
+    json phases = json::array();
+    phases.push_back(measurePhase("boot", sim, net, fabric, propagation, timeout, [&]()
+                                  {
+        for (auto &router : net.routers)
+        {
+            router.active = router.daemon->start(sim.mode());
+        } }));
+
+    if (scenario != "boot" && phases.back()["converged"].get<bool>())
+    {
+        phases.push_back(measurePhase(scenario, sim, net, fabric, propagation, timeout, [&]()
+                                      {
+            if (scenario == "link-failure")
+            {
+                net.links[target].up = false;
+                fabric.setLinkUp(net.links[target].subnet, false);
+            }
+            else
+            {
+                sim.stopRouter(net.routers[target]);
+            } }));
+    }
+
+    if (soak.count() > 0)
+    {
+        phases.push_back(soakPhase(sim, net, fabric, propagation, soak));
+    }
+
+    sim.stopAll();
+    fabric.stop();
+    std::cout.clear();
+
+    if (!tracePath.empty())
+    {
+        json events = json::array();
+        for (size_t i = 0; i < net.routers.size(); i++)
+        {
+            net.routers[i].daemon->getTracer().appendChromeEvents(events, static_cast<int>(i + 1),
+                                                                  "R" + std::to_string(i + 1));
+        }
+        std::ofstream out(tracePath);
+        out << json{{"traceEvents", events}, {"displayTimeUnit", "ms"}}.dump();
+        if (!out)
+            std::cerr << "Cannot write trace to " << tracePath << std::endl;
+    }
+
+    json failed = nullptr;
+    if (scenario == "link-failure")
+        failed = {{"link", net.links[target].subnet.toString()},
+                  {"between", {"R" + std::to_string(net.links[target].a + 1), "R" + std::to_string(net.links[target].b + 1)}}};
+    else if (scenario == "router-stop")
+        failed = {{"router", "R" + std::to_string(target + 1)}};
+
+    json report = {
+        {"simulation", "routing_daemon"},
+        {"format_version", 1},
+        {"topology", topology},
+        {"routers", net.routers.size()},
+        {"links", net.links.size()},
+        {"scenario", scenario},
+        {"failed", failed},
+        {"seed", seed},
+        {"flood_reduction", floodReduction},
+        {"clock", virtualTime ? "virtual" : "real"},
+        {"link_profile", {{"latency_ms", profile.latency.count() / 1000.0}, {"loss", profile.loss}, {"bandwidth_mbps", profile.bandwidthMbps}}},
+        {"phases", phases}};
+    std::cout << report.dump(2) << std::endl;
+    return 0;
+}
@@ -0,0 +1,329 @@
+#include "SimFabric.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    uint32_t parseIp(const std::string &ip)
+    {
+        in_addr addr{};
+        if (inet_pton(AF_INET, ip.c_str(), &addr) != 1)
+            return 0;
+        return ntohl(addr.s_addr);
+    }
+
+    std::string formatIp(uint32_t ip)
+    {
+        in_addr addr{};
+        addr.s_addr = htonl(ip);
+        char buf[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &addr, buf, sizeof(buf));
+        return buf;
+    }
+}
+
+SimFabric::SimFabric(const LinkProfile &profile, uint64_t seed, const ProtocolClock &clock)
+    : profile(profile), clock(clock), rng(seed)
+{
+}
+
+SimFabric::~SimFabric()
+{
+    stop();
+}
+
+void SimFabric::start()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running)
+        return;
+    running = true;
+    worker = std::thread(&SimFabric::run, this);
+}
+
+void SimFabric::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    cv.notify_all();
+    if (worker.joinable())
+        worker.join();
+}
+
+std::unique_ptr<Transport> SimFabric::attach(const std::vector<LocalInterfaceAddress> &addresses)
+{
+    auto transport = std::make_unique<SimTransport>(*this);
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &address : addresses)
+    {
+        uint32_t ip = parseIp(address.ip);
+        endpoints.push_back({ip, Ipv4Prefix::fromAddress(ip, address.prefixLength), transport.get()});
+        byIp[ip] = transport.get();
+    }
+    return transport;
+}
+
+void SimFabric::detach(SimTransport *transport)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(),
+                                   [transport](const Endpoint &endpoint)
+                                   { return endpoint.transport == transport; }),
+                    endpoints.end());
+    for (auto it = byIp.begin(); it != byIp.end();)
+    {
+        it = it->second == transport ? byIp.erase(it) : std::next(it);
+    }
+}
+
+void SimFabric::setLinkUp(const Ipv4Prefix &subnet, bool up)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (up)
+        downSubnets.erase(subnet.network);
+    else
+        downSubnets.insert(subnet.network);
+}
+
+SimFabric::Stats SimFabric::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+std::string SimFabric::messageType(const std::string &payload)
+{
+    static const std::string key = "\"type\":\"";
+    size_t start = payload.find(key);
+    if (start == std::string::npos)
+        return "unknown";
+    start += key.size();
+    size_t end = payload.find('"', start);
+    return end == std::string::npos ? "unknown" : payload.substr(start, end - start);
+}
+
+void SimFabric::submit(SimTransport *from, const std::string &destIp, int port, const std::string &payload)
+{
+    uint32_t dest = parseIp(destIp);
+    auto shared = std::make_shared<const std::string>(payload);
+    std::string type = messageType(payload);
+    auto now = clock.now();
+    // Temps de sérialisation du datagramme sur le lien
+    auto serialization = std::chrono::nanoseconds(
+        static_cast<int64_t>(payload.size() * 8 * 1000.0 / profile.bandwidthMbps));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.sent++;
+    stats.bytes += payload.size();
+    stats.byType[type]++;
+
+    // Interface émettrice : celle du sous-réseau de la destination
+    const Endpoint *source = nullptr;
+    for (const auto &endpoint : endpoints)
+    {
+        if (endpoint.transport == from && endpoint.subnet.contains(dest))
+        {
+            source = &endpoint;
+            break;
+        }
+    }
+    if (!source || downSubnets.count(source->subnet.network))
+    {
+        stats.unreachable++;
+        return;
+    }
+
+    std::vector<uint32_t> targets;
+    bool broadcast = (dest | source->subnet.mask()) == 0xFFFFFFFFu;
+    if (broadcast)
+    {
+        for (const auto &endpoint : endpoints)
+        {
+            if (endpoint.transport != from && endpoint.subnet == source->subnet)
+                targets.push_back(endpoint.ip);
+        }
+    }
+    else if (byIp.count(dest))
+    {
+        targets.push_back(dest);
+    }
+    else
+    {
+        stats.unreachable++;
+        return;
+    }
+
+    bool wake = false;
+    for (uint32_t target : targets)
+    {
+        if (profile.loss > 0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng) < profile.loss)
+        {
+            stats.lost++;
+            continue;
+        }
+        auto &busy = busyUntil[{source->ip, target}];
+        busy = std::max(busy, now) + serialization;
+        Delivery delivery{busy + profile.latency, nextOrder++, target, source->ip, source->subnet.network, port, shared};
+        wake = wake || pending.empty() || delivery.at < pending.top().at;
+        pending.push(std::move(delivery));
+    }
+    if (wake)
+        cv.notify_one();
+}
+
+void SimFabric::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running)
+    {
+        if (pending.empty())
+        {
+            cv.wait(lock);
+            continue;
+        }
+        // Copie : le tas peut être réalloué pendant l'attente
+        auto next = pending.top().at;
+        if (next > clock.now())
+        {
+            cv.wait_until(lock, next);
+            continue;
+        }
+
+        Delivery delivery = pending.top();
+        pending.pop();
+        deliverLocked(delivery);
+    }
+}
+
+std::vector<const Transport *> SimFabric::deliverDue()
+{
+    std::vector<const Transport *> receivers;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = clock.now();
+    while (!pending.empty() && pending.top().at <= now)
+    {
+        Delivery delivery = pending.top();
+        pending.pop();
+        if (SimTransport *receiver = deliverLocked(delivery))
+        {
+            if (std::find(receivers.begin(), receivers.end(), receiver) == receivers.end())
+                receivers.push_back(receiver);
+        }
+    }
+    return receivers;
+}
+
+std::optional<ProtocolClock::time_point> SimFabric::nextDelivery() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending.empty())
+        return std::nullopt;
+    return pending.top().at;
+}
+
+SimTransport *SimFabric::deliverLocked(const Delivery &delivery)
+{
+    // Lien coupé pendant le transit ou destination détachée
+    auto it = byIp.find(delivery.destIp);
+    if (it == byIp.end() || downSubnets.count(delivery.subnet))
+    {
+        stats.unreachable++;
+        return nullptr;
+    }
+    switch (it->second->deliver(delivery.port, {formatIp(delivery.senderIp), delivery.payload}))
+    {
+    case SimTransport::DeliveryResult::Delivered:
+        stats.delivered++;
+        return it->second;
+    case SimTransport::DeliveryResult::PortClosed:
+        stats.unreachable++;
+        break;
+    case SimTransport::DeliveryResult::BufferFull:
+        stats.overflow++;
+        break;
+    }
+    return nullptr;
+}
+
+SimTransport::SimTransport(SimFabric &fabric) : fabric(fabric)
+{
+}
+
+SimTransport::~SimTransport()
+{
+    fabric.detach(this);
+}
+
+bool SimTransport::open(int port)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    openPort = port;
+    inbox.clear();
+    queuedBytes = 0;
+    return true;
+}
+
+void SimTransport::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    openPort = -1;
+    inbox.clear();
+    queuedBytes = 0;
+}
+
+SimTransport::DeliveryResult SimTransport::deliver(int port, Datagram datagram)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (port != openPort)
+            return DeliveryResult::PortClosed;
+        if (queuedBytes + datagram.payload->size() > RECEIVE_BUFFER)
+            return DeliveryResult::BufferFull;
+        queuedBytes += datagram.payload->size();
+        inbox.push_back(std::move(datagram));
+    }
+    cv.notify_one();
+    return DeliveryResult::Delivered;
+}
+
+ssize_t SimTransport::receive(char *buffer, size_t size, std::string &senderIp)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (openPort < 0)
+        return -1;
+    if (inbox.empty())
+        return 0;
+
+    Datagram datagram = std::move(inbox.front());
+    inbox.pop_front();
+    queuedBytes -= datagram.payload->size();
+    size_t len = std::min(size, datagram.payload->size());
+    std::memcpy(buffer, datagram.payload->data(), len);
+    senderIp = datagram.senderIp;
+    return static_cast<ssize_t>(len);
+}
+
+bool SimTransport::send(const std::string &destIp, int port, const std::string &payload)
+{
+    fabric.submit(this, destIp, port, payload);
+    return true;
+}
+
+void SimTransport::wait(std::chrono::nanoseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait_for(lock, timeout, [this]()
+                { return !inbox.empty() || woken; });
+    woken = false;
+}
+
+void SimTransport::wake()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        woken = true;
+    }
+    cv.notify_one();
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include "../src/Transport.hpp"
+#include "../src/Ipv4Prefix.hpp"
+#include "../src/utils.hpp"
+#include "../src/ProtocolClock.hpp"
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <random>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class SimTransport;
+
+// Tissu en mémoire reliant des SimTransport : un sous-réseau /24 par lien, diffusion sur
+// x.x.x.255, latence, perte et débit par sens de lien. En temps réel, un thread livre les
+// datagrammes à échéance (start) ; sur horloge virtuelle, le pilote appelle deliverDue().
+class SimFabric
+{
+public:
+    struct LinkProfile
+    {
+        std::chrono::microseconds latency{1000};
+        double loss = 0.0;             // Probabilité de perte par datagramme
+        double bandwidthMbps = 1000.0; // Sérialisation par sens de lien
+    };
+
+    struct Stats
+    {
+        uint64_t sent = 0;
+        uint64_t delivered = 0;
+        uint64_t lost = 0;        // Perte aléatoire
+        uint64_t unreachable = 0; // Lien coupé, destination absente ou port fermé
+        uint64_t overflow = 0;    // Tampon de réception plein
+        uint64_t bytes = 0;
+        std::map<std::string, uint64_t> byType; // Type de message (champ "type")
+    };
+
+    SimFabric(const LinkProfile &profile, uint64_t seed, const ProtocolClock &clock = ProtocolClock::steady());
+    ~SimFabric();
+
+    void start();
+    void stop();
+
+    // Horloge virtuelle : livre les datagrammes échus à l'instant de l'horloge ; renvoie les
+    // transports qui ont reçu quelque chose
+    std::vector<const Transport *> deliverDue();
+    std::optional<ProtocolClock::time_point> nextDelivery() const;
+
+    // Transport d'un routeur dont les interfaces portent ces adresses
+    std::unique_ptr<Transport> attach(const std::vector<LocalInterfaceAddress> &addresses);
+    // Coupe ou rétablit un lien (sous-réseau entier)
+    void setLinkUp(const Ipv4Prefix &subnet, bool up);
+
+    Stats getStats() const;
+
+private:
+    friend class SimTransport;
+
+    struct Endpoint
+    {
+        uint32_t ip;
+        Ipv4Prefix subnet;
+        SimTransport *transport;
+    };
+
+    struct Delivery
+    {
+        std::chrono::steady_clock::time_point at;
+        uint64_t order; // Départage FIFO à échéance égale
+        uint32_t destIp;
+        uint32_t senderIp;
+        uint32_t subnet; // Lien emprunté
+        int port;
+        std::shared_ptr<const std::string> payload;
+
+        bool operator>(const Delivery &other) const
+        {
+            return at != other.at ? at > other.at : order > other.order;
+        }
+    };
+
+    void submit(SimTransport *from, const std::string &destIp, int port, const std::string &payload);
+    void detach(SimTransport *transport);
+    void run();
+    // Sous verrou ; destinataire si le datagramme a été remis
+    SimTransport *deliverLocked(const Delivery &delivery);
+    static std::string messageType(const std::string &payload);
+
+    LinkProfile profile;
+    const ProtocolClock &clock;
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::mt19937_64 rng;
+    std::vector<Endpoint> endpoints;
+    std::unordered_map<uint32_t, SimTransport *> byIp;
+    std::set<uint32_t> downSubnets; // Adresse réseau des liens coupés
+    std::map<std::pair<uint32_t, uint32_t>, std::chrono::steady_clock::time_point> busyUntil; // (src, dst)
+    std::priority_queue<Delivery, std::vector<Delivery>, std::greater<>> pending;
+    uint64_t nextOrder = 0;
+    Stats stats;
+    bool running = false;
+    std::thread worker;
+};
+
+class SimTransport : public Transport
+{
+public:
+    explicit SimTransport(SimFabric &fabric);
+    ~SimTransport() override;
+
+    bool open(int port) override;
+    void close() override;
+    ssize_t receive(char *buffer, size_t size, std::string &senderIp) override;
+    bool send(const std::string &destIp, int port, const std::string &payload) override;
+    // Temps réel uniquement : sur horloge virtuelle, le pilote appelle step() sans attendre
+    void wait(std::chrono::nanoseconds timeout) override;
+    void wake() override;
+
+private:
+    friend class SimFabric;
+
+    // Comme net.core.rmem_default : au-delà, les datagrammes sont perdus à l'arrivée
+    static constexpr size_t RECEIVE_BUFFER = 212992;
+
+    enum class DeliveryResult
+    {
+        Delivered,
+        PortClosed,
+        BufferFull
+    };
+
+    struct Datagram
+    {
+        std::string senderIp;
+        std::shared_ptr<const std::string> payload;
+    };
+
+    // Appelé par le thread de livraison
+    DeliveryResult deliver(int port, Datagram datagram);
+
+    SimFabric &fabric;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Datagram> inbox;
+    bool woken = false;
+    size_t queuedBytes = 0;
+    int openPort = -1;
+};
@@ -0,0 +1,279 @@
+#include "BfdManager.hpp"
+#include "../include/json.hpp"
+#include "utils.hpp"
+#include <iostream>
+#include <cstring>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+using json = nlohmann::json;
+
+BfdManager::BfdManager(const std::string &hostname, const Config &config)
+    : hostname(hostname), config(config)
+{
+}
+
+BfdManager::~BfdManager()
+{
+    stop();
+}
+
+const char *BfdManager::stateName(SessionState state)
+{
+    switch (state)
+    {
+    case SessionState::Down:
+        return "Down";
+    case SessionState::Init:
+        return "Init";
+    case SessionState::Up:
+        return "Up";
+    }
+    return "?";
+}
+
+bool BfdManager::start()
+{
+    if (running.load())
+        return false;
+
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0)
+    {
+        perror("BFD socket");
+        return false;
+    }
+
+    int flags = fcntl(sock, F_GETFL, 0);
+    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config.port);
+    addr.sin_addr.s_addr = INADDR_ANY;
+
+    if (bind(sock, (sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        perror("BFD bind");
+        close(sock);
+        sock = -1;
+        return false;
+    }
+
+    running.store(true);
+    worker = std::thread(&BfdManager::run, this);
+    return true;
+}
+
+void BfdManager::stop()
+{
+    if (!running.exchange(false))
+        return;
+
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+    close(sock);
+    sock = -1;
+}
+
+void BfdManager::addSession(const std::string &neighborIp)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (sessions.count(neighborIp))
+        return;
+
+    Session session;
+    session.localDiscriminator = nextDiscriminator++;
+    session.nextTx = Clock::now();
+    sessions[neighborIp] = session;
+}
+
+void BfdManager::removeSession(const std::string &neighborIp)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    sessions.erase(neighborIp);
+}
+
+void BfdManager::setSessionDownHandler(SessionDownHandler handler)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    onSessionDown = std::move(handler);
+}
+
+std::vector<std::pair<std::string, BfdManager::SessionState>> BfdManager::getSessionStates() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::pair<std::string, SessionState>> states;
+    for (const auto &[ip, session] : sessions)
+    {
+        states.emplace_back(ip, session.state);
+    }
+    return states;
+}
+
+void BfdManager::sendControl(const std::string &neighborIp, const Session &session)
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config.port);
+    if (inet_pton(AF_INET, neighborIp.c_str(), &addr.sin_addr) <= 0)
+        return;
+
+    json controlMsg = {
+        {"type", "BFD"},
+        {"hostname", hostname},
+        {"state", static_cast<int>(session.state)},
+        {"my_disc", session.localDiscriminator},
+        {"your_disc", session.remoteDiscriminator},
+        {"interval", config.txInterval.count()},
+        {"multiplier", config.multiplier}};
+    std::string controlStr = controlMsg.dump();
+    controlMsg["hmac"] = toHex(computeHMAC(controlStr, "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV"));
+
+    std::string payload = controlMsg.dump();
+    sendto(sock, payload.c_str(), payload.size(), 0, (sockaddr *)&addr, sizeof(addr));
+}
+
+void BfdManager::transition(const std::string &neighborIp, Session &session, SessionState next,
+                            std::vector<std::string> &wentDown)
+{
+    if (session.state == next)
+        return;
+
+    if (session.state == SessionState::Up && next == SessionState::Down)
+    {
+        wentDown.push_back(neighborIp);
+    }
+    session.state = next;
+    session.nextTx = Clock::now(); // Annoncer le changement d'état sans attendre
+}
+
+void BfdManager::handlePacket(const char *data, size_t len, const std::string &senderIp,
+                              std::vector<std::string> &wentDown)
+{
+    json j = json::parse(std::string(data, len), nullptr, false);
+    if (j.is_discarded() || !j.contains("hmac") || j.value("type", "") != "BFD")
+        return;
+
+    std::string receivedHmac = j["hmac"];
+    j.erase("hmac");
+    if (receivedHmac != toHex(computeHMAC(j.dump(), "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV")))
+        return;
+
+    auto it = sessions.find(senderIp);
+    if (it == sessions.end())
+        return; // Pas d'adjacence Hello : pas de session
+
+    Session &session = it->second;
+    uint32_t yourDisc = j.value("your_disc", 0u);
+    if (yourDisc != 0 && yourDisc != session.localDiscriminator)
+        return;
+
+    session.remoteDiscriminator = j.value("my_disc", 0u);
+    auto remoteState = static_cast<SessionState>(j.value("state", 0));
+    auto remoteInterval = std::chrono::milliseconds(j.value("interval", 1000));
+    int remoteMultiplier = std::max(1, j.value("multiplier", 3));
+
+    // Temps de détection : intervalle le plus lent des deux côtés x multiplicateur distant
+    auto detectTime = std::max(remoteInterval, config.txInterval) * remoteMultiplier;
+    session.detectDeadline = Clock::now() + detectTime;
+
+    switch (session.state)
+    {
+    case SessionState::Down:
+        if (remoteState == SessionState::Down)
+            transition(senderIp, session, SessionState::Init, wentDown);
+        else if (remoteState == SessionState::Init)
+            transition(senderIp, session, SessionState::Up, wentDown);
+        break;
+    case SessionState::Init:
+        if (remoteState != SessionState::Down)
+            transition(senderIp, session, SessionState::Up, wentDown);
+        break;
+    case SessionState::Up:
+        if (remoteState == SessionState::Down)
+            transition(senderIp, session, SessionState::Down, wentDown);
+        break;
+    }
+}
+
+void BfdManager::run()
+{
+    char buffer[1024];
+
+    while (running.load())
+    {
+        std::vector<std::string> wentDown;
+        SessionDownHandler handler;
+        int timeoutMs;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto now = Clock::now();
+            auto nextEvent = now + config.txInterval;
+
+            for (auto &[ip, session] : sessions)
+            {
+                // Expiration du temps de détection
+                if (session.state != SessionState::Down && now >= session.detectDeadline)
+                {
+                    transition(ip, session, SessionState::Down, wentDown);
+                    session.remoteDiscriminator = 0;
+                }
+
+                if (now >= session.nextTx)
+                {
+                    sendControl(ip, session);
+                    // Gigue de 0 à 25 % (RFC 5880 §6.8.7) pour désynchroniser les émetteurs
+                    auto jitter = config.txInterval * (rand() % 25) / 100;
+                    session.nextTx = now + config.txInterval - jitter;
+                }
+
+                nextEvent = std::min(nextEvent, session.nextTx);
+                if (session.state != SessionState::Down)
+                    nextEvent = std::min(nextEvent, session.detectDeadline);
+            }
+
+            timeoutMs = static_cast<int>(std::max<long long>(
+                0, std::chrono::duration_cast<std::chrono::milliseconds>(nextEvent - now).count()));
+            handler = onSessionDown;
+        }
+
+        for (const auto &ip : wentDown)
+        {
+            if (handler)
+                handler(ip);
+        }
+        wentDown.clear();
+
+        pollfd pfd{sock, POLLIN, 0};
+        if (poll(&pfd, 1, timeoutMs) > 0 && (pfd.revents & POLLIN))
+        {
+            while (true)
+            {
+                sockaddr_in sender{};
+                socklen_t senderLen = sizeof(sender);
+                ssize_t len = recvfrom(sock, buffer, sizeof(buffer), 0, (sockaddr *)&sender, &senderLen);
+                if (len <= 0)
+                    break;
+
+                char senderIp[INET_ADDRSTRLEN];
+                inet_ntop(AF_INET, &sender.sin_addr, senderIp, INET_ADDRSTRLEN);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                handlePacket(buffer, static_cast<size_t>(len), senderIp, wentDown);
+            }
+        }
+
+        for (const auto &ip : wentDown)
+        {
+            if (handler)
+                handler(ip);
+        }
+    }
+}
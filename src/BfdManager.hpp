@@ -0,0 +1,76 @@
+#pragma once
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// Détection de panne sous la seconde, inspirée de BFD (RFC 5880, mode asynchrone).
+// Une session par voisin, paquets de contrôle UDP sur un port dédié, thread propre.
+class BfdManager
+{
+public:
+    enum class SessionState
+    {
+        Down,
+        Init,
+        Up
+    };
+
+    struct Config
+    {
+        int port = 3784;
+        std::chrono::milliseconds txInterval{50};
+        int multiplier = 3;
+    };
+
+    using SessionDownHandler = std::function<void(const std::string &neighborIp)>;
+
+    BfdManager(const std::string &hostname, const Config &config);
+    ~BfdManager();
+
+    bool start();
+    void stop();
+
+    void addSession(const std::string &neighborIp);
+    void removeSession(const std::string &neighborIp);
+    void setSessionDownHandler(SessionDownHandler handler);
+
+    std::vector<std::pair<std::string, SessionState>> getSessionStates() const;
+    static const char *stateName(SessionState state);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Session
+    {
+        SessionState state = SessionState::Down;
+        uint32_t localDiscriminator = 0;
+        uint32_t remoteDiscriminator = 0;
+        Clock::time_point nextTx;
+        Clock::time_point detectDeadline; // Valide en Init/Up
+    };
+
+    void run();
+    void handlePacket(const char *data, size_t len, const std::string &senderIp,
+                      std::vector<std::string> &wentDown);
+    void sendControl(const std::string &neighborIp, const Session &session);
+    void transition(const std::string &neighborIp, Session &session, SessionState next,
+                    std::vector<std::string> &wentDown);
+
+    std::string hostname;
+    Config config;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Session> sessions; // neighborIp -> session
+    uint32_t nextDiscriminator = 1;
+    SessionDownHandler onSessionDown;
+
+    int sock = -1;
+    std::atomic<bool> running{false};
+    std::thread worker;
+};
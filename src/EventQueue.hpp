@@ -0,0 +1,52 @@
+#pragma once
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// File d'événements multi-producteurs, consommée par un seul thread. Le consommateur n'y attend
+// pas : le notificateur (appelé après chaque push, hors verrou) réveille sa boucle.
+template <typename T>
+class EventQueue
+{
+public:
+    // Fixé avant le premier push
+    void setNotifier(std::function<void()> callback) { notifier = std::move(callback); }
+
+    void push(T event)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            events.push_back(std::move(event));
+        }
+        if (notifier)
+            notifier();
+    }
+
+    bool tryPop(T &out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (events.empty())
+            return false;
+
+        out = std::move(events.front());
+        events.pop_front();
+        return true;
+    }
+
+    bool empty() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return events.empty();
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.clear();
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::deque<T> events;
+    std::function<void()> notifier;
+};
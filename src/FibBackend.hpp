@@ -0,0 +1,69 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include "utils.hpp"
+
+// Plan de transfert : programmation des routes et adresses des interfaces locales.
+// Noyau Linux en production, table en mémoire pour la simulation.
+class FibBackend
+{
+public:
+    struct Route
+    {
+        std::string nextHop;
+        std::string ifName;
+    };
+
+    virtual ~FibBackend() = default;
+
+    virtual bool addRoute(const std::string &dest, const std::string &nextHop, const std::string &ifName) = 0;
+    virtual bool deleteRoute(const std::string &dest) = 0;
+    virtual std::vector<LocalInterfaceAddress> localAddresses() = 0;
+};
+
+// ip route (proto boot) et getifaddrs
+class KernelFib : public FibBackend
+{
+public:
+    bool addRoute(const std::string &dest, const std::string &nextHop, const std::string &ifName) override
+    {
+        return ::addRoute(dest, nextHop, ifName);
+    }
+    bool deleteRoute(const std::string &dest) override { return ::deleteRoute(dest); }
+    std::vector<LocalInterfaceAddress> localAddresses() override { return getLocalInterfaceAddresses(); }
+};
+
+// Table en mémoire : interfaces déclarées à la construction, routes consultables par le simulateur
+class StubFib : public FibBackend
+{
+public:
+    explicit StubFib(std::vector<LocalInterfaceAddress> addresses) : addresses(std::move(addresses)) {}
+
+    bool addRoute(const std::string &dest, const std::string &nextHop, const std::string &ifName) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        routes[dest] = {nextHop, ifName};
+        return true;
+    }
+
+    bool deleteRoute(const std::string &dest) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return routes.erase(dest) > 0;
+    }
+
+    std::vector<LocalInterfaceAddress> localAddresses() override { return addresses; }
+
+    std::map<std::string, Route> snapshot() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return routes;
+    }
+
+private:
+    const std::vector<LocalInterfaceAddress> addresses;
+    mutable std::mutex mutex;
+    std::map<std::string, Route> routes; // destination -> next-hop
+};
@@ -0,0 +1,268 @@
+#include "FloodingTopology.hpp"
+#include <queue>
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+using json = nlohmann::json;
+
+FloodingTopology::FloodingTopology(const std::string &selfHostname)
+    : selfHostname(selfHostname)
+{
+}
+
+void FloodingTopology::refresh(const TopologyDatabase &topoDb)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t generation = topoDb.getGeneration();
+    if (valid && !stale && generation == lastGeneration)
+        return;
+
+    rebuild(topoDb);
+    lastGeneration = generation;
+    valid = true;
+    stale = false;
+}
+
+void FloodingTopology::noteInstalled(const json &lsa)
+{
+    std::set<std::string> neighbors;
+    if (!TopologyDatabase::isMaxAge(lsa) && lsa.contains("neighbors"))
+    {
+        for (const auto &neighbor : lsa["neighbors"])
+        {
+            if (neighbor.is_string())
+                neighbors.insert(neighbor.get<std::string>());
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = announced.find(lsa.value("hostname", ""));
+    // Origine absente du dernier calcul : équivaut à aucun voisin annoncé
+    if (it != announced.end() ? it->second != neighbors : !neighbors.empty())
+        stale = true;
+}
+
+void FloodingTopology::rebuild(const TopologyDatabase &topoDb)
+{
+    // Appelé sous mutex
+    announced.clear();
+    topoDb.forEachLSA([&](const std::string &routerId, const json &lsa)
+                      {
+        if (TopologyDatabase::isMaxAge(lsa) || !lsa.contains("neighbors"))
+            return;
+        for (const auto &neighbor : lsa["neighbors"])
+        {
+            if (neighbor.is_string())
+                announced[routerId].insert(neighbor.get<std::string>());
+        } });
+
+    // Un lien ne compte que s'il est annoncé des deux côtés
+    graph.clear();
+    for (const auto &[routerId, neighbors] : announced)
+    {
+        graph[routerId];
+        for (const auto &neighbor : neighbors)
+        {
+            auto it = announced.find(neighbor);
+            if (it != announced.end() && it->second.count(routerId))
+                graph[routerId].insert(neighbor);
+        }
+    }
+
+    floodingEdges.clear();
+    spanning = false;
+    if (graph.empty())
+        return;
+
+    // Arbre BFS depuis la plus petite racine, voisins parcourus dans l'ordre lexicographique
+    const std::string &root = graph.begin()->first;
+    std::set<std::string> visited{root};
+    std::queue<std::string> pending;
+    pending.push(root);
+    while (!pending.empty())
+    {
+        std::string u = pending.front();
+        pending.pop();
+        for (const auto &v : graph[u])
+        {
+            if (visited.insert(v).second)
+            {
+                floodingEdges[u].insert(v);
+                floodingEdges[v].insert(u);
+                pending.push(v);
+            }
+        }
+    }
+    spanning = visited.size() == graph.size();
+
+    // Degré 2 minimum : relier chaque feuille au voisin le moins chargé du sous-graphe
+    for (const auto &[u, neighbors] : graph)
+    {
+        if (floodingEdges[u].size() >= 2 || neighbors.size() < 2)
+            continue;
+
+        const std::string *best = nullptr;
+        for (const auto &v : neighbors)
+        {
+            if (floodingEdges[u].count(v))
+                continue;
+            if (!best || floodingEdges[v].size() < floodingEdges[*best].size())
+                best = &v;
+        }
+        if (best)
+        {
+            floodingEdges[u].insert(*best);
+            floodingEdges[*best].insert(u);
+        }
+    }
+
+    // Les feuilles ne suffisent pas : deux sous-arbres reliés seulement par la racine restent
+    // séparés par un pont, et la panne de ce lien coupe l'inondation sans repli possible
+    coverBridges();
+}
+
+void FloodingTopology::coverBridges()
+{
+    // Appelé sous mutex ; indices dans l'ordre lexicographique (déterministe), la racine du BFS en 0
+    std::vector<std::string> names;
+    std::unordered_map<std::string, int> index;
+    for (const auto &[routerId, neighbors] : floodingEdges)
+    {
+        index.emplace(routerId, static_cast<int>(names.size()));
+        names.push_back(routerId);
+    }
+    const int n = static_cast<int>(names.size());
+    if (n < 3)
+        return;
+    std::vector<std::vector<int>> adjacency(n);
+    for (int u = 0; u < n; u++)
+    {
+        for (const auto &v : floodingEdges[names[u]])
+            adjacency[u].push_back(index.at(v));
+    }
+
+    // Ponts (Tarjan), parcours en profondeur itératif : pas de récursion sur les longues chaînes
+    std::vector<int> order(n, -1), low(n, 0), parent(n, -1);
+    std::vector<size_t> cursor(n, 0);
+    std::vector<char> bridgeToParent(n, 0); // Lien (u, parent[u]) est un pont
+    int counter = 0;
+    std::vector<int> stack{0}, preorder{0};
+    order[0] = low[0] = counter++;
+    while (!stack.empty())
+    {
+        int u = stack.back();
+        if (cursor[u] < adjacency[u].size())
+        {
+            int v = adjacency[u][cursor[u]++];
+            if (order[v] < 0)
+            {
+                parent[v] = u;
+                order[v] = low[v] = counter++;
+                stack.push_back(v);
+                preorder.push_back(v);
+            }
+            else if (v != parent[u])
+            {
+                low[u] = std::min(low[u], order[v]);
+            }
+            continue;
+        }
+        stack.pop_back();
+        if (parent[u] >= 0)
+        {
+            low[parent[u]] = std::min(low[parent[u]], low[u]);
+            bridgeToParent[u] = low[u] > order[parent[u]];
+        }
+    }
+
+    // Composantes 2-arête-connexes : l'arbre DFS privé de ses ponts. Chaque composante a pour
+    // parent celle de l'autre extrémité de son pont : arbre des composantes enraciné en 0
+    std::vector<int> component(n, -1), componentParent, componentDepth;
+    for (int u : preorder)
+    {
+        if (parent[u] >= 0 && !bridgeToParent[u])
+        {
+            component[u] = component[parent[u]];
+            continue;
+        }
+        component[u] = static_cast<int>(componentParent.size());
+        componentParent.push_back(parent[u] >= 0 ? component[parent[u]] : -1);
+        componentDepth.push_back(parent[u] >= 0 ? componentDepth[component[parent[u]]] + 1 : 0);
+    }
+    if (componentParent.size() == 1)
+        return;
+
+    // Un lien du réseau entre deux composantes couvre les ponts du chemin qui les relie ; les
+    // ponts couverts fusionnent leur composante dans son parent (union-find)
+    std::vector<int> merged(componentParent.size());
+    std::iota(merged.begin(), merged.end(), 0);
+    auto find = [&](int c)
+    {
+        while (merged[c] != c)
+            c = merged[c] = merged[merged[c]];
+        return c;
+    };
+    for (int u = 0; u < n; u++)
+    {
+        if (order[u] < 0)
+            continue; // Hors de la composante de la racine (sous-graphe non couvrant)
+        for (const auto &neighbor : graph[names[u]])
+        {
+            auto it = index.find(neighbor);
+            if (it == index.end() || it->second <= u || order[it->second] < 0 ||
+                floodingEdges[names[u]].count(neighbor))
+                continue;
+            int a = find(component[u]);
+            int b = find(component[it->second]);
+            if (a == b)
+                continue;
+
+            floodingEdges[names[u]].insert(neighbor);
+            floodingEdges[neighbor].insert(names[u]);
+            while (a != b)
+            {
+                if (componentDepth[a] < componentDepth[b])
+                    std::swap(a, b);
+                merged[a] = componentParent[a];
+                a = find(a);
+            }
+        }
+    }
+}
+
+bool FloodingTopology::selectRelays(const std::vector<std::string> &adjacentHostnames,
+                                    std::set<std::string> &relays) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    relays.clear();
+    if (!valid || stale || !spanning)
+        return false;
+
+    auto selfIt = graph.find(selfHostname);
+    if (selfIt == graph.end())
+        return false;
+
+    // Adjacence locale absente de la LSDB : topologie en cours de changement
+    for (const auto &neighbor : adjacentHostnames)
+    {
+        if (!selfIt->second.count(neighbor))
+            return false;
+    }
+
+    auto edgesIt = floodingEdges.find(selfHostname);
+    if (edgesIt != floodingEdges.end())
+        relays = edgesIt->second;
+    return true;
+}
+
+size_t FloodingTopology::edgeCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t degrees = 0;
+    for (const auto &[routerId, neighbors] : floodingEdges)
+    {
+        degrees += neighbors.size();
+    }
+    return degrees / 2;
+}
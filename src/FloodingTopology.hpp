@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <mutex>
+#include <cstdint>
+#include "TopologyDatabase.hpp"
+
+// Topologie d'inondation réduite (dans l'esprit de RFC 9667) : sous-graphe couvrant calculé
+// de façon déterministe à partir de la LSDB, identique sur tous les routeurs synchronisés.
+// Arbre BFS depuis le plus petit identifiant, complété par des liens de la LSDB jusqu'à ce que
+// le sous-graphe soit 2-arête-connexe partout où le réseau l'est : une panne de lien unique ne
+// coupe pas l'inondation (seuls les ponts du réseau lui-même restent des ponts).
+class FloodingTopology
+{
+public:
+    explicit FloodingTopology(const std::string &selfHostname);
+
+    // Recalcul uniquement quand la génération de la LSDB change (une fois par passe du réacteur)
+    void refresh(const TopologyDatabase &topoDb);
+
+    // Chemin de réception, après installation d'un LSA : si ses voisins diffèrent de ceux du dernier
+    // calcul, la topologie est périmée jusqu'au prochain refresh (inonder partout d'ici là)
+    void noteInstalled(const nlohmann::json &lsa);
+
+    // Voisins sur lesquels relayer. Faux si la topologie est incertaine (LSDB incomplète,
+    // adjacence pas encore annoncée, sous-graphe non couvrant) : inonder partout.
+    bool selectRelays(const std::vector<std::string> &adjacentHostnames, std::set<std::string> &relays) const;
+
+    size_t edgeCount() const;
+
+private:
+    void rebuild(const TopologyDatabase &topoDb);
+    // Ajoute, pour chaque pont du sous-graphe qui n'en est pas un dans le réseau, un lien qui le
+    // contourne (ponts de Tarjan, puis couverture sur l'arbre des composantes 2-arête-connexes)
+    void coverBridges();
+
+    const std::string selfHostname;
+
+    mutable std::mutex mutex;
+    std::map<std::string, std::set<std::string>> announced; // Voisins annoncés par origine
+    std::map<std::string, std::set<std::string>> graph;     // Adjacences bidirectionnelles de la LSDB
+    std::map<std::string, std::set<std::string>> floodingEdges;
+    bool spanning = false;
+    uint64_t lastGeneration = 0;
+    bool valid = false;
+    bool stale = false;
+};
@@ -0,0 +1,112 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <arpa/inet.h>
+
+// Préfixe IPv4 (réseau + longueur), remplace la troncature "x.y.z.0/24"
+struct Ipv4Prefix
+{
+    uint32_t network = 0; // Ordre hôte, bits d'hôte à zéro
+    uint8_t length = 0;
+
+    static uint32_t maskFor(uint8_t length)
+    {
+        return length == 0 ? 0 : (0xFFFFFFFFu << (32 - length));
+    }
+
+    static Ipv4Prefix fromAddress(uint32_t addr, uint8_t length)
+    {
+        return Ipv4Prefix{addr & maskFor(length), length};
+    }
+
+    // Accepte "a.b.c.d/len" ou "a.b.c.d" (/32)
+    static bool parse(const std::string &str, Ipv4Prefix &out)
+    {
+        std::string addrPart = str;
+        int length = 32;
+
+        size_t slash = str.find('/');
+        if (slash != std::string::npos)
+        {
+            addrPart = str.substr(0, slash);
+            try
+            {
+                size_t used = 0;
+                length = std::stoi(str.substr(slash + 1), &used);
+                if (used != str.size() - slash - 1)
+                    return false;
+            }
+            catch (...)
+            {
+                return false;
+            }
+            if (length < 0 || length > 32)
+                return false;
+        }
+
+        in_addr addr{};
+        if (inet_pton(AF_INET, addrPart.c_str(), &addr) != 1)
+            return false;
+
+        out = fromAddress(ntohl(addr.s_addr), static_cast<uint8_t>(length));
+        return true;
+    }
+
+    uint32_t mask() const { return maskFor(length); }
+
+    bool contains(uint32_t addr) const
+    {
+        return (addr & mask()) == network;
+    }
+
+    bool contains(const Ipv4Prefix &other) const
+    {
+        return other.length >= length && contains(other.network);
+    }
+
+    std::string toString() const
+    {
+        in_addr addr{};
+        addr.s_addr = htonl(network);
+        char buf[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &addr, buf, sizeof(buf));
+        return std::string(buf) + "/" + std::to_string(length);
+    }
+
+    bool operator==(const Ipv4Prefix &other) const
+    {
+        return network == other.network && length == other.length;
+    }
+
+    bool operator<(const Ipv4Prefix &other) const
+    {
+        return network != other.network ? network < other.network : length < other.length;
+    }
+};
+
+// Remplace chaque préfixe couvert par une plage de résumé par l'agrégat.
+// Un agrégat n'est annoncé que s'il couvre au moins un réseau réel.
+inline std::vector<Ipv4Prefix> summarizePrefixes(const std::vector<Ipv4Prefix> &prefixes,
+                                                 const std::vector<Ipv4Prefix> &summaryRanges)
+{
+    std::vector<Ipv4Prefix> result;
+    for (const auto &prefix : prefixes)
+    {
+        Ipv4Prefix advertised = prefix;
+        for (const auto &range : summaryRanges)
+        {
+            // Le résumé le plus court (le plus large) l'emporte
+            if (range.contains(prefix) && range.length < advertised.length)
+            {
+                advertised = range;
+            }
+        }
+        result.push_back(advertised);
+    }
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
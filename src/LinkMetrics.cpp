@@ -0,0 +1,225 @@
+#include "LinkMetrics.hpp"
+#include "utils.hpp"
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+
+using json = nlohmann::json;
+
+LinkMetrics::LinkMetrics(AddressProvider addressProvider, const ProtocolClock &clock)
+    : addressProvider(std::move(addressProvider)), clock(clock)
+{
+}
+
+int LinkMetrics::costForCapacity(double capacityMbps)
+{
+    if (capacityMbps <= 0)
+        capacityMbps = DEFAULT_SPEED_MBPS;
+    return std::max(1, static_cast<int>(std::lround(REFERENCE_BANDWIDTH_MBPS / capacityMbps)));
+}
+
+int LinkMetrics::readSpeedMbps(const std::string &ifName)
+{
+    // Agrégats (bond), 25G, etc. : le noyau publie le débit négocié.
+    // -1 ou fichier absent (Wi-Fi, veth, loopback) : débit par défaut.
+    std::ifstream file("/sys/class/net/" + ifName + "/speed");
+    int speed = -1;
+    if (file >> speed && speed > 0)
+        return speed;
+    return DEFAULT_SPEED_MBPS;
+}
+
+void LinkMetrics::refreshInterfacesLocked()
+{
+    auto now = clock.now();
+    if (!interfaces.empty() && now - lastInterfaceRefresh < INTERFACE_REFRESH)
+        return;
+
+    interfaces.clear();
+    for (const auto &local : addressProvider())
+    {
+        uint32_t addr;
+        if (!parseIpv4(local.ip, addr))
+            continue;
+        interfaces.push_back({local.name, Ipv4Prefix::fromAddress(addr, local.prefixLength),
+                              readSpeedMbps(local.name)});
+    }
+    lastInterfaceRefresh = now;
+}
+
+const LinkMetrics::InterfaceInfo *LinkMetrics::interfaceForLocked(const std::string &neighborIp)
+{
+    refreshInterfacesLocked();
+
+    uint32_t addr;
+    if (!parseIpv4(neighborIp, addr))
+        return nullptr;
+
+    const InterfaceInfo *best = nullptr;
+    for (const auto &iface : interfaces)
+    {
+        if (iface.subnet.contains(addr) && (!best || iface.subnet.length > best->subnet.length))
+            best = &iface;
+    }
+    return best;
+}
+
+void LinkMetrics::fillHelloFields(const std::string &neighborIp, json &helloMsg)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &m = measures[neighborIp];
+    auto now = clock.now();
+
+    helloMsg["hello_seq"] = ++m.txSeq;
+    helloMsg["ts"] = now.time_since_epoch().count();
+
+    // Écho du dernier Hello reçu + temps de rétention pour calcul du RTT chez le voisin
+    if (m.lastPeerTs != 0)
+    {
+        helloMsg["echo_ts"] = m.lastPeerTs;
+        helloMsg["echo_held"] = (now - m.lastPeerRxAt).count();
+    }
+}
+
+void LinkMetrics::onHelloReceived(const std::string &neighborIp, const json &helloMsg)
+{
+    bool costChanged;
+    std::function<void(const std::string &)> handler;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &m = measures[neighborIp];
+        updateMeasuresLocked(m, helloMsg);
+        costChanged = updateAdvertisedLocked(neighborIp, m);
+        handler = onCostChange;
+    }
+    if (costChanged && handler)
+        handler(neighborIp);
+}
+
+void LinkMetrics::updateMeasuresLocked(NeighborMeasure &m, const json &helloMsg)
+{
+    auto now = clock.now();
+
+    if (helloMsg.contains("ts") && helloMsg["ts"].is_number_integer())
+    {
+        m.lastPeerTs = helloMsg["ts"].get<int64_t>();
+        m.lastPeerRxAt = now;
+    }
+
+    // RTT = maintenant - horodatage renvoyé - temps passé chez le voisin
+    if (helloMsg.contains("echo_ts") && helloMsg.contains("echo_held"))
+    {
+        int64_t sentAt = helloMsg["echo_ts"].get<int64_t>();
+        int64_t held = helloMsg["echo_held"].get<int64_t>();
+        int64_t rttNs = now.time_since_epoch().count() - sentAt - held;
+        if (rttNs >= 0)
+        {
+            double sample = rttNs / 1e6;
+            m.srttMs = m.hasRtt ? (1 - RTT_GAIN) * m.srttMs + RTT_GAIN * sample : sample;
+            // Nouvelle fenêtre : un chemin réellement rallongé finit par relever le minimum
+            if (!m.hasRtt || now - m.windowStart >= MIN_RTT_WINDOW)
+            {
+                m.previousMinRttMs = m.minRttMs;
+                m.hasPreviousWindow = m.hasRtt;
+                m.minRttMs = sample;
+                m.windowStart = now;
+            }
+            m.minRttMs = std::min(m.minRttMs, sample);
+            m.hasRtt = true;
+        }
+    }
+
+    // Perte : trous dans la séquence des Hello unicast du voisin
+    if (helloMsg.contains("hello_seq") && helloMsg["hello_seq"].is_number_unsigned())
+    {
+        uint64_t seq = helloMsg["hello_seq"].get<uint64_t>();
+        if (m.lastPeerSeq != 0 && seq > m.lastPeerSeq)
+        {
+            double lost = static_cast<double>(seq - m.lastPeerSeq - 1);
+            m.lossRate = (1 - LOSS_GAIN) * m.lossRate + LOSS_GAIN * (lost / (lost + 1));
+        }
+        m.lastPeerSeq = seq; // seq <= précédent : le voisin a redémarré
+    }
+}
+
+int LinkMetrics::measuredCostLocked(const std::string &neighborIp)
+{
+    const InterfaceInfo *iface = interfaceForLocked(neighborIp);
+    int speed = iface ? iface->speedMbps : DEFAULT_SPEED_MBPS;
+    double cost = costForCapacity(speed);
+
+    // Par tranches : la gigue du RTT et les pertes isolées ne changent pas le coût
+    auto it = measures.find(neighborIp);
+    if (it != measures.end())
+    {
+        const auto &m = it->second;
+        if (m.hasPreviousWindow)
+            cost += std::floor(std::min(m.minRttMs, m.previousMinRttMs) / RTT_BAND_MS) * RTT_BAND_MS / RTT_COST_STEP_MS;
+        cost /= 1.0 - std::min(std::floor(m.lossRate / LOSS_BAND) * LOSS_BAND, MAX_LOSS);
+    }
+    return std::max(1, static_cast<int>(std::lround(cost)));
+}
+
+bool LinkMetrics::updateAdvertisedLocked(const std::string &neighborIp, NeighborMeasure &m)
+{
+    int measured = measuredCostLocked(neighborIp);
+    auto now = clock.now();
+    if (m.advertisedCost == 0)
+    {
+        m.advertisedCost = measured; // Premier coût : pris en compte par l'origination de l'adjacence
+        return false;
+    }
+    if (std::abs(measured - m.advertisedCost) <= m.advertisedCost * COST_HYSTERESIS ||
+        (m.costChangedAt != Clock::time_point{} && now - m.costChangedAt < COST_HOLD_TIME))
+        return false;
+
+    m.advertisedCost = measured;
+    m.costChangedAt = now;
+    return true;
+}
+
+int LinkMetrics::costLocked(const std::string &neighborIp)
+{
+    // Mis à jour à la réception des Hello seulement : tout changement passe par onCostChange
+    auto it = measures.find(neighborIp);
+    if (it == measures.end() || it->second.advertisedCost == 0)
+        return measuredCostLocked(neighborIp);
+    return it->second.advertisedCost;
+}
+
+int LinkMetrics::getSpeedMbps(const std::string &neighborIp)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const InterfaceInfo *iface = interfaceForLocked(neighborIp);
+    return iface ? iface->speedMbps : DEFAULT_SPEED_MBPS;
+}
+
+int LinkMetrics::getLinkCost(const std::string &neighborIp)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return costLocked(neighborIp);
+}
+
+LinkMetrics::LinkReport LinkMetrics::getReport(const std::string &neighborIp)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    LinkReport report;
+    const InterfaceInfo *iface = interfaceForLocked(neighborIp);
+    report.ifName = iface ? iface->name : "unknown";
+    report.speedMbps = iface ? iface->speedMbps : DEFAULT_SPEED_MBPS;
+
+    auto it = measures.find(neighborIp);
+    if (it != measures.end())
+    {
+        report.srttMs = it->second.srttMs;
+        report.lossRate = it->second.lossRate;
+    }
+    report.cost = costLocked(neighborIp);
+    return report;
+}
+
+void LinkMetrics::forgetNeighbor(const std::string &neighborIp)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    measures.erase(neighborIp);
+}
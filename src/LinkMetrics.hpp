@@ -0,0 +1,115 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include "../include/json.hpp"
+#include "Ipv4Prefix.hpp"
+#include "utils.hpp"
+#include "ProtocolClock.hpp"
+#include <functional>
+
+// Métriques de lien mesurées : débit réel (/sys/class/net/<if>/speed),
+// RTT lissé et taux de perte estimés à partir des Hello, coût entier pour le SPF.
+// Le coût annoncé est stable : il compte le RTT minimal récent (délai de propagation, sans file
+// d'attente ni ordonnancement) et la perte par tranches, et ne suit la mesure que si elle s'en
+// écarte nettement, au plus une fois par COST_HOLD_TIME (pas de réorigination sur gigue).
+class LinkMetrics
+{
+public:
+    struct LinkReport
+    {
+        std::string ifName;
+        int speedMbps = 0;
+        double srttMs = 0.0;
+        double lossRate = 0.0;
+        int cost = 0;
+    };
+
+    // Coût = REFERENCE_BANDWIDTH / débit : 1G -> 100, 10G -> 10, 25G -> 4, 100G -> 1
+    static constexpr int REFERENCE_BANDWIDTH_MBPS = 100000;
+    static constexpr int DEFAULT_SPEED_MBPS = 1000;
+
+    static int costForCapacity(double capacityMbps);
+
+    using AddressProvider = std::function<std::vector<LocalInterfaceAddress>()>;
+    explicit LinkMetrics(AddressProvider addressProvider = getLocalInterfaceAddresses,
+                         const ProtocolClock &clock = ProtocolClock::steady());
+
+    // Champs de mesure à ajouter à un Hello unicast vers ce voisin
+    void fillHelloFields(const std::string &neighborIp, nlohmann::json &helloMsg);
+    // Traitement des champs de mesure d'un Hello reçu
+    void onHelloReceived(const std::string &neighborIp, const nlohmann::json &helloMsg);
+
+    int getSpeedMbps(const std::string &neighborIp);
+    // Coût annoncé (avec hystérésis)
+    int getLinkCost(const std::string &neighborIp);
+    LinkReport getReport(const std::string &neighborIp);
+    void forgetNeighbor(const std::string &neighborIp);
+
+    // Appelé hors verrou quand le coût annoncé vers un voisin change : réoriginer notre LSA
+    void setCostChangeHandler(std::function<void(const std::string &)> handler) { onCostChange = std::move(handler); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct InterfaceInfo
+    {
+        std::string name;
+        Ipv4Prefix subnet;
+        int speedMbps = DEFAULT_SPEED_MBPS;
+    };
+
+    struct NeighborMeasure
+    {
+        // Émission
+        uint64_t txSeq = 0;
+        // Réception : dernier Hello du voisin, renvoyé en écho
+        int64_t lastPeerTs = 0;
+        Clock::time_point lastPeerRxAt;
+        uint64_t lastPeerSeq = 0;
+        // Estimations lissées
+        double srttMs = 0.0;
+        bool hasRtt = false;
+        // RTT minimal par fenêtre de MIN_RTT_WINDOW (courante et précédente) : base du coût
+        double minRttMs = 0.0;
+        double previousMinRttMs = 0.0;
+        bool hasPreviousWindow = false;
+        Clock::time_point windowStart;
+        double lossRate = 0.0;
+        // Coût annoncé : 0 tant qu'aucun n'a été fixé
+        int advertisedCost = 0;
+        Clock::time_point costChangedAt;
+    };
+
+    void updateMeasuresLocked(NeighborMeasure &m, const nlohmann::json &helloMsg);
+    void refreshInterfacesLocked();
+    const InterfaceInfo *interfaceForLocked(const std::string &neighborIp);
+    int measuredCostLocked(const std::string &neighborIp);
+    int costLocked(const std::string &neighborIp);
+    // Fait suivre au coût annoncé le coût mesuré si l'écart et le délai le permettent ; true si changé
+    bool updateAdvertisedLocked(const std::string &neighborIp, NeighborMeasure &m);
+    static int readSpeedMbps(const std::string &ifName);
+
+    AddressProvider addressProvider;
+    const ProtocolClock &clock; // Horodatage des Hello (RTT)
+    std::mutex mutex;
+    std::vector<InterfaceInfo> interfaces;
+    Clock::time_point lastInterfaceRefresh;
+    std::unordered_map<std::string, NeighborMeasure> measures;
+    std::function<void(const std::string &)> onCostChange;
+
+    static constexpr std::chrono::seconds INTERFACE_REFRESH{30};
+    static constexpr double RTT_GAIN = 0.125; // RFC 6298
+    static constexpr double LOSS_GAIN = 0.1;
+    static constexpr double RTT_COST_STEP_MS = 1.0; // +1 de coût par ms de RTT
+    static constexpr double MAX_LOSS = 0.9;
+    static constexpr double RTT_BAND_MS = 5.0;  // RTT arrondi à la tranche inférieure
+    // Le RTT ne compte qu'après une fenêtre complète : le démarrage, chargé, ne fixe pas le coût
+    static constexpr std::chrono::seconds MIN_RTT_WINDOW{300};
+    static constexpr double LOSS_BAND = 0.05;   // Perte arrondie à la tranche inférieure
+    static constexpr double COST_HYSTERESIS = 0.2; // Écart relatif minimal avant de changer le coût annoncé
+    static constexpr std::chrono::seconds COST_HOLD_TIME{60};
+};
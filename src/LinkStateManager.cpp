@@ -2,118 +2,211 @@
 #include "LinkStateManager.hpp"
 #include <chrono>
 #include <iostream>
+#include <algorithm>
+#include <tuple>
 
-bool LinkStateManager::updateNeighbor(const std::string &neighborIp, const std::string &neighborHostname)
+LinkStateManager::LinkStateManager(TimerWheel &timers)
+    : timers(timers)
 {
-    auto now = std::chrono::steady_clock::now();
-    auto it = neighbors.find(neighborIp);
+}
+
+void LinkStateManager::setStateChangeHandler(StateChangeHandler handler)
+{
+    onStateChange = std::move(handler);
+}
+
+const char *LinkStateManager::stateName(NeighborState state)
+{
+    switch (state)
+    {
+    case NeighborState::Down:
+        return "Down";
+    case NeighborState::Init:
+        return "Init";
+    case NeighborState::TwoWay:
+        return "2-Way";
+    case NeighborState::Full:
+        return "Full";
+    }
+    return "?";
+}
+
+void LinkStateManager::emit(const NeighborInfo &info, NeighborState from, NeighborState to)
+{
+    if (onStateChange)
+    {
+        onStateChange({info.ip, info.hostname, from, to});
+    }
+}
+
+bool LinkStateManager::transition(NeighborInfo &info, NeighborState from, NeighborState to)
+{
+    if (!info.state.compare_exchange_strong(from, to))
+        return false;
+    emit(info, from, to);
+    return true;
+}
+
+std::chrono::seconds LinkStateManager::deadIntervalOf(const NeighborInfo &info)
+{
+    return std::chrono::seconds(info.deadInterval.load(std::memory_order_relaxed));
+}
+
+void LinkStateManager::armDeadTimer(const NeighborTable::EntryPtr &info)
+{
+    // Le voisin est retiré exactement à l'échéance, sans balayage périodique
+    std::weak_ptr<NeighborInfo> weak = info;
+    info->deadTimer.store(timers.schedule(deadIntervalOf(*info), [this, weak]()
+                                          {
+        auto expired = weak.lock();
+        if (expired && neighbors.eraseIfSame(expired->ip, expired.get()))
+        {
+            emit(*expired, expired->state.exchange(NeighborState::Down), NeighborState::Down);
+        } }));
+}
 
-    if (it != neighbors.end())
+bool LinkStateManager::updateNeighbor(const std::string &neighborIp, const std::string &neighborHostname,
+                                      bool sawUs, std::chrono::seconds deadInterval)
+{
+    auto now = timers.now();
+    auto announce = [&](NeighborInfo &entry)
+    {
+        if (deadInterval.count() > 0)
+            entry.deadInterval.store(static_cast<int>(std::min(deadInterval, MAX_DEAD_INTERVAL).count()),
+                                     std::memory_order_relaxed);
+    };
+    auto [info, isNew] = neighbors.findOrInsert(neighborIp, neighborHostname);
+    announce(*info);
+
+    if (!isNew && !timers.restart(info->deadTimer.load(), deadIntervalOf(*info)))
+    {
+        // Dead interval déjà échu pendant la réception : repartir d'une entrée neuve
+        neighbors.eraseIfSame(neighborIp, info.get());
+        std::tie(info, isNew) = neighbors.findOrInsert(neighborIp, neighborHostname);
+        announce(*info);
+    }
+
+    info->touch(now);
+    if (!isNew)
     {
-        it->second.lastSeen = now;
         updateNeighborStability(neighborIp);
+
+        NeighborState current = info->state.load();
+        if (sawUs && current == NeighborState::Init)
+        {
+            transition(*info, current, NeighborState::TwoWay);
+        }
+        else if (!sawUs && current >= NeighborState::TwoWay)
+        {
+            // Le voisin ne nous voit plus (redémarrage) : retour en Init
+            transition(*info, current, NeighborState::Init);
+        }
         return false; // Pas nouveau
     }
-    else
+
+    // Nouveau voisin
+    info->stabilityCounter.store(0, std::memory_order_relaxed);
+    info->helloInterval.store(MIN_HELLO_INTERVAL, std::memory_order_relaxed);
+    armDeadTimer(info);
+
+    transition(*info, NeighborState::Down, NeighborState::Init);
+    if (sawUs)
     {
-        // Nouveau voisin
-        NeighborInfo info;
-        info.ip = neighborIp;
-        info.hostname = neighborHostname;
-        info.lastSeen = now;
-        info.stabilityCounter = 0;
-        info.helloInterval = MIN_HELLO_INTERVAL;
-
-        neighbors[neighborIp] = info;
-        return true; // Nouveau voisin
+        transition(*info, NeighborState::Init, NeighborState::TwoWay);
     }
+    return true; // Nouveau voisin
 }
+
+bool LinkStateManager::removeNeighbor(const std::string &neighborIp)
+{
+    auto info = neighbors.find(neighborIp);
+    if (!info || !neighbors.eraseIfSame(neighborIp, info.get()))
+        return false;
+
+    timers.cancel(info->deadTimer.load());
+    emit(*info, info->state.exchange(NeighborState::Down), NeighborState::Down);
+    return true;
+}
+
+bool LinkStateManager::markFull(const std::string &neighborIp)
+{
+    auto info = neighbors.find(neighborIp);
+    return info && transition(*info, NeighborState::TwoWay, NeighborState::Full);
+}
+
 std::vector<std::string> LinkStateManager::getActiveNeighborHostnames() const
 {
+    // Les voisins expirés sont retirés par leur temporisation : tout ce qui reste est actif
     std::vector<std::string> hostnames;
-    auto now = std::chrono::steady_clock::now();
-    for (const auto &[ip, info] : neighbors)
-    {
-        // ✅ UTILISER LE MÊME TIMEOUT que purgeInactiveNeighbors()
-        if (now - info.lastSeen < std::chrono::seconds(30) && !info.hostname.empty())
+    neighbors.forEach([&](const NeighborInfo &info)
+                      {
+        if (!info.hostname.empty())
         {
             hostnames.push_back(info.hostname);
-        }
-    }
+        } });
     return hostnames;
 }
 
 std::vector<std::string> LinkStateManager::getActiveNeighbors() const
 {
     std::vector<std::string> active;
-    auto now = std::chrono::steady_clock::now();
-    for (const auto &[ip, info] : neighbors)
-    {
-        // ✅ UTILISER LE MÊME TIMEOUT que purgeInactiveNeighbors()
-        if (now - info.lastSeen < std::chrono::seconds(30))
-        {
-            active.push_back(ip);
-        }
-    }
+    neighbors.forEach([&](const NeighborInfo &info)
+                      { active.push_back(info.ip); });
     return active;
 }
-void LinkStateManager::purgeInactiveNeighbors()
-{
-    auto now = std::chrono::steady_clock::now();
-    auto it = neighbors.begin();
-
-    while (it != neighbors.end())
-    {
-        auto timeSinceLastSeen = std::chrono::duration_cast<std::chrono::seconds>(
-            now - it->second.lastSeen);
 
-        // TIMEOUT TRÈS GÉNÉREUX : 45 secondes au lieu de 10
-        if (timeSinceLastSeen > std::chrono::seconds(30))
-        {
-            it = neighbors.erase(it);
-        }
-        else
+std::vector<NeighborSnapshot> LinkStateManager::getNeighbors(NeighborState minState) const
+{
+    std::vector<NeighborSnapshot> result;
+    neighbors.forEach([&](const NeighborInfo &info)
+                      {
+        NeighborState state = info.state.load();
+        if (state >= minState)
         {
-            ++it;
-        }
-    }
+            result.push_back({info.ip, info.hostname, state});
+        } });
+    return result;
+}
+
+int LinkStateManager::helloIntervalFor(int stability)
+{
+    // Plus le voisin est stable, plus l'intervalle peut être long
+    if (stability > 10)
+        return MAX_HELLO_INTERVAL; // Stable
+    else if (stability > 5)
+        return (MIN_HELLO_INTERVAL + MAX_HELLO_INTERVAL) / 2; // Peu stable
+    else
+        return MIN_HELLO_INTERVAL; // Instable
 }
 
 int LinkStateManager::getAdaptiveHelloInterval(const std::string &neighborIp)
 {
-    auto it = neighbors.find(neighborIp);
-    if (it == neighbors.end())
+    auto info = neighbors.find(neighborIp);
+    if (!info)
     {
         return MIN_HELLO_INTERVAL; // Défaut pour nouveaux voisins
     }
 
-    // Plus le voisin est stable, plus l'intervalle peut être long
-    int stability = it->second.stabilityCounter;
-    if (stability > 20)
-        return MAX_HELLO_INTERVAL; // Très stable
-    else if (stability > 15)
-        return 20; // Stable
-    else if (stability > 10)
-        return 15; // Moyennement stable
-    else if (stability > 5)
-        return 10; // Peu stable
-    else
-        return MIN_HELLO_INTERVAL; // Instable
+    return helloIntervalFor(info->stabilityCounter.load(std::memory_order_relaxed));
 }
 
 void LinkStateManager::updateNeighborStability(const std::string &neighborIp)
 {
-    auto it = neighbors.find(neighborIp);
-    if (it != neighbors.end())
+    auto info = neighbors.find(neighborIp);
+    if (info)
     {
         // Augmenter le compteur de stabilité (max 25)
-        it->second.stabilityCounter = std::min(25, it->second.stabilityCounter + 1);
-        it->second.helloInterval = getAdaptiveHelloInterval(neighborIp);
+        int current = info->stabilityCounter.load(std::memory_order_relaxed);
+        while (current < 25 &&
+               !info->stabilityCounter.compare_exchange_weak(current, current + 1, std::memory_order_relaxed))
+        {
+        }
+        info->helloInterval.store(helloIntervalFor(std::min(25, current + 1)), std::memory_order_relaxed);
     }
 }
 
 bool LinkStateManager::isNeighborStable(const std::string &neighborIp)
 {
-    auto it = neighbors.find(neighborIp);
-    return (it != neighbors.end() && it->second.stabilityCounter >= STABILITY_THRESHOLD);
-}
\ No newline at end of file
+    auto info = neighbors.find(neighborIp);
+    return info && info->stabilityCounter.load(std::memory_order_relaxed) >= STABILITY_THRESHOLD;
+}
@@ -1,34 +1,82 @@
 #pragma once
 #include <string>
-#include <unordered_map>
 #include <chrono>
 #include <vector>
+#include <functional>
+#include <algorithm>
+#include "NeighborTable.hpp"
+#include "TimerWheel.hpp"
 
-struct NeighborInfo
+struct NeighborEvent
 {
     std::string ip;
     std::string hostname;
-    std::chrono::steady_clock::time_point lastSeen;
-    int stabilityCounter = 0; // Nouveau: compteur de stabilité
-    int helloInterval = 5;    // Nouveau: intervalle Hello adaptatif
+    NeighborState oldState;
+    NeighborState newState;
+};
+
+struct NeighborSnapshot
+{
+    std::string ip;
+    std::string hostname;
+    NeighborState state;
 };
 
 class LinkStateManager
 {
 public:
-    bool updateNeighbor(const std::string &neighborIp, const std::string &neighborHostname);
+    using StateChangeHandler = std::function<void(const NeighborEvent &)>;
+
+    explicit LinkStateManager(TimerWheel &timers);
+
+    // sawUs : le Hello reçu nous liste parmi les voisins vus (condition 2-Way)
+    // deadInterval : délai annoncé dans le Hello ; 0 (Hello de découverte, ancienne version) garde le
+    // dernier annoncé par ce voisin, DEAD_INTERVAL pour un nouveau voisin
+    bool updateNeighbor(const std::string &neighborIp, const std::string &neighborHostname, bool sawUs = true,
+                        std::chrono::seconds deadInterval = std::chrono::seconds(0));
+    // Retrait immédiat (ex. session BFD tombée), émet la transition vers Down
+    bool removeNeighbor(const std::string &neighborIp);
+    // 2-Way -> Full une fois la base synchronisée avec ce voisin
+    bool markFull(const std::string &neighborIp);
+
     std::vector<std::string> getActiveNeighborHostnames() const;
     std::vector<std::string> getActiveNeighbors() const;
-    void purgeInactiveNeighbors();
+    std::vector<NeighborSnapshot> getNeighbors(NeighborState minState = NeighborState::Init) const;
+
+    // Chaque transition d'état est émise vers ce handler (appelé hors verrou)
+    void setStateChangeHandler(StateChangeHandler handler);
 
     // Nouvelles méthodes pour l'optimisation
     int getAdaptiveHelloInterval(const std::string &neighborIp);
     void updateNeighborStability(const std::string &neighborIp);
     bool isNeighborStable(const std::string &neighborIp);
 
+    static const char *stateName(NeighborState state);
+
+    static constexpr std::chrono::seconds DEAD_INTERVAL{30};
+    // Délai de mort annoncé à un voisin : DEAD_MULTIPLIER Hello perdus, plafonné à DEAD_INTERVAL pour
+    // que l'allongement adaptatif ne ralentisse jamais la détection d'une panne
+    static constexpr int DEAD_MULTIPLIER = 4;
+    static constexpr std::chrono::seconds MAX_DEAD_INTERVAL{3600};
+    static std::chrono::seconds deadIntervalFor(int helloInterval)
+    {
+        return std::min(std::chrono::seconds(DEAD_MULTIPLIER * helloInterval), DEAD_INTERVAL);
+    }
+
 private:
-    std::unordered_map<std::string, NeighborInfo> neighbors;
+    static int helloIntervalFor(int stability);
+    void armDeadTimer(const NeighborTable::EntryPtr &info);
+    static std::chrono::seconds deadIntervalOf(const NeighborInfo &info);
+    bool transition(NeighborInfo &info, NeighborState from, NeighborState to);
+    void emit(const NeighborInfo &info, NeighborState from, NeighborState to);
+
+    // Accès concurrent : réacteur du démon (updateNeighbor, temporisations) et CLI
+    NeighborTable neighbors;
+    TimerWheel &timers;
+    StateChangeHandler onStateChange;
+
     static constexpr int STABILITY_THRESHOLD = 10;
-    static constexpr int MAX_HELLO_INTERVAL = 30;
+    // Au moins trois Hello par DEAD_INTERVAL, même sur un lien très stable
+    static constexpr int MAX_HELLO_INTERVAL = 10;
     static constexpr int MIN_HELLO_INTERVAL = 5;
-};
\ No newline at end of file
+};
@@ -0,0 +1,225 @@
+#include "Logger.hpp"
+#include "../include/json.hpp"
+#include <algorithm>
+#include <cstdarg>
+#include <cstring>
+#include <ctime>
+#include <pthread.h>
+
+namespace
+{
+    const char *const LEVEL_NAMES[] = {"trace", "debug", "info", "warn", "error", "off"};
+}
+
+Logger::ThreadQueue::ThreadQueue(std::string threadName)
+    : records(new Record[RECORDS_PER_THREAD]), threadName(std::move(threadName))
+{
+}
+
+Logger &Logger::instance()
+{
+    static Logger logger;
+    return logger;
+}
+
+Logger::~Logger()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (writer.joinable())
+        writer.join();
+    if (out != stderr)
+        std::fclose(out);
+}
+
+const char *Logger::levelName(Level level)
+{
+    return LEVEL_NAMES[static_cast<int>(level)];
+}
+
+bool Logger::parseLevel(const std::string &name, Level &level)
+{
+    for (int i = 0; i <= static_cast<int>(Level::Off); i++)
+    {
+        if (name == LEVEL_NAMES[i])
+        {
+            level = static_cast<Level>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Logger::setOutput(const std::string &path, Format newFormat)
+{
+    FILE *file = stderr;
+    if (!path.empty())
+    {
+        file = std::fopen(path.c_str(), "a");
+        if (!file)
+            return false;
+    }
+
+    // Messages déjà journalisés : vers l'ancienne destination
+    std::lock_guard<std::mutex> lock(mutex);
+    drain();
+    if (out != stderr)
+        std::fclose(out);
+    out = file;
+    format = newFormat;
+    return true;
+}
+
+void Logger::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!writer.joinable())
+        return;
+    uint64_t target = ++flushRequests;
+    cv.notify_all();
+    flushed.wait(lock, [&]()
+                 { return flushesDone >= target; });
+}
+
+Logger::ThreadQueue &Logger::localQueue()
+{
+    // L'anneau survit au thread : le thread d'écriture le vide puis le libère
+    struct Handle
+    {
+        ThreadQueue *queue = nullptr;
+        ~Handle()
+        {
+            if (queue)
+                queue->orphaned.store(true, std::memory_order_release);
+        }
+    };
+    thread_local Handle handle;
+    if (handle.queue)
+        return *handle.queue;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    char threadName[16] = {};
+    pthread_getname_np(pthread_self(), threadName, sizeof(threadName));
+    queues.push_back(std::make_unique<ThreadQueue>(threadName));
+    handle.queue = queues.back().get();
+    if (!writer.joinable())
+        writer = std::thread(&Logger::run, this);
+    return *handle.queue;
+}
+
+void Logger::write(Level level, const char *component, const char *format, ...)
+{
+    ThreadQueue &queue = localQueue();
+    uint64_t head = queue.head.load(std::memory_order_relaxed);
+    if (head - queue.tail.load(std::memory_order_acquire) >= RECORDS_PER_THREAD)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Record &record = queue.records[head % RECORDS_PER_THREAD];
+    record.wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count();
+    record.component = component;
+    record.level = level;
+    va_list args;
+    va_start(args, format);
+    int length = std::vsnprintf(record.message, MESSAGE_BYTES, format, args);
+    va_end(args);
+    record.length = static_cast<uint16_t>(std::clamp<int>(length, 0, MESSAGE_BYTES - 1));
+    queue.head.store(head + 1, std::memory_order_release);
+}
+
+void Logger::run()
+{
+    pthread_setname_np(pthread_self(), "log-writer");
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        cv.wait_for(lock, FLUSH_INTERVAL, [this]()
+                    { return stopping || flushesDone < flushRequests; });
+        uint64_t target = flushRequests;
+        bool exiting = stopping;
+        drain();
+        flushesDone = target;
+        flushed.notify_all();
+        if (exiting)
+            return;
+    }
+}
+
+void Logger::drain()
+{
+    std::vector<std::pair<const Record *, const std::string *>> batch;
+    std::vector<Record> copies;
+    std::vector<std::pair<ThreadQueue *, uint64_t>> consumed;
+
+    // Copie d'abord : les cases sont rendues au producteur avant l'écriture, plus lente
+    for (const auto &queue : queues)
+    {
+        uint64_t tail = queue->tail.load(std::memory_order_relaxed);
+        uint64_t head = queue->head.load(std::memory_order_acquire);
+        for (uint64_t index = tail; index < head; index++)
+        {
+            copies.push_back(queue->records[index % RECORDS_PER_THREAD]);
+        }
+        consumed.emplace_back(queue.get(), head);
+    }
+    size_t offset = 0;
+    for (auto &[queue, head] : consumed)
+    {
+        size_t count = head - queue->tail.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < count; i++)
+        {
+            batch.emplace_back(&copies[offset + i], &queue->threadName);
+        }
+        offset += count;
+        queue->tail.store(head, std::memory_order_release);
+    }
+
+    std::stable_sort(batch.begin(), batch.end(), [](const auto &a, const auto &b)
+                     { return a.first->wallNs < b.first->wallNs; });
+    for (const auto &[record, threadName] : batch)
+    {
+        emit(*record, *threadName);
+    }
+    if (!batch.empty())
+        std::fflush(out);
+
+    // Threads terminés dont l'anneau est vide
+    queues.erase(std::remove_if(queues.begin(), queues.end(), [](const auto &queue)
+                                { return queue->orphaned.load(std::memory_order_acquire) &&
+                                         queue->tail.load() == queue->head.load(std::memory_order_acquire); }),
+                 queues.end());
+}
+
+void Logger::emit(const Record &record, const std::string &threadName)
+{
+    time_t seconds = static_cast<time_t>(record.wallNs / 1000000000);
+    struct tm utc;
+    gmtime_r(&seconds, &utc);
+    char timestamp[40];
+    size_t n = std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &utc);
+    std::snprintf(timestamp + n, sizeof(timestamp) - n, ".%06dZ", static_cast<int>(record.wallNs % 1000000000 / 1000));
+
+    std::string message(record.message, record.length);
+    if (format == Format::Json)
+    {
+        nlohmann::json line = {{"ts", timestamp},
+                               {"level", levelName(record.level)},
+                               {"thread", threadName},
+                               {"component", record.component},
+                               {"msg", message}};
+        // Message tronqué au milieu d'un caractère UTF-8 : remplacé plutôt que rejeté
+        std::fprintf(out, "%s\n", line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace).c_str());
+    }
+    else
+    {
+        std::fprintf(out, "%s %-5s [%s] %s: %s\n", timestamp, levelName(record.level), threadName.c_str(),
+                     record.component, message.c_str());
+    }
+}
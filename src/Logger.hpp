@@ -0,0 +1,132 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Journal asynchrone du processus. Chaque thread formate son message dans une case de son propre
+// anneau (un producteur, un consommateur, sans verrou ni appel système) ; un thread d'écriture vide
+// les anneaux dans l'ordre chronologique vers stderr ou un fichier. Anneau plein : le message est
+// abandonné et compté, l'appelant n'attend jamais la console. Sous le niveau courant, un appel coûte
+// une lecture atomique et n'évalue pas ses arguments ; sous LOG_COMPILED_LEVEL, il disparaît du binaire.
+//
+//   LOG_WARN("rx", "HMAC verification failed from %s", senderIp.c_str());
+
+// Niveau minimal compilé (0 trace ... 4 error) : -DLOG_COMPILED_LEVEL=2 retire trace et debug
+#ifndef LOG_COMPILED_LEVEL
+#define LOG_COMPILED_LEVEL 0
+#endif
+
+class Logger
+{
+public:
+    enum class Level : uint8_t
+    {
+        Trace,
+        Debug,
+        Info,
+        Warn,
+        Error,
+        Off
+    };
+
+    enum class Format
+    {
+        Text,
+        Json // Une ligne JSON par message (ts, level, thread, component, msg)
+    };
+
+    static constexpr size_t MESSAGE_BYTES = 224; // Au-delà, le message est tronqué
+    static constexpr size_t RECORDS_PER_THREAD = 1024;
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{50};
+
+    static Logger &instance();
+    ~Logger();
+
+    // Niveau présent dans le binaire (LOG_COMPILED_LEVEL). Comparaison entre niveaux, jamais d'un
+    // entier non signé à 0 : pas d'avertissement « toujours vrai » (-Wtype-limits) au niveau par défaut
+    static constexpr Level COMPILED_LEVEL = static_cast<Level>(LOG_COMPILED_LEVEL);
+    static constexpr bool compiledIn(Level level) { return level >= COMPILED_LEVEL; }
+
+    static const char *levelName(Level level);
+    static bool parseLevel(const std::string &name, Level &level);
+
+    void setLevel(Level level) { minLevel.store(level, std::memory_order_relaxed); }
+    Level getLevel() const { return minLevel.load(std::memory_order_relaxed); }
+    bool isEnabled(Level level) const { return level >= minLevel.load(std::memory_order_relaxed); }
+
+    // Chemin vide : stderr. Fichier ouvert en ajout ; false s'il ne peut pas l'être (destination inchangée)
+    bool setOutput(const std::string &path, Format format);
+    // Attend l'écriture de tout ce qui a été journalisé avant l'appel
+    void flush();
+
+    // Composant : chaîne statique, seul le pointeur est conservé
+    void write(Level level, const char *component, const char *format, ...) __attribute__((format(printf, 4, 5)));
+
+    uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Record
+    {
+        int64_t wallNs;
+        const char *component;
+        Level level;
+        uint16_t length;
+        char message[MESSAGE_BYTES];
+    };
+
+    struct ThreadQueue
+    {
+        explicit ThreadQueue(std::string threadName);
+
+        std::unique_ptr<Record[]> records;
+        std::atomic<uint64_t> head{0}; // Cases publiées par le producteur (monotone)
+        std::atomic<uint64_t> tail{0}; // Cases libérées par le thread d'écriture (monotone)
+        std::atomic<bool> orphaned{false}; // Thread terminé : libéré une fois vidé
+        const std::string threadName;
+    };
+
+    Logger() = default;
+
+    ThreadQueue &localQueue();
+    void run();
+    // Sous le verrou (thread d'écriture, setOutput) : écrit les cases publiées, triées par horodatage
+    void drain();
+    void emit(const Record &record, const std::string &threadName);
+
+    std::atomic<Level> minLevel{Level::Info};
+    std::atomic<uint64_t> dropped{0};
+
+    std::mutex mutex; // Liste des anneaux, destination, réveil du thread d'écriture
+    std::condition_variable cv;
+    std::vector<std::unique_ptr<ThreadQueue>> queues;
+    FILE *out = stderr;
+    Format format = Format::Text;
+    bool stopping = false;
+    uint64_t flushRequests = 0; // flush() : tours de drain demandés / effectués
+    uint64_t flushesDone = 0;
+    std::condition_variable flushed;
+    std::thread writer; // Démarré au premier message
+};
+
+#define LOG_AT(level, component, ...)                                                      \
+    do                                                                                     \
+    {                                                                                      \
+        if constexpr (Logger::compiledIn(level))                                           \
+        {                                                                                  \
+            if (Logger::instance().isEnabled(level))                                       \
+                Logger::instance().write(level, component, __VA_ARGS__);                   \
+        }                                                                                  \
+    } while (0)
+
+#define LOG_TRACE(component, ...) LOG_AT(Logger::Level::Trace, component, __VA_ARGS__)
+#define LOG_DEBUG(component, ...) LOG_AT(Logger::Level::Debug, component, __VA_ARGS__)
+#define LOG_INFO(component, ...) LOG_AT(Logger::Level::Info, component, __VA_ARGS__)
+#define LOG_WARN(component, ...) LOG_AT(Logger::Level::Warn, component, __VA_ARGS__)
+#define LOG_ERROR(component, ...) LOG_AT(Logger::Level::Error, component, __VA_ARGS__)
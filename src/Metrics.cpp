@@ -0,0 +1,227 @@
+#include "Metrics.hpp"
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+
+Histogram::Histogram(std::vector<double> bounds)
+    : upperBounds(std::move(bounds)),
+      counts(new std::atomic<uint64_t>[upperBounds.size() + 1])
+{
+    std::sort(upperBounds.begin(), upperBounds.end());
+    for (size_t i = 0; i <= upperBounds.size(); i++)
+    {
+        counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(double value)
+{
+    size_t index = std::lower_bound(upperBounds.begin(), upperBounds.end(), value) - upperBounds.begin();
+    counts[index].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+
+    // Pas de fetch_add sur double en C++17
+    double current = sumValue.load(std::memory_order_relaxed);
+    while (!sumValue.compare_exchange_weak(current, current + value, std::memory_order_relaxed))
+    {
+    }
+}
+
+LatencyHistogram::LatencyHistogram()
+    : counts(new std::atomic<uint64_t>[BUCKET_COUNT])
+{
+    for (size_t i = 0; i < BUCKET_COUNT; i++)
+    {
+        counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t LatencyHistogram::highestEquivalent(size_t index)
+{
+    if (index < SUB_COUNT)
+        return index;
+    uint64_t shift = index / SUB_COUNT - 1;
+    uint64_t sub = index % SUB_COUNT;
+    uint64_t low = (SUB_COUNT + sub) << shift;
+    return low + (1ull << shift) - 1;
+}
+
+std::chrono::nanoseconds LatencyHistogram::quantile(double q) const
+{
+    uint64_t n = count();
+    if (n == 0)
+        return std::chrono::nanoseconds(0);
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * n));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++)
+    {
+        cumulative += counts[i].load(std::memory_order_relaxed);
+        if (cumulative >= rank)
+            return std::chrono::nanoseconds(highestEquivalent(i));
+    }
+    // Enregistrement concurrent : total en avance sur les seaux
+    return std::chrono::nanoseconds(highestEquivalent(BUCKET_COUNT - 1));
+}
+
+MetricsRegistry::Family &MetricsRegistry::family(const std::string &name, const std::string &help, Type type)
+{
+    auto [it, inserted] = families.try_emplace(name);
+    if (inserted)
+    {
+        it->second.type = type;
+        it->second.help = help;
+    }
+    return it->second;
+}
+
+Counter &MetricsRegistry::counter(const std::string &name, const std::string &help, const Labels &labels)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &slot = family(name, help, Type::Counter).counters[formatLabels(labels)];
+    if (!slot)
+        slot = std::make_unique<Counter>();
+    return *slot;
+}
+
+Gauge &MetricsRegistry::gauge(const std::string &name, const std::string &help, const Labels &labels)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &slot = family(name, help, Type::Gauge).gauges[formatLabels(labels)];
+    if (!slot)
+        slot = std::make_unique<Gauge>();
+    return *slot;
+}
+
+Histogram &MetricsRegistry::histogram(const std::string &name, const std::string &help,
+                                      const std::vector<double> &upperBounds, const Labels &labels)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &slot = family(name, help, Type::Histogram).histograms[formatLabels(labels)];
+    if (!slot)
+        slot = std::make_unique<Histogram>(upperBounds);
+    return *slot;
+}
+
+LatencyHistogram &MetricsRegistry::latency(const std::string &name, const std::string &help, const Labels &labels)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &slot = family(name, help, Type::Summary).latencies[formatLabels(labels)];
+    if (!slot)
+        slot = std::make_unique<LatencyHistogram>();
+    return *slot;
+}
+
+void MetricsRegistry::gaugeCollector(const std::string &name, const std::string &help, Collector collector)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    family(name, help, Type::Gauge).collectors.push_back(std::move(collector));
+}
+
+std::string MetricsRegistry::formatLabels(const Labels &labels)
+{
+    if (labels.empty())
+        return "";
+
+    std::string out = "{";
+    for (size_t i = 0; i < labels.size(); i++)
+    {
+        if (i > 0)
+            out += ",";
+        out += labels[i].first + "=\"";
+        for (char c : labels[i].second)
+        {
+            if (c == '\\' || c == '"')
+                out += '\\';
+            if (c == '\n')
+            {
+                out += "\\n";
+                continue;
+            }
+            out += c;
+        }
+        out += "\"";
+    }
+    return out + "}";
+}
+
+std::string MetricsRegistry::withLabel(const std::string &labels, const std::string &name, const std::string &value)
+{
+    std::string extra = name + "=\"" + value + "\"";
+    if (labels.empty())
+        return "{" + extra + "}";
+    return labels.substr(0, labels.size() - 1) + "," + extra + "}";
+}
+
+std::string MetricsRegistry::formatValue(double value)
+{
+    if (std::isinf(value))
+        return value > 0 ? "+Inf" : "-Inf";
+    if (std::isnan(value))
+        return "NaN";
+
+    std::ostringstream oss;
+    oss << std::setprecision(17) << value;
+    return oss.str();
+}
+
+std::string MetricsRegistry::render() const
+{
+    // Les collecteurs sont appelés sous verrou : ils ne doivent pas enregistrer de métriques
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream out;
+
+    for (const auto &[name, fam] : families)
+    {
+        const char *typeName = fam.type == Type::Counter     ? "counter"
+                               : fam.type == Type::Gauge     ? "gauge"
+                               : fam.type == Type::Histogram ? "histogram"
+                                                             : "summary";
+        out << "# HELP " << name << " " << fam.help << "\n";
+        out << "# TYPE " << name << " " << typeName << "\n";
+
+        for (const auto &[labels, value] : fam.counters)
+        {
+            out << name << labels << " " << value->get() << "\n";
+        }
+        for (const auto &[labels, value] : fam.gauges)
+        {
+            out << name << labels << " " << value->get() << "\n";
+        }
+        for (const auto &collector : fam.collectors)
+        {
+            for (const auto &[labels, value] : collector())
+            {
+                out << name << formatLabels(labels) << " " << formatValue(value) << "\n";
+            }
+        }
+        for (const auto &[labels, hist] : fam.histograms)
+        {
+            uint64_t cumulative = 0;
+            const auto &bounds = hist->bounds();
+            for (size_t i = 0; i < bounds.size(); i++)
+            {
+                cumulative += hist->bucketCount(i);
+                out << name << "_bucket" << withLabel(labels, "le", formatValue(bounds[i])) << " " << cumulative << "\n";
+            }
+            cumulative += hist->bucketCount(bounds.size());
+            // _count dérivé des seaux : cohérent avec +Inf même pendant une observation concurrente
+            out << name << "_bucket" << withLabel(labels, "le", "+Inf") << " " << cumulative << "\n";
+            out << name << "_sum" << labels << " " << formatValue(hist->sum()) << "\n";
+            out << name << "_count" << labels << " " << cumulative << "\n";
+        }
+        for (const auto &[labels, hist] : fam.latencies)
+        {
+            for (const char *q : {"0.5", "0.99", "0.999"})
+            {
+                double seconds = std::chrono::duration<double>(hist->quantile(std::stod(q))).count();
+                out << name << withLabel(labels, "quantile", q) << " " << formatValue(seconds) << "\n";
+            }
+            out << name << "_sum" << labels << " " << formatValue(std::chrono::duration<double>(hist->sum()).count()) << "\n";
+            out << name << "_count" << labels << " " << hist->count() << "\n";
+        }
+    }
+    return out.str();
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <chrono>
+
+// Registre de métriques exporté au format texte Prometheus. L'enregistrement se fait sous
+// verrou (démarrage, première utilisation) ; les mises à jour sont de simples opérations
+// atomiques relâchées, sans allocation ni verrou sur les chemins chauds.
+class Counter
+{
+public:
+    void inc(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value{0};
+};
+
+class Gauge
+{
+public:
+    void set(int64_t v) { value.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { value.fetch_add(n, std::memory_order_relaxed); }
+    int64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value{0};
+};
+
+// Histogramme à bornes fixes (cumulé à l'export, comme attendu par Prometheus)
+class Histogram
+{
+public:
+    explicit Histogram(std::vector<double> upperBounds);
+
+    void observe(double value);
+
+    const std::vector<double> &bounds() const { return upperBounds; }
+    uint64_t bucketCount(size_t index) const { return counts[index].load(std::memory_order_relaxed); }
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    double sum() const { return sumValue.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<double> upperBounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> counts; // upperBounds.size() + 1 (+Inf)
+    std::atomic<uint64_t> total{0};
+    std::atomic<double> sumValue{0.0};
+};
+
+// Histogramme de latence log-linéaire (façon HDR) : valeurs en nanosecondes, 32 sous-seaux
+// linéaires par puissance de deux, soit une erreur relative d'au plus ~3 % sur toute la plage.
+// Enregistrement : un calcul d'indice et un fetch_add relâché, sans verrou ni allocation.
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned SUB_BITS = 5;
+    static constexpr uint64_t SUB_COUNT = 1ull << SUB_BITS;
+    static constexpr unsigned MAX_MAGNITUDE = 47; // ~39 h : les valeurs au-delà sont écrêtées
+    static constexpr size_t BUCKET_COUNT = SUB_COUNT * (MAX_MAGNITUDE - SUB_BITS + 2);
+
+    LatencyHistogram();
+
+    void record(std::chrono::nanoseconds latency)
+    {
+        uint64_t ns = latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0;
+        counts[indexOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        sumNs.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    // Borne haute du seau contenant le quantile q (0..1), 0 si vide
+    std::chrono::nanoseconds quantile(double q) const;
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    std::chrono::nanoseconds sum() const { return std::chrono::nanoseconds(sumNs.load(std::memory_order_relaxed)); }
+
+private:
+    static size_t indexOf(uint64_t ns)
+    {
+        if (ns < SUB_COUNT)
+            return static_cast<size_t>(ns);
+        unsigned magnitude = 63 - __builtin_clzll(ns);
+        if (magnitude > MAX_MAGNITUDE)
+            return BUCKET_COUNT - 1;
+        unsigned shift = magnitude - SUB_BITS;
+        return static_cast<size_t>((shift + 1) * SUB_COUNT + ((ns >> shift) & (SUB_COUNT - 1)));
+    }
+    static uint64_t highestEquivalent(size_t index);
+
+    std::unique_ptr<std::atomic<uint64_t>[]> counts;
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sumNs{0};
+};
+
+// Mesure la portée courante (y compris les sorties anticipées par continue/return)
+class LatencyTimer
+{
+public:
+    explicit LatencyTimer(LatencyHistogram &histogram)
+        : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+    ~LatencyTimer() { histogram.record(std::chrono::steady_clock::now() - start); }
+
+    LatencyTimer(const LatencyTimer &) = delete;
+    LatencyTimer &operator=(const LatencyTimer &) = delete;
+
+private:
+    LatencyHistogram &histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+class MetricsRegistry
+{
+public:
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+    // Échantillons calculés au moment de la collecte (taille de la LSDB, états des voisins...)
+    using Collector = std::function<std::vector<std::pair<Labels, double>>()>;
+
+    // Même nom et mêmes labels : même instance (adresse stable pour toute la durée du registre)
+    Counter &counter(const std::string &name, const std::string &help, const Labels &labels = {});
+    Gauge &gauge(const std::string &name, const std::string &help, const Labels &labels = {});
+    Histogram &histogram(const std::string &name, const std::string &help,
+                         const std::vector<double> &upperBounds, const Labels &labels = {});
+    // Exporté comme summary (p50/p99/p999 en secondes)
+    LatencyHistogram &latency(const std::string &name, const std::string &help, const Labels &labels = {});
+    void gaugeCollector(const std::string &name, const std::string &help, Collector collector);
+
+    // Format d'exposition texte 0.0.4
+    std::string render() const;
+
+private:
+    enum class Type
+    {
+        Counter,
+        Gauge,
+        Histogram,
+        Summary
+    };
+
+    struct Family
+    {
+        Type type = Type::Counter;
+        std::string help;
+        std::map<std::string, std::unique_ptr<Counter>> counters; // labels formatés -> valeur
+        std::map<std::string, std::unique_ptr<Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+        std::map<std::string, std::unique_ptr<LatencyHistogram>> latencies;
+        std::vector<Collector> collectors;
+    };
+
+    Family &family(const std::string &name, const std::string &help, Type type);
+    static std::string formatLabels(const Labels &labels);
+    static std::string withLabel(const std::string &labels, const std::string &name, const std::string &value);
+    static std::string formatValue(double value);
+
+    mutable std::mutex mutex;
+    std::map<std::string, Family> families; // Trié par nom : sortie stable
+};
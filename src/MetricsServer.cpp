@@ -0,0 +1,134 @@
+#include "MetricsServer.hpp"
+#include <iostream>
+#include <cstdio>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+MetricsServer::MetricsServer(const MetricsRegistry &registry, int port)
+    : registry(registry), port(port)
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+bool MetricsServer::start()
+{
+    if (running.load())
+        return false;
+
+    sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0)
+    {
+        perror("metrics socket");
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    // Local uniquement : la collecte passe par un agent sur chaque routeur
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (bind(sock, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(sock, 8) < 0)
+    {
+        perror("metrics bind");
+        close(sock);
+        sock = -1;
+        return false;
+    }
+
+    running.store(true);
+    worker = std::thread(&MetricsServer::run, this);
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    if (!running.exchange(false))
+        return;
+
+    // Réveille le poll en cours : l'arrêt du démon n'attend pas POLL_INTERVAL_MS
+    shutdown(sock, SHUT_RDWR);
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+    close(sock);
+    sock = -1;
+}
+
+void MetricsServer::run()
+{
+    while (running.load())
+    {
+        pollfd pfd{sock, POLLIN, 0};
+        if (poll(&pfd, 1, POLL_INTERVAL_MS) <= 0)
+            continue;
+
+        int client = accept(sock, nullptr, nullptr);
+        if (client < 0)
+            continue;
+
+        serveClient(client);
+        close(client);
+    }
+}
+
+void MetricsServer::serveClient(int client)
+{
+    // Un collecteur lent ne doit pas bloquer le thread indéfiniment
+    timeval timeout{CLIENT_TIMEOUT_MS / 1000, (CLIENT_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Lire jusqu'à la fin des en-têtes (les requêtes de collecte n'ont pas de corps)
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_BYTES)
+    {
+        pollfd pfd{client, POLLIN, 0};
+        if (poll(&pfd, 1, CLIENT_TIMEOUT_MS) <= 0)
+            return;
+
+        ssize_t len = recv(client, buffer, sizeof(buffer), 0);
+        if (len <= 0)
+            return;
+        request.append(buffer, len);
+    }
+
+    std::string status = "200 OK";
+    std::string body;
+    std::string contentType = "text/plain; version=0.0.4; charset=utf-8";
+    if (request.rfind("GET /metrics ", 0) == 0 || request.rfind("GET / ", 0) == 0)
+    {
+        body = registry.render();
+    }
+    else
+    {
+        status = "404 Not Found";
+        contentType = "text/plain";
+        body = "not found\n";
+    }
+
+    std::string response = "HTTP/1.1 " + status + "\r\n" +
+                           "Content-Type: " + contentType + "\r\n" +
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+                           "Connection: close\r\n\r\n" + body;
+
+    size_t sent = 0;
+    while (sent < response.size())
+    {
+        ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+            return;
+        sent += n;
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <atomic>
+#include <thread>
+#include "Metrics.hpp"
+
+// Exportateur HTTP minimal : GET /metrics sur 127.0.0.1, une requête par connexion.
+// Thread propre, jamais sur le chemin des paquets de routage.
+class MetricsServer
+{
+public:
+    MetricsServer(const MetricsRegistry &registry, int port);
+    ~MetricsServer();
+
+    bool start();
+    void stop();
+
+private:
+    static constexpr int POLL_INTERVAL_MS = 200;
+    static constexpr int CLIENT_TIMEOUT_MS = 1000;
+    static constexpr size_t MAX_REQUEST_BYTES = 8192;
+
+    void run();
+    void serveClient(int client);
+
+    const MetricsRegistry &registry;
+    int port;
+    int sock = -1;
+    std::atomic<bool> running{false};
+    std::thread worker;
+};
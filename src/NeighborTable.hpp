@@ -0,0 +1,188 @@
+#pragma once
+#include <string>
+#include <array>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// États d'adjacence (sous-ensemble de la machine à états OSPF)
+enum class NeighborState
+{
+    Down,
+    Init,   // Hello reçu, le voisin ne nous a pas encore vus
+    TwoWay, // Communication bidirectionnelle établie
+    Full    // Bases LSA synchronisées
+};
+
+struct NeighborInfo
+{
+    explicit NeighborInfo(const std::string &ip, const std::string &hostname)
+        : ip(ip), hostname(hostname) {}
+
+    const std::string ip;
+    const std::string hostname;
+
+    // Champs mis à jour sur le chemin des paquets sans verrou exclusif
+    std::atomic<std::chrono::steady_clock::rep> lastSeen{0};
+    std::atomic<int> stabilityCounter{0}; // compteur de stabilité
+    std::atomic<int> helloInterval{5};    // intervalle Hello adaptatif
+    std::atomic<int> deadInterval{30};    // délai de mort annoncé par le voisin (secondes)
+    std::atomic<uint64_t> deadTimer{0};   // temporisation d'inactivité (TimerWheel)
+    std::atomic<NeighborState> state{NeighborState::Down};
+
+    std::chrono::steady_clock::time_point getLastSeen() const
+    {
+        return std::chrono::steady_clock::time_point(
+            std::chrono::steady_clock::duration(lastSeen.load(std::memory_order_relaxed)));
+    }
+
+    void touch(std::chrono::steady_clock::time_point now)
+    {
+        lastSeen.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+    }
+};
+
+// Table de voisins partitionnée, lecture par instantané (copie à l'écriture) : chaque shard publie
+// une table immuable derrière un pointeur atomique brut. Une recherche incrémente le compteur de
+// lecteurs du shard, charge le pointeur puis décrémente le compteur : ni verrou ni attente, même
+// pendant une insertion ou une purge, qui copient la table à l'écart des lecteurs puis publient la
+// nouvelle par un échange de pointeur. L'ancienne table est mise de côté et libérée par un
+// écrivain qui observe le compteur à zéro après sa publication (tout lecteur arrivé ensuite voit
+// la nouvelle). Les écrivains d'un même shard sont sérialisés. Insertions et purges sont rares
+// (apparition, mort d'un voisin), les lectures ont lieu à chaque paquet.
+class NeighborTable
+{
+public:
+    static constexpr size_t SHARD_COUNT = 16;
+    using EntryPtr = std::shared_ptr<NeighborInfo>;
+
+    EntryPtr find(const std::string &ip) const
+    {
+        Snapshot snapshot(shardFor(ip));
+        auto it = snapshot->find(ip);
+        return it != snapshot->end() ? it->second : nullptr;
+    }
+
+    // Retourne (entrée, true) si l'entrée vient d'être créée
+    std::pair<EntryPtr, bool> findOrInsert(const std::string &ip, const std::string &hostname)
+    {
+        if (auto existing = find(ip))
+            return {existing, false};
+
+        Shard &shard = shardFor(ip);
+        std::lock_guard<std::mutex> lock(shard.writeMutex);
+        const Map &current = shard.currentLocked();
+        auto it = current.find(ip);
+        if (it != current.end())
+            return {it->second, false}; // Inséré par un autre écrivain entre-temps
+
+        auto entry = std::make_shared<NeighborInfo>(ip, hostname);
+        auto next = std::make_unique<Map>(current);
+        next->emplace(ip, entry);
+        shard.publishLocked(std::move(next));
+        return {entry, true};
+    }
+
+    bool erase(const std::string &ip)
+    {
+        return eraseIf(ip, [](const NeighborInfo &)
+                       { return true; });
+    }
+
+    // Supprime l'entrée seulement si c'est toujours 'expected' (pas une recréation)
+    bool eraseIfSame(const std::string &ip, const NeighborInfo *expected)
+    {
+        return eraseIf(ip, [expected](const NeighborInfo &info)
+                       { return &info == expected; });
+    }
+
+    // Parcourt l'instantané de chaque shard : pas de verrou tenu pendant 'fn'
+    void forEach(const std::function<void(const NeighborInfo &)> &fn) const
+    {
+        for (const auto &shard : shards)
+        {
+            Snapshot snapshot(shard);
+            for (const auto &[ip, info] : *snapshot)
+            {
+                fn(*info);
+            }
+        }
+    }
+
+private:
+    using Map = std::unordered_map<std::string, EntryPtr>;
+
+    struct Shard
+    {
+        ~Shard() { delete current.load(std::memory_order_relaxed); }
+
+        const Map &currentLocked() const { return *current.load(std::memory_order_relaxed); }
+
+        void publishLocked(std::unique_ptr<const Map> next)
+        {
+            retired.emplace_back(current.exchange(next.release(), std::memory_order_seq_cst));
+            // Compteur nul après l'échange : aucun lecteur ne tient plus une table retirée
+            if (readers.load(std::memory_order_seq_cst) == 0)
+                retired.clear();
+        }
+
+        std::atomic<const Map *> current{new Map()};
+        mutable std::atomic<uint32_t> readers{0};
+        std::mutex writeMutex;                           // Écrivains du shard
+        std::vector<std::unique_ptr<const Map>> retired; // Sous writeMutex
+    };
+
+    // Lecture de l'instantané courant d'un shard, table retenue jusqu'à la destruction
+    class Snapshot
+    {
+    public:
+        explicit Snapshot(const Shard &shard) : shard(shard)
+        {
+            shard.readers.fetch_add(1, std::memory_order_seq_cst);
+            map = shard.current.load(std::memory_order_seq_cst);
+        }
+        ~Snapshot() { shard.readers.fetch_sub(1, std::memory_order_release); }
+        Snapshot(const Snapshot &) = delete;
+        Snapshot &operator=(const Snapshot &) = delete;
+
+        const Map &operator*() const { return *map; }
+        const Map *operator->() const { return map; }
+
+    private:
+        const Shard &shard;
+        const Map *map;
+    };
+
+    template <typename Predicate>
+    bool eraseIf(const std::string &ip, Predicate matches)
+    {
+        Shard &shard = shardFor(ip);
+        std::lock_guard<std::mutex> lock(shard.writeMutex);
+        const Map &current = shard.currentLocked();
+        auto it = current.find(ip);
+        if (it == current.end() || !matches(*it->second))
+            return false;
+
+        auto next = std::make_unique<Map>(current);
+        next->erase(ip);
+        shard.publishLocked(std::move(next));
+        return true;
+    }
+
+    Shard &shardFor(const std::string &ip)
+    {
+        return shards[std::hash<std::string>{}(ip) % SHARD_COUNT];
+    }
+
+    const Shard &shardFor(const std::string &ip) const
+    {
+        return shards[std::hash<std::string>{}(ip) % SHARD_COUNT];
+    }
+
+    std::array<Shard, SHARD_COUNT> shards;
+};
@@ -0,0 +1,103 @@
+#include "NextHopResolver.hpp"
+#include "utils.hpp"
+
+using json = nlohmann::json;
+
+NextHopResolver::NextHopResolver(const std::vector<std::string> &localInterfaces,
+                                 AddressProvider addressProvider, const ProtocolClock &clock)
+    : localInterfaces(localInterfaces), addressProvider(std::move(addressProvider)), clock(clock)
+{
+}
+
+void NextHopResolver::refresh(const TopologyDatabase &topoDb)
+{
+    uint64_t gen = topoDb.getGeneration();
+    auto now = clock.now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    bool interfacesDue = !valid || now - lastInterfaceCheck >= INTERFACE_REFRESH;
+    if (!interfacesDue && gen == lastGeneration)
+    {
+        return; // Cas courant : ni appel système ni comparaison
+    }
+
+    if (interfacesDue)
+    {
+        auto localAddresses = addressProvider();
+        lastInterfaceCheck = now;
+        if (valid && gen == lastGeneration && localAddresses == lastLocalAddresses)
+        {
+            return; // Rien n'a changé
+        }
+        lastLocalAddresses = std::move(localAddresses);
+    }
+
+    rebuild(topoDb, lastLocalAddresses);
+    lastGeneration = gen;
+    valid = true;
+}
+
+void NextHopResolver::rebuild(const TopologyDatabase &topoDb,
+                              const std::vector<LocalInterfaceAddress> &localAddresses)
+{
+    // Liens locaux dans l'ordre de la configuration (priorité conservée)
+    std::vector<LocalLink> localLinks;
+    for (const auto &localIp : localInterfaces)
+    {
+        uint32_t addr;
+        if (!parseIpv4(localIp, addr))
+            continue;
+
+        for (const auto &local : localAddresses)
+        {
+            if (local.ip == localIp)
+            {
+                localLinks.push_back({Ipv4Prefix::fromAddress(addr, local.prefixLength), local.name});
+                break;
+            }
+        }
+    }
+
+    index.clear();
+    topoDb.forEachLSA([&](const std::string &routerId, const json &lsa)
+                      {
+        if (!lsa.contains("interfaces"))
+            return;
+
+        std::vector<std::pair<uint32_t, std::string>> remoteAddresses;
+        for (const auto &nhIp : lsa["interfaces"])
+        {
+            uint32_t addr;
+            if (nhIp.is_string() && parseIpv4(nhIp.get<std::string>(), addr))
+                remoteAddresses.emplace_back(addr, nhIp.get<std::string>());
+        }
+
+        // Premier lien local (ordre de configuration) partagé avec ce routeur
+        for (const auto &link : localLinks)
+        {
+            for (const auto &[addr, ip] : remoteAddresses)
+            {
+                if (link.subnet.contains(addr))
+                {
+                    index[routerId] = {ip, link.ifName};
+                    return;
+                }
+            }
+        } });
+}
+
+bool NextHopResolver::resolve(const std::string &routerId, NextHop &out) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(routerId);
+    if (it == index.end())
+        return false;
+    out = it->second;
+    return true;
+}
+
+void NextHopResolver::invalidate()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    valid = false;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <functional>
+#include "TopologyDatabase.hpp"
+#include "Ipv4Prefix.hpp"
+#include "utils.hpp"
+#include "ProtocolClock.hpp"
+
+struct NextHop
+{
+    std::string ip;     // Adresse du voisin sur le lien partagé
+    std::string ifName; // Interface de sortie locale
+};
+
+// Index routeur -> (next-hop IP, interface de sortie), reconstruit uniquement
+// quand la LSDB ou les interfaces locales changent. Les interfaces locales (getifaddrs)
+// sont relues au plus une fois par INTERFACE_REFRESH, pas à chaque mise à jour des routes.
+class NextHopResolver
+{
+public:
+    using AddressProvider = std::function<std::vector<LocalInterfaceAddress>()>;
+
+    explicit NextHopResolver(const std::vector<std::string> &localInterfaces,
+                             AddressProvider addressProvider = getLocalInterfaceAddresses,
+                             const ProtocolClock &clock = ProtocolClock::steady());
+
+    void refresh(const TopologyDatabase &topoDb);
+    bool resolve(const std::string &routerId, NextHop &out) const;
+    // Reconstruction et relecture des interfaces au prochain refresh
+    void invalidate();
+
+private:
+    void rebuild(const TopologyDatabase &topoDb,
+                 const std::vector<LocalInterfaceAddress> &localAddresses);
+
+    struct LocalLink
+    {
+        Ipv4Prefix subnet;
+        std::string ifName;
+    };
+
+    static constexpr std::chrono::seconds INTERFACE_REFRESH{30};
+
+    std::vector<std::string> localInterfaces;
+    AddressProvider addressProvider;
+    const ProtocolClock &clock;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, NextHop> index;
+    std::vector<LocalInterfaceAddress> lastLocalAddresses;
+    ProtocolClock::time_point lastInterfaceCheck;
+    uint64_t lastGeneration = 0;
+    bool valid = false;
+};
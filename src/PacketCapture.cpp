@@ -0,0 +1,254 @@
+#include "PacketCapture.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+
+namespace
+{
+    constexpr size_t ALIGN = sizeof(PacketCapture::RecordHeader);
+
+    size_t alignUp(size_t n)
+    {
+        return (n + ALIGN - 1) & ~(ALIGN - 1);
+    }
+
+    int64_t toNanos(ProtocolClock::time_point at)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(at.time_since_epoch()).count();
+    }
+}
+
+PacketCapture::PacketCapture(MetricsRegistry &metrics, size_t ringBytes)
+    : ringBytes(alignUp(std::max(ringBytes, 2 * ALIGN))),
+      recordsTotal(metrics.counter("ospf_capture_records_total", "Received datagrams written to the capture ring")),
+      bytesTotal(metrics.counter("ospf_capture_bytes_total", "Payload bytes written to the capture ring")),
+      droppedTotal(metrics.counter("ospf_capture_dropped_total", "Datagrams not captured because the ring was full"))
+{
+}
+
+PacketCapture::~PacketCapture()
+{
+    stop();
+}
+
+bool PacketCapture::start(const std::string &capturePath, const std::string &hostname, int port,
+                          ProtocolClock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (active.load() || writer.joinable())
+        return false;
+
+    file = std::fopen(capturePath.c_str(), "wb");
+    if (!file)
+    {
+        LOG_ERROR("capture", "Cannot open capture file %s: %s", capturePath.c_str(), std::strerror(errno));
+        return false;
+    }
+
+    FileHeader fileHeader{};
+    std::memcpy(fileHeader.magic, MAGIC, sizeof(MAGIC));
+    fileHeader.version = FORMAT_VERSION;
+    fileHeader.port = static_cast<uint32_t>(port);
+    fileHeader.wallClockNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::system_clock::now().time_since_epoch())
+                                 .count();
+    fileHeader.protocolClockNs = toNanos(now);
+    std::strncpy(fileHeader.hostname, hostname.c_str(), sizeof(fileHeader.hostname) - 1);
+    if (std::fwrite(&fileHeader, sizeof(fileHeader), 1, file) != 1)
+    {
+        LOG_ERROR("capture", "Cannot write capture file %s", capturePath.c_str());
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+
+    // Aucun producteur en cours : stop() a attendu inFlight == 0
+    path = capturePath;
+    ring.assign(ringBytes, 0);
+    head.store(0);
+    tail.store(0);
+    sessionRecords.store(0);
+    sessionBytes.store(0);
+    sessionDropped.store(0);
+    stopping = false;
+    writer = std::thread(&PacketCapture::run, this);
+    active.store(true);
+    return true;
+}
+
+void PacketCapture::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!writer.joinable())
+            return;
+        active.store(false);
+    }
+    // Ordre séquentiel (active puis inFlight, inverse côté producteur) : plus aucune écriture après
+    while (inFlight.load() != 0)
+    {
+        std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    writer.join(); // Vide l'anneau avant de rendre la main
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::fclose(file);
+    file = nullptr;
+    ring = std::vector<char>();
+}
+
+void PacketCapture::record(ProtocolClock::time_point at, const std::string &senderIp, const char *data, size_t len)
+{
+    if (!active.load(std::memory_order_relaxed))
+        return;
+    inFlight.fetch_add(1);
+    if (!active.load())
+    {
+        inFlight.fetch_sub(1);
+        return;
+    }
+
+    const size_t capacity = ring.size();
+    const uint64_t need = sizeof(RecordHeader) + alignUp(len);
+    const uint64_t start = head.load(std::memory_order_relaxed);
+    size_t pos = static_cast<size_t>(start % capacity);
+    const uint64_t padding = pos + need > capacity ? capacity - pos : 0;
+    const uint64_t used = start - tail.load(std::memory_order_acquire);
+
+    if (need + padding > capacity - used)
+    {
+        sessionDropped.fetch_add(1, std::memory_order_relaxed);
+        droppedTotal.inc();
+        inFlight.fetch_sub(1);
+        return;
+    }
+
+    if (padding > 0)
+    {
+        RecordHeader marker{0, 0, PADDING};
+        std::memcpy(&ring[pos], &marker, sizeof(marker));
+        pos = 0;
+    }
+    in_addr addr{};
+    inet_pton(AF_INET, senderIp.c_str(), &addr);
+    RecordHeader recordHeader{toNanos(at), addr.s_addr, static_cast<uint32_t>(len)};
+    std::memcpy(&ring[pos], &recordHeader, sizeof(recordHeader));
+    std::memcpy(&ring[pos + sizeof(recordHeader)], data, len);
+    head.store(start + padding + need, std::memory_order_release);
+
+    sessionRecords.fetch_add(1, std::memory_order_relaxed);
+    sessionBytes.fetch_add(len, std::memory_order_relaxed);
+    recordsTotal.inc();
+    bytesTotal.inc(len);
+
+    // Au-delà de la moitié de l'anneau, le thread d'écriture n'attend pas FLUSH_INTERVAL
+    if (used < capacity / 2 && used + padding + need >= capacity / 2)
+        cv.notify_one();
+    inFlight.fetch_sub(1);
+}
+
+PacketCapture::Status PacketCapture::getStatus() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return {active.load(), path, sessionRecords.load(), sessionBytes.load(), sessionDropped.load()};
+}
+
+void PacketCapture::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping)
+    {
+        cv.wait_for(lock, FLUSH_INTERVAL);
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+    lock.unlock();
+    drain();
+}
+
+void PacketCapture::drain()
+{
+    const size_t capacity = ring.size();
+    uint64_t position = tail.load(std::memory_order_relaxed);
+    const uint64_t end = head.load(std::memory_order_acquire);
+    if (position == end)
+        return;
+
+    bool ok = true;
+    while (position < end)
+    {
+        size_t pos = static_cast<size_t>(position % capacity);
+        RecordHeader recordHeader;
+        std::memcpy(&recordHeader, &ring[pos], sizeof(recordHeader));
+        if (recordHeader.length == PADDING)
+        {
+            position += capacity - pos;
+            continue;
+        }
+        ok = ok && std::fwrite(&recordHeader, sizeof(recordHeader), 1, file) == 1;
+        ok = ok && std::fwrite(&ring[pos + sizeof(recordHeader)], 1, recordHeader.length, file) == recordHeader.length;
+        position += sizeof(recordHeader) + alignUp(recordHeader.length);
+    }
+    tail.store(position, std::memory_order_release);
+    if (!ok || std::fflush(file) != 0)
+    {
+        LOG_ERROR("capture", "Packet capture write failed: %s", std::strerror(errno));
+    }
+}
+
+PacketCaptureReader::~PacketCaptureReader()
+{
+    if (file)
+        std::fclose(file);
+}
+
+bool PacketCaptureReader::open(const std::string &path, std::string &error)
+{
+    file = std::fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        error = std::strerror(errno);
+        return false;
+    }
+    if (std::fread(&fileHeader, sizeof(fileHeader), 1, file) != 1 ||
+        std::memcmp(fileHeader.magic, PacketCapture::MAGIC, sizeof(PacketCapture::MAGIC)) != 0)
+    {
+        error = "not a capture file";
+        return false;
+    }
+    if (fileHeader.version != PacketCapture::FORMAT_VERSION)
+    {
+        error = "unsupported capture format version " + std::to_string(fileHeader.version);
+        return false;
+    }
+    fileHeader.hostname[sizeof(fileHeader.hostname) - 1] = '\0';
+    return true;
+}
+
+bool PacketCaptureReader::next(Record &record)
+{
+    PacketCapture::RecordHeader recordHeader;
+    if (!file || std::fread(&recordHeader, sizeof(recordHeader), 1, file) != 1)
+        return false;
+
+    record.payload.resize(recordHeader.length);
+    if (recordHeader.length > 0 && std::fread(&record.payload[0], 1, recordHeader.length, file) != recordHeader.length)
+        return false;
+
+    record.at = ProtocolClock::time_point(std::chrono::nanoseconds(recordHeader.timestampNs));
+    in_addr addr{};
+    addr.s_addr = recordHeader.senderIp;
+    char buf[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &addr, buf, sizeof(buf));
+    record.senderIp = buf;
+    return true;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+#include <cstdio>
+#include "Metrics.hpp"
+#include "ProtocolClock.hpp"
+
+// Capture des datagrammes reçus, pour rejouer hors ligne la séquence exacte vue par le chemin de
+// réception. Le réacteur du démon (seul producteur) copie chaque datagramme dans un anneau
+// d'octets préalloué, sans verrou ni appel système ; un thread d'écriture le vide dans le fichier.
+// Anneau plein : l'enregistrement est abandonné et compté, la réception n'attend jamais le disque.
+// L'anneau n'est alloué que pendant une capture.
+//
+// Fichier : FileHeader, puis pour chaque datagramme RecordHeader suivi de 'length' octets
+// (ordre d'octets de l'hôte, adresse IPv4 en ordre réseau).
+class PacketCapture
+{
+public:
+    static constexpr char MAGIC[8] = {'R', 'O', 'U', 'T', 'C', 'A', 'P', '\0'};
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr size_t DEFAULT_RING_BYTES = 4 * 1024 * 1024;
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{100};
+
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t port;
+        int64_t wallClockNs;     // Début de capture, temps civil (corrélation avec les journaux)
+        int64_t protocolClockNs; // Même instant en temps protocolaire
+        char hostname[64];
+    };
+
+    struct RecordHeader
+    {
+        int64_t timestampNs; // Temps protocolaire à la réception
+        uint32_t senderIp;
+        uint32_t length;
+    };
+    static_assert(sizeof(RecordHeader) == 16, "RecordHeader sert aussi d'unité d'alignement de l'anneau");
+
+    PacketCapture(MetricsRegistry &metrics, size_t ringBytes = DEFAULT_RING_BYTES);
+    ~PacketCapture();
+
+    bool start(const std::string &path, const std::string &hostname, int port, ProtocolClock::time_point now);
+    // Attend la fin de l'enregistrement en cours, vide l'anneau et ferme le fichier
+    void stop();
+    bool isActive() const { return active.load(std::memory_order_relaxed); }
+
+    // Thread de réception uniquement
+    void record(ProtocolClock::time_point at, const std::string &senderIp, const char *data, size_t len);
+
+    struct Status
+    {
+        bool active = false;
+        std::string path;
+        uint64_t records = 0; // Depuis le dernier start()
+        uint64_t bytes = 0;
+        uint64_t dropped = 0;
+    };
+    Status getStatus() const;
+
+private:
+    static constexpr uint32_t PADDING = UINT32_MAX; // Fin d'anneau inutilisée : reprise au début
+
+    void run();
+    // Thread d'écriture : copie [tail, head) dans le fichier
+    void drain();
+
+    const size_t ringBytes;
+    std::vector<char> ring;
+    std::atomic<uint64_t> head{0}; // Octets réservés par le producteur (monotone)
+    std::atomic<uint64_t> tail{0}; // Octets libérés par le thread d'écriture (monotone)
+    std::atomic<bool> active{false};
+    std::atomic<int> inFlight{0}; // Producteur entre le test de 'active' et la publication
+
+    Counter &recordsTotal;
+    Counter &bytesTotal;
+    Counter &droppedTotal;
+    std::atomic<uint64_t> sessionRecords{0};
+    std::atomic<uint64_t> sessionBytes{0};
+    std::atomic<uint64_t> sessionDropped{0};
+
+    mutable std::mutex mutex; // start/stop, fichier et réveil du thread d'écriture
+    std::condition_variable cv;
+    bool stopping = false;
+    std::string path;
+    FILE *file = nullptr;
+    std::thread writer;
+};
+
+// Lecture séquentielle d'un fichier de capture (outil de rejeu)
+class PacketCaptureReader
+{
+public:
+    struct Record
+    {
+        ProtocolClock::time_point at;
+        std::string senderIp;
+        std::string payload;
+    };
+
+    ~PacketCaptureReader();
+
+    bool open(const std::string &path, std::string &error);
+    const PacketCapture::FileHeader &header() const { return fileHeader; }
+    // false en fin de fichier ou sur un enregistrement tronqué (capture interrompue)
+    bool next(Record &record);
+
+private:
+    FILE *file = nullptr;
+    PacketCapture::FileHeader fileHeader{};
+};
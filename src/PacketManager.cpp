@@ -9,546 +9,1166 @@
 #include <unistd.h>
 #include "LinkStateManager.hpp"
 #include <fcntl.h>
+#include <poll.h>
 #include <atomic>
 #include <zlib.h>
 #include "utils.hpp"
 #include <bits/this_thread_sleep.h>
+#include <algorithm>
+#include <set>
 
 using json = nlohmann::json;
 
-void PacketManager::sendHello(const std::string &destIp, int port,
-                              const std::string &hostname,
-                              const std::vector<std::string> &interfaces)
+PacketManager::PacketManager(TimerWheel &timers, MetricsRegistry &metrics, Transport &transport)
+    : counters(registerCounters(metrics)), latency(registerLatencies(metrics)), transport(transport),
+      scheduler(transport, metrics), timers(timers)
 {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0)
+    for (const char *type : {"HELLO", "LSA", "LSA_COMPRESSED", "LSA_FULL_COMPRESSED", "LS_ACK", "LS_REQUEST",
+                             "DB_DESCRIPTION", "DIGEST_QUERY", "DIGEST_REPLY", "NEIGHBOR_REQUEST",
+                             "NEIGHBOR_RESPONSE"})
     {
-        perror("socket");
-        return;
+        receivedByType[type] = &metrics.counter("ospf_packets_received_total",
+                                                "Authenticated packets received, by message type",
+                                                {{"type", type}});
     }
+    receivedOther = &metrics.counter("ospf_packets_received_total",
+                                     "Authenticated packets received, by message type", {{"type", "other"}});
+}
 
-    int broadcastEnable = 1;
-    if (setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &broadcastEnable, sizeof(broadcastEnable)) < 0)
-    {
-        perror("Error: setsockopt SO_BROADCAST");
-        close(sock);
-        return;
-    }
+PacketManager::TrafficCounters PacketManager::registerCounters(MetricsRegistry &metrics)
+{
+    return {
+        metrics.counter("ospf_lsa_bytes_sent_total", "Bytes of LSA datagrams flooded to neighbors"),
+        metrics.counter("ospf_lsa_bytes_received_total", "Bytes of LSA datagrams received"),
+        metrics.counter("ospf_lsa_encodings_total", "LSA encodings, by wire format", {{"format", "compressed"}}),
+        metrics.counter("ospf_lsa_encodings_total", "LSA encodings, by wire format", {{"format", "full"}}),
+        metrics.counter("ospf_lsa_retransmissions_total", "LSA and DB description retransmissions"),
+        metrics.counter("ospf_ls_acks_total", "LSA acknowledgements", {{"direction", "sent"}}),
+        metrics.counter("ospf_ls_acks_total", "LSA acknowledgements", {{"direction", "received"}}),
+        metrics.counter("ospf_lsa_requests_total", "LSAs requested from neighbors"),
+        metrics.counter("ospf_relays_suppressed_total", "Relays skipped by the flooding topology"),
+        metrics.counter("ospf_wire_cache_total", "Signed LSA wire cache lookups", {{"result", "hit"}}),
+        metrics.counter("ospf_wire_cache_total", "Signed LSA wire cache lookups", {{"result", "miss"}}),
+        metrics.counter("ospf_sends_skipped_total", "LSA sends skipped because the neighbor holds the instance"),
+        metrics.counter("ospf_received_bytes_total", "Bytes of all datagrams received"),
+        metrics.counter("ospf_packets_dropped_total", "Received packets dropped before processing",
+                        {{"reason", "hmac_invalid"}}),
+        metrics.counter("ospf_packets_dropped_total", "Received packets dropped before processing",
+                        {{"reason", "hmac_missing"}}),
+        metrics.counter("ospf_packets_dropped_total", "Received packets dropped before processing",
+                        {{"reason", "malformed"}}),
+        metrics.histogram("ospf_received_packet_size_bytes", "Size of received datagrams",
+                          {64, 128, 256, 512, 1024, 1500, 4096, 16384, 65536}),
+    };
+}
 
-    // Le reste de votre code d'envoi existant
-    sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
+PacketManager::PathLatency PacketManager::registerLatencies(MetricsRegistry &metrics)
+{
+    const std::string help = "Receive path latency, by processing stage";
+    return {
+        metrics.latency("ospf_packet_processing_seconds", help, {{"stage", "total"}}),
+        metrics.latency("ospf_packet_processing_seconds", help, {{"stage", "parse"}}),
+        metrics.latency("ospf_packet_processing_seconds", help, {{"stage", "hmac"}}),
+        metrics.latency("ospf_packet_processing_seconds", help, {{"stage", "lsdb_update"}}),
+        metrics.latency("ospf_packet_processing_seconds", help, {{"stage", "relay"}}),
+    };
+}
 
-    if (inet_pton(AF_INET, destIp.c_str(), &addr.sin_addr) <= 0)
-    {
-        std::cerr << "Invalid address: " << destIp << std::endl;
-        close(sock);
-        return;
-    }
+Counter &PacketManager::receivedCounter(const std::string &type)
+{
+    auto it = receivedByType.find(type);
+    return it != receivedByType.end() ? *it->second : *receivedOther;
+}
 
+void PacketManager::sendHello(const std::string &destIp, int port,
+                              const std::string &hostname,
+                              const std::vector<std::string> &interfaces,
+                              const std::vector<std::string> &seenNeighbors,
+                              bool withMeasurements,
+                              std::chrono::seconds deadInterval)
+{
     json helloMsg = {
         {"type", "HELLO"},
         {"hostname", hostname},
-        {"interfaces", interfaces}};
+        {"interfaces", interfaces},
+        {"seen", seenNeighbors}}; // Voisins entendus : condition 2-Way chez le destinataire
+    if (deadInterval.count() > 0)
+    {
+        // Couvre plusieurs de nos prochains Hello : le destinataire ne dépend pas de son propre intervalle
+        helloMsg["dead_interval"] = deadInterval.count();
+    }
+    if (withMeasurements && linkMetrics)
+    {
+        linkMetrics->fillHelloFields(destIp, helloMsg);
+    }
+    if (withMeasurements && digestProvider)
+    {
+        helloMsg["lsdb_digest"] = digestProvider();
+    }
     std::string helloStr = helloMsg.dump();
     std::string hmac = computeHMAC(helloStr, "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
     helloMsg["hmac"] = toHex(hmac);
 
-    if (sendto(sock, helloMsg.dump().c_str(), helloMsg.dump().length(), 0,
-               (sockaddr *)&addr, sizeof(addr)) < 0)
-    {
-        perror("sendto");
-    }
-
-    close(sock);
+    // Classe la plus prioritaire : jamais retardé par une inondation
+    scheduler.enqueue(destIp, port, helloMsg.dump(), TransmitScheduler::Priority::Hello);
 }
 
-void PacketManager::receivePackets(int port, LinkStateManager &lsm, std::atomic<bool> &running, const std::string &hostname, TopologyDatabase &topoDb)
+bool PacketManager::openReceiver(int port)
 {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0)
-    {
-        perror("socket");
-        return;
-    }
-
-    // Set socket as non-blocking
-    int flags = fcntl(sock, F_GETFL, 0);
-    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+    return transport.open(port);
+}
 
-    sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
-    addr.sin_addr.s_addr = INADDR_ANY;
+void PacketManager::closeReceiver()
+{
+    transport.close();
+}
 
-    if (bind(sock, (sockaddr *)&addr, sizeof(addr)) < 0)
+size_t PacketManager::pollPackets(int port, LinkStateManager &lsm, const std::string &hostname, TopologyDatabase &topoDb)
+{
+    if (stepBuffer.empty())
+        stepBuffer.resize(65536);
+    std::string senderIp;
+    size_t processed = 0;
+    ssize_t len;
+    while ((len = transport.receive(stepBuffer.data(), stepBuffer.size() - 1, senderIp)) > 0)
     {
-        perror("bind");
-        close(sock);
-        return;
+        processDatagram(stepBuffer.data(), len, senderIp, port, lsm, hostname, topoDb);
+        processed++;
     }
+    return processed;
+}
 
-    char buffer[2048];
-    while (running)
+void PacketManager::processDatagram(char *data, size_t len, const std::string &senderIp, int port,
+                                    LinkStateManager &lsm, const std::string &hostname, TopologyDatabase &topoDb)
+{
+    // Avant toute validation : le rejeu doit voir aussi les datagrammes rejetés
+    if (capture)
+        capture->record(timers.now(), senderIp, data, len);
+    data[len] = '\0';
+    counters.bytesReceived.inc(len);
+    counters.packetSize.observe(static_cast<double>(len));
+    LatencyTimer packetTimer(latency.packet);
+    TraceSpan packetSpan(tracer, "rx", "rx_packet");
+    packetSpan.setArg("bytes", static_cast<int64_t>(len));
+    const bool tracing = tracer && tracer->isEnabled();
+
+    try
     {
+        auto stageStart = std::chrono::steady_clock::now();
+        json j = json::parse(data);
+        auto parsed = std::chrono::steady_clock::now();
+        latency.parse.record(parsed - stageStart);
+        if (tracing)
+            tracer->record("rx", "parse", stageStart, parsed);
+
+        if (j.contains("hmac"))
+        {
+            std::string receivedHmac = j["hmac"];
+            j.erase("hmac");
+            std::string computedHmac = computeHMAC(j.dump(), "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
+            auto verified = std::chrono::steady_clock::now();
+            latency.hmac.record(verified - parsed);
+            if (tracing)
+                tracer->record("rx", "hmac", parsed, verified);
+            if (receivedHmac != toHex(computedHmac))
+            {
+                LOG_WARN("rx", "HMAC verification failed from %s, packet dropped", senderIp.c_str());
+                counters.hmacFailures.inc();
+                return;
+            }
+        }
+        else
+        {
+            LOG_WARN("rx", "No HMAC from %s, packet dropped", senderIp.c_str());
+            counters.hmacMissing.inc();
+            return;
+        }
+        // Nos propres LSA relayés par un voisin doivent tout de même être acquittés
+        const std::string type = j.value("type", "");
+        receivedCounter(type).inc();
+        const bool isLSA = type == "LSA" || type == "LSA_FULL_COMPRESSED" || type == "LSA_COMPRESSED";
+        if (!isLSA && j.contains("hostname") && j["hostname"] == hostname)
+        {
+            return;
+        }
 
-        sockaddr_in sender{};
-        socklen_t senderLen = sizeof(sender);
-
-        ssize_t len = recvfrom(sock, buffer, sizeof(buffer) - 1, 0,
-                               (sockaddr *)&sender, &senderLen);
-
-        if (len > 0)
+        if (j.contains("type") && j["type"] == "HELLO")
         {
-            buffer[len] = '\0';
+            std::string neighborHostname = j.value("hostname", "");
 
-            try
+            // Anciennes versions sans "seen" : considérées bidirectionnelles
+            bool sawUs = true;
+            if (j.contains("seen") && j["seen"].is_array())
+            {
+                sawUs = std::find(j["seen"].begin(), j["seen"].end(), hostname) != j["seen"].end();
+            }
+            std::chrono::seconds deadInterval(0);
+            if (j.contains("dead_interval") && j["dead_interval"].is_number_unsigned())
+            {
+                deadInterval = std::chrono::seconds(j["dead_interval"].get<uint32_t>());
+            }
+            lsm.updateNeighbor(senderIp, neighborHostname, sawUs, deadInterval);
+            if (linkMetrics)
+            {
+                linkMetrics->onHelloReceived(senderIp, j);
+            }
+            if (j.contains("lsdb_digest") && j["lsdb_digest"].is_number_unsigned())
             {
-                json j = json::parse(buffer);
+                maybeStartDigestSync(senderIp, port, hostname, j["lsdb_digest"].get<uint64_t>(), topoDb);
+            }
+        }
+        if (isLSA)
+        {
+            // Gérer les différents types
+            json lsaToProcess = j;
 
-                if (j.contains("hmac"))
+            if (type == "LSA_COMPRESSED")
+            {
+                // Décompresser si nécessaire
+                if (j.contains("compressed_data"))
                 {
-                    std::string receivedHmac = j["hmac"];
-                    j.erase("hmac");
-                    std::string computedHmac = computeHMAC(j.dump(), "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
-                    if (receivedHmac != toHex(computedHmac))
+                    std::string decompressed = decompressData(j["compressed_data"]);
+                    if (!decompressed.empty())
                     {
-                        std::cerr << "HMAC verification failed! Packet dropped." << std::endl;
-                        continue;
+                        lsaToProcess = json::parse(decompressed);
                     }
                 }
-                else
-                {
-                    std::cerr << "No HMAC found! Packet dropped." << std::endl;
-                    continue;
-                }
-                if (j.contains("hostname") && j["hostname"] == hostname)
-                {
-                    continue;
-                }
+            }
 
-                if (j.contains("type") && j["type"] == "HELLO")
-                {
-                    char senderIp[INET_ADDRSTRLEN];
-                    inet_ntop(AF_INET, &sender.sin_addr, senderIp, INET_ADDRSTRLEN);
+            if (!lsaToProcess.contains("hostname") || !lsaToProcess.contains("sequence_number"))
+            {
+                return;
+            }
 
-                    std::string neighborHostname = j.value("hostname", "");
-                    lsm.updateNeighbor(senderIp, neighborHostname);
-                }
-                if (j.contains("type") && (j["type"] == "LSA" ||
-                                           j["type"] == "LSA_FULL_COMPRESSED" ||
-                                           j["type"] == "LSA_DIFFERENTIAL" ||
-                                           j["type"] == "LSA_COMPRESSED"))
-                {
-                    char senderIp[INET_ADDRSTRLEN];
-                    inet_ntop(AF_INET, &sender.sin_addr, senderIp, INET_ADDRSTRLEN);
+            const std::string origin = lsaToProcess["hostname"];
+            const int sequence = lsaToProcess["sequence_number"];
+            const uint64_t checksum = TopologyDatabase::checksumOf(lsaToProcess);
+            counters.totalBytesReceived.inc(len);
 
+            // Acquitter toute instance reçue, même dupliquée ou plus ancienne
+            const bool maxAge = TopologyDatabase::isMaxAge(lsaToProcess);
+            queueAck(senderIp, port, hostname, origin, sequence, maxAge);
+            // Un voisin qui nous envoie cette instance l'a déjà : ack implicite
+            recordNeighborInstance(senderIp, origin, {sequence, maxAge, checksum});
+            handleAck(senderIp, origin, sequence, maxAge, false);
 
-                    // Gérer les différents types
-                    json lsaToProcess = j;
+            if (origin == hostname)
+            {
+                // Instance de notre LSA antérieure à un redémarrage, ou purgée par un tiers :
+                // réoriginer au-delà
+                json ownLSA;
+                if ((!topoDb.getLSA(hostname, ownLSA) || TopologyDatabase::isNewer(lsaToProcess, ownLSA)) &&
+                    selfLSAHandler)
+                {
+                    selfLSAHandler(sequence);
+                }
+                return;
+            }
 
-                    if (j["type"] == "LSA_COMPRESSED")
-                    {
-                        // Décompresser si nécessaire
-                        if (j.contains("compressed_data"))
-                        {
-                            std::string decompressed = decompressData(j["compressed_data"]);
-                            if (!decompressed.empty())
-                            {
-                                lsaToProcess = json::parse(decompressed);
-                            }
-                        }
-                    }
-                    else if (j["type"] == "LSA_DIFFERENTIAL")
+            auto updateStart = std::chrono::steady_clock::now();
+            bool updated = topoDb.updateLSA(lsaToProcess);
+            auto updateEnd = std::chrono::steady_clock::now();
+            latency.lsdbUpdate.record(updateEnd - updateStart);
+            if (tracing)
+                tracer->record("rx", "lsa_install", updateStart, updateEnd, "updated", updated);
+
+            if (updated)
+            {
+                LatencyTimer relayTimer(latency.relay);
+                TraceSpan relaySpan(tracer, "rx", "lsa_relay");
+                // Datagramme reçu déjà signé : relayé tel quel, sans réencodage
+                cacheWire(lsaToProcess, std::make_shared<const std::string>(data, len), checksum);
+
+                // RELAY TO ADJACENT NEIGHBORS (except sender), restricted to the
+                // flooding topology when it is enabled and consistent
+                auto adjacent = lsm.getNeighbors(NeighborState::TwoWay);
+                std::set<std::string> relays;
+                bool reduced = false;
+                if (floodingTopology)
+                {
+                    std::vector<std::string> adjacentHostnames;
+                    for (const auto &neighbor : adjacent)
                     {
-                        // Pour l'instant, traiter comme un LSA normal
-                        // TODO: Implémenter la logique différentielle si nécessaire
-                        lsaToProcess = j;
+                        adjacentHostnames.push_back(neighbor.hostname);
                     }
-                    else if (j["type"] == "LSA_FULL_COMPRESSED")
+                    // Recalcul différé au réacteur : seule la comparaison des voisins reste ici
+                    floodingTopology->noteInstalled(lsaToProcess);
+                    reduced = floodingTopology->selectRelays(adjacentHostnames, relays);
+                }
+
+                std::vector<std::string> floodTargets;
+                for (const auto &neighbor : adjacent)
+                {
+                    if (neighbor.ip == senderIp)
+                        continue;
+                    if (reduced && !relays.count(neighbor.hostname))
                     {
-                        // Traiter comme un LSA normal
-                        lsaToProcess = j;
+                        counters.relaysSuppressed.inc();
+                        continue;
                     }
-
-                    bool updated = topoDb.updateLSA(lsaToProcess);
-
-                    if (updated)
+                    floodTargets.push_back(neighbor.ip);
+                }
+                floodLSA(floodTargets, port, lsaToProcess, hostname);
+            }
+            else
+            {
+                // Le voisin a une instance plus ancienne : lui renvoyer la nôtre
+                json current;
+                if (topoDb.getLSA(origin, current) && TopologyDatabase::isNewer(current, lsaToProcess))
+                {
+                    floodLSA({senderIp}, port, current, hostname);
+                }
+            }
+        }
+        if (type == "DB_DESCRIPTION")
+        {
+            handleDescription(senderIp, port, hostname, j, topoDb);
+        }
+        if (type == "DIGEST_QUERY" || type == "DIGEST_REPLY")
+        {
+            if (type == "DIGEST_QUERY")
+                handleDigestQuery(senderIp, port, hostname, j, topoDb);
+            else
+                handleDigestReply(senderIp, port, hostname, j, topoDb);
+        }
+        if (type == "LS_REQUEST")
+        {
+            if (j.contains("dd_ack"))
+            {
+                handleDescriptionAck(senderIp, j["dd_ack"].get<int>());
+            }
+            if (j.contains("requests") && j["requests"].is_array())
+            {
+                for (const auto &origin : j["requests"])
+                {
+                    json lsa;
+                    if (origin.is_string() && topoDb.getLSA(origin.get<std::string>(), lsa))
                     {
-
-                        // RELAY TO ALL ACTIVE NEIGHBORS (except sender)
-                        auto neighbors = lsm.getActiveNeighbors();
-                        for (const auto &neighborIp : neighbors)
-                        {
-                            if (neighborIp != senderIp)
-                            {
-                                sendLSA(neighborIp, port, lsaToProcess);
-                            }
-                        }
+                        forgetKnownInstance(senderIp, origin.get<std::string>()); // Demandé : il ne l'a pas
+                        floodLSA({senderIp}, port, lsa, hostname, TransmitScheduler::Priority::Bulk);
                     }
                 }
-                if (j.contains("type") && j["type"] == "NEIGHBOR_REQUEST")
+            }
+        }
+        if (type == "LS_ACK" && j.contains("acks") && j["acks"].is_array())
+        {
+            for (const auto &ack : j["acks"])
+            {
+                // [origine, séquence] ou [origine, séquence, MaxAge] pour une purge
+                if (ack.is_array() && (ack.size() == 2 || (ack.size() == 3 && ack[2].is_boolean())))
                 {
-                    char senderIp[INET_ADDRSTRLEN];
-                    inet_ntop(AF_INET, &sender.sin_addr, senderIp, INET_ADDRSTRLEN);
+                    handleAck(senderIp, ack[0].get<std::string>(), ack[1].get<int>(),
+                              ack.size() == 3 && ack[2].get<bool>(), true);
+                }
+            }
+        }
+        if (j.contains("type") && j["type"] == "NEIGHBOR_REQUEST")
+        {
+            auto neighborIps = lsm.getActiveNeighbors();
+            auto neighborHostnames = lsm.getActiveNeighborHostnames();
 
-                    auto neighborIps = lsm.getActiveNeighbors();
-                    auto neighborHostnames = lsm.getActiveNeighborHostnames();
+            json neighbors = json::array();
+            for (size_t i = 0; i < std::min(neighborIps.size(), neighborHostnames.size()); ++i)
+            {
+                neighbors.push_back({{"ip", neighborIps[i]},
+                                     {"hostname", neighborHostnames[i]}});
+            }
 
-                    json neighbors = json::array();
-                    for (size_t i = 0; i < std::min(neighborIps.size(), neighborHostnames.size()); ++i)
-                    {
-                        neighbors.push_back({{"ip", neighborIps[i]},
-                                             {"hostname", neighborHostnames[i]}});
-                    }
+            json responseMsg = {
+                {"type", "NEIGHBOR_RESPONSE"},
+                {"hostname", hostname},
+                {"neighbors", neighbors}};
 
-                    json responseMsg = {
-                        {"type", "NEIGHBOR_RESPONSE"},
-                        {"hostname", hostname},
-                        {"neighbors", neighbors}};
+            std::string responseStr = responseMsg.dump();
+            std::string hmac = computeHMAC(responseStr, "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
+            responseMsg["hmac"] = toHex(hmac);
 
-                    std::string responseStr = responseMsg.dump();
-                    std::string hmac = computeHMAC(responseStr, "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
-                    responseMsg["hmac"] = toHex(hmac);
+            sendDatagram(senderIp, port, responseMsg.dump(), TransmitScheduler::Priority::Bulk);
+        }
 
-                    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-                    if (sock >= 0)
-                    {
-                        sockaddr_in addr{};
-                        addr.sin_family = AF_INET;
-                        addr.sin_port = htons(port);
-
-                        if (inet_pton(AF_INET, senderIp, &addr.sin_addr) > 0)
-                        {
-                            sendto(sock, responseMsg.dump().c_str(), responseMsg.dump().length(), 0,
-                                   (sockaddr *)&addr, sizeof(addr));
-                        }
-                        close(sock);
-                    }
-                }
+        if (j.contains("type") && j["type"] == "NEIGHBOR_RESPONSE")
+        {
+            std::string senderHostname = j.value("hostname", "unknown");
+            std::cout << "\n=== Neighbors of " << senderHostname << " ===" << std::endl;
 
-                if (j.contains("type") && j["type"] == "NEIGHBOR_RESPONSE")
-                {
-                    std::string senderHostname = j.value("hostname", "unknown");
-                    std::cout << "\n=== Neighbors of " << senderHostname << " ===" << std::endl;
+            if (j.contains("neighbors") && j["neighbors"].is_array())
+            {
+                auto neighbors = j["neighbors"];
+                std::cout << "Active neighbors (" << neighbors.size() << "):" << std::endl;
 
-                    if (j.contains("neighbors") && j["neighbors"].is_array())
+                for (const auto &neighbor : neighbors)
+                {
+                    if (neighbor.contains("hostname") && neighbor.contains("ip"))
                     {
-                        auto neighbors = j["neighbors"];
-                        std::cout << "Active neighbors (" << neighbors.size() << "):" << std::endl;
-
-                        for (const auto &neighbor : neighbors)
-                        {
-                            if (neighbor.contains("hostname") && neighbor.contains("ip"))
-                            {
-                                std::cout << "  - " << neighbor["hostname"].get<std::string>()
-                                          << " (" << neighbor["ip"].get<std::string>() << ")" << std::endl;
-                            }
-                            else if (neighbor.is_string())
-                            {
-                                // Compatibilité avec l'ancien format
-                                std::cout << "  - " << neighbor.get<std::string>() << std::endl;
-                            }
-                        }
+                        std::cout << "  - " << neighbor["hostname"].get<std::string>()
+                                  << " (" << neighbor["ip"].get<std::string>() << ")" << std::endl;
                     }
-                    else
+                    else if (neighbor.is_string())
                     {
-                        std::cout << "No active neighbors" << std::endl;
+                        // Compatibilité avec l'ancien format
+                        std::cout << "  - " << neighbor.get<std::string>() << std::endl;
                     }
-                    std::cout << "=========================" << std::endl;
                 }
             }
-            catch (...)
+            else
             {
+                std::cout << "No active neighbors" << std::endl;
             }
-        }
-        else if (len == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            std::cout << "=========================" << std::endl;
         }
     }
-
-    close(sock);
+    catch (...)
+    {
+        counters.malformed.inc();
+    }
 }
 
 void PacketManager::sendLSA(const std::string &destIp, int port, const json &lsaMsg)
 {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0)
+    json lsaToSend = lsaMsg;
+    lsaToSend.erase("hmac");
+    std::string lsaStr = lsaToSend.dump();
+    std::string hmac = computeHMAC(lsaStr, "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
+    lsaToSend["hmac"] = toHex(hmac);
+
+    sendDatagram(destIp, port, lsaToSend.dump(), TransmitScheduler::Priority::Update);
+}
+
+void PacketManager::sendNeighborRequest(const std::string &destIp, int port, const std::string &hostname)
+{
+    json requestMsg = {
+        {"type", "NEIGHBOR_REQUEST"},
+        {"hostname", hostname}};
+
+    std::string requestStr = requestMsg.dump();
+    std::string hmac = computeHMAC(requestStr, "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
+    requestMsg["hmac"] = toHex(hmac);
+
+    sendDatagram(destIp, port, requestMsg.dump(), TransmitScheduler::Priority::Control);
+}
+
+void PacketManager::sendNeighborResponse(const std::string &destIp, int port, const std::string &hostname, const std::vector<std::string> &neighbors)
+{
+    json responseMsg = {
+        {"type", "NEIGHBOR_RESPONSE"},
+        {"hostname", hostname},
+        {"neighbors", neighbors}};
+
+    std::string responseStr = responseMsg.dump();
+    std::string hmac = computeHMAC(responseStr, "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
+    responseMsg["hmac"] = toHex(hmac);
+
+    sendDatagram(destIp, port, responseMsg.dump(), TransmitScheduler::Priority::Bulk);
+}
+
+void PacketManager::sendDatagram(const std::string &destIp, int port, std::string payload,
+                                 TransmitScheduler::Priority priority)
+{
+    scheduler.enqueue(destIp, port, std::move(payload), priority);
+}
+
+std::shared_ptr<const std::string> PacketManager::encodeLSA(const json &lsa, const std::string &hostname)
+{
+    // LSA complet (auto-descriptif : origine + séquence) pour pouvoir être acquitté
+    json messageToSend = lsa;
+    messageToSend.erase("hmac");
+    std::string jsonStr = messageToSend.dump();
+    if (jsonStr.size() > 500)
+    { // Comprimer si > 500 bytes
+        std::string compressed = compressData(jsonStr);
+        if (compressed.size() < jsonStr.size() * 0.8)
+        { // 20% d'économie minimum
+            messageToSend = json{
+                {"type", "LSA_COMPRESSED"},
+                {"compressed_data", compressed},
+                {"hostname", hostname}};
+            counters.compressedMessages.inc();
+        }
+    }
+    if (messageToSend["type"] != "LSA_COMPRESSED")
     {
-        perror("socket");
-        return;
+        counters.fullMessages.inc();
     }
 
-    sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
+    std::string hmac = computeHMAC(messageToSend.dump(), "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
+    messageToSend["hmac"] = toHex(hmac);
+    return std::make_shared<const std::string>(messageToSend.dump());
+}
+
+std::shared_ptr<const std::string> PacketManager::getWire(const json &lsa, const std::string &hostname,
+                                                         uint64_t &checksum)
+{
+    const std::string origin = lsa["hostname"];
+    const int sequence = lsa["sequence_number"];
+    const bool maxAge = TopologyDatabase::isMaxAge(lsa);
+    auto now = timers.now();
 
-    if (inet_pton(AF_INET, destIp.c_str(), &addr.sin_addr) <= 0)
     {
-        std::cerr << "Invalid address: " << destIp << std::endl;
-        close(sock);
-        return;
+        std::lock_guard<std::mutex> lock(wireCacheMutex);
+        auto it = wireCache.find(origin);
+        if (it != wireCache.end() && it->second.sequence == sequence && it->second.maxAge == maxAge &&
+            now - it->second.encoded < WIRE_CACHE_TTL)
+        {
+            counters.wireCacheHits.inc();
+            checksum = it->second.checksum;
+            return it->second.wire;
+        }
+        counters.wireCacheMisses.inc();
     }
 
-    json lsaToSend = lsaMsg;
-    lsaToSend.erase("hmac");
-    std::string lsaStr = lsaToSend.dump();
-    std::string hmac = computeHMAC(lsaStr, "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
-    lsaToSend["hmac"] = toHex(hmac);
+    auto wire = encodeLSA(lsa, hostname);
+    checksum = TopologyDatabase::checksumOf(lsa);
+    cacheWire(lsa, wire, checksum);
+    return wire;
+}
 
-    if (sendto(sock, lsaToSend.dump().c_str(), lsaToSend.dump().length(), 0,
-               (sockaddr *)&addr, sizeof(addr)) < 0)
+void PacketManager::cacheWire(const json &lsa, std::shared_ptr<const std::string> wire, uint64_t checksum)
+{
+    std::lock_guard<std::mutex> lock(wireCacheMutex);
+    auto now = timers.now();
+    CachedWire &entry = wireCache[lsa["hostname"].get<std::string>()];
+    entry.sequence = lsa["sequence_number"];
+    entry.maxAge = TopologyDatabase::isMaxAge(lsa);
+    entry.checksum = checksum;
+    entry.encoded = now;
+    entry.wire = std::move(wire);
+
+    // Entrées expirées (origines purgées ou inactives) : balayage au plus une fois par TTL
+    if (now - lastWireCacheSweep >= WIRE_CACHE_TTL)
     {
-        perror("sendto");
+        lastWireCacheSweep = now;
+        for (auto it = wireCache.begin(); it != wireCache.end();)
+        {
+            if (now - it->second.encoded >= WIRE_CACHE_TTL)
+                it = wireCache.erase(it);
+            else
+                ++it;
+        }
     }
-    close(sock);
 }
 
-void PacketManager::sendNeighborRequest(const std::string &destIp, int port, const std::string &hostname)
+void PacketManager::floodLSA(const std::vector<std::string> &neighborIps, int port,
+                             const json &lsa, const std::string &hostname,
+                             TransmitScheduler::Priority priority)
 {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0)
-    {
-        perror("socket");
+    if (neighborIps.empty() || !lsa.contains("hostname") || !lsa.contains("sequence_number"))
         return;
+
+    const std::string origin = lsa["hostname"];
+    const int sequence = lsa["sequence_number"];
+    KnownInstance instance{sequence, TopologyDatabase::isMaxAge(lsa), 0};
+    auto wire = getWire(lsa, hostname, instance.checksum);
+    auto now = timers.now();
+
+    std::vector<std::string> targets;
+    {
+        std::lock_guard<std::mutex> lock(floodMutex);
+        for (const auto &neighborIp : neighborIps)
+        {
+            auto stateIt = floodStates.find(neighborIp);
+            if (stateIt == floodStates.end())
+                continue; // Pas (ou plus) un voisin
+            FloodState &state = stateIt->second;
+            state.port = port;
+            state.hostname = hostname;
+
+            // Le voisin a déjà cette instance (ou plus récente) : rien à envoyer
+            if (holdsInstance(state, origin, instance))
+            {
+                counters.sendsSkipped.inc();
+                continue;
+            }
+
+            // Une version plus récente remplace l'ancienne dans la liste de retransmission
+            PendingLSA &pending = state.retransmitList[origin];
+            pending.sequence = sequence;
+            pending.instance = instance;
+            pending.priority = priority;
+            pending.wire = wire;
+            pending.firstSent = now;
+            pending.lastSent = now;
+            pending.transmissions = 1;
+
+            scheduleRetransmit(state, neighborIp);
+            targets.push_back(neighborIp);
+        }
+        counters.totalBytesSent.inc(wire->size() * targets.size());
     }
 
-    sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
+    for (const auto &neighborIp : targets)
+    {
+        scheduler.enqueue(neighborIp, port, wire, priority);
+    }
+}
+
+const PacketManager::KnownInstance *PacketManager::KnownInstances::find(const std::string &origin) const
+{
+    auto it = index.find(origin);
+    return it != index.end() ? &it->second->second : nullptr;
+}
 
-    if (inet_pton(AF_INET, destIp.c_str(), &addr.sin_addr) <= 0)
+void PacketManager::KnownInstances::put(const std::string &origin, const KnownInstance &instance)
+{
+    auto it = index.find(origin);
+    if (it != index.end())
     {
-        std::cerr << "Invalid address: " << destIp << std::endl;
-        close(sock);
+        it->second->second = instance;
+        order.splice(order.begin(), order, it->second);
         return;
     }
 
-    json requestMsg = {
-        {"type", "NEIGHBOR_REQUEST"},
-        {"hostname", hostname}};
+    if (index.size() >= MAX_KNOWN_PER_NEIGHBOR)
+    {
+        index.erase(order.back().first);
+        order.pop_back();
+    }
+    order.emplace_front(origin, instance);
+    index.emplace(origin, order.begin());
+}
 
-    std::string requestStr = requestMsg.dump();
-    std::string hmac = computeHMAC(requestStr, "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
-    requestMsg["hmac"] = toHex(hmac);
+void PacketManager::KnownInstances::erase(const std::string &origin)
+{
+    auto it = index.find(origin);
+    if (it == index.end())
+        return;
+    order.erase(it->second);
+    index.erase(it);
+}
 
-    if (sendto(sock, requestMsg.dump().c_str(), requestMsg.dump().length(), 0,
-               (sockaddr *)&addr, sizeof(addr)) < 0)
+bool PacketManager::holdsInstance(const FloodState &state, const std::string &origin, const KnownInstance &instance)
+{
+    const KnownInstance *held = state.known.find(origin);
+    if (!held)
+        return false;
+
+    return !TopologyDatabase::isNewer(instance.sequence, instance.checksum, instance.maxAge,
+                                      held->sequence, held->checksum, held->maxAge);
+}
+
+void PacketManager::recordKnown(FloodState &state, const std::string &origin, const KnownInstance &instance,
+                                bool fromNeighbor)
+{
+    // Appelé sous floodMutex. Un ack ne fait qu'avancer l'instance connue ; ce que le voisin
+    // envoie lui-même fait foi (il a pu redémarrer avec une base plus ancienne).
+    const KnownInstance *held = state.known.find(origin);
+    if (held && !fromNeighbor &&
+        !TopologyDatabase::isNewer(instance.sequence, instance.checksum, instance.maxAge,
+                                   held->sequence, held->checksum, held->maxAge))
+        return;
+
+    state.known.put(origin, instance);
+}
+
+void PacketManager::recordNeighborInstance(const std::string &neighborIp, const std::string &origin,
+                                           const KnownInstance &instance)
+{
+    std::lock_guard<std::mutex> lock(floodMutex);
+    auto it = floodStates.find(neighborIp);
+    if (it != floodStates.end())
+        recordKnown(it->second, origin, instance, true);
+}
+
+void PacketManager::scheduleRetransmit(FloodState &state, const std::string &neighborIp)
+{
+    // Appelé sous floodMutex
+    if (state.retransmitTimer == TimerWheel::INVALID_TIMER)
     {
-        perror("sendto");
+        state.retransmitTimer = timers.schedule(state.rto, [this, neighborIp]()
+                                                { onRetransmitTimer(neighborIp); });
     }
-    close(sock);
 }
 
-void PacketManager::sendNeighborResponse(const std::string &destIp, int port, const std::string &hostname, const std::vector<std::string> &neighbors)
+void PacketManager::onRetransmitTimer(const std::string &neighborIp)
 {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0)
+    std::vector<std::pair<std::shared_ptr<const std::string>, TransmitScheduler::Priority>> toSend;
+    int port;
     {
-        perror("socket");
-        return;
+        std::lock_guard<std::mutex> lock(floodMutex);
+        auto it = floodStates.find(neighborIp);
+        if (it == floodStates.end())
+            return;
+
+        FloodState &state = it->second;
+        state.retransmitTimer = TimerWheel::INVALID_TIMER;
+        port = state.port;
+
+        auto now = timers.now();
+        auto nextDue = state.rto;
+        auto collect = [&](PendingLSA &pending)
+        {
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - pending.lastSent);
+            if (elapsed >= state.rto)
+            {
+                pending.lastSent = now;
+                pending.transmissions++;
+                toSend.emplace_back(pending.wire, pending.priority);
+            }
+            else
+            {
+                nextDue = std::min(nextDue, state.rto - elapsed);
+            }
+        };
+        for (auto &[origin, pending] : state.retransmitList)
+        {
+            collect(pending);
+        }
+        for (auto &[descriptionId, pending] : state.pendingDescriptions)
+        {
+            collect(pending);
+        }
+
+        if (!toSend.empty())
+        {
+            // Backoff exponentiel tant que le voisin n'acquitte pas
+            state.rto = std::min(state.rto * 2, MAX_RTO);
+            counters.retransmissions.inc(toSend.size());
+            nextDue = std::min(nextDue, state.rto);
+        }
+
+        if (!state.retransmitList.empty() || !state.pendingDescriptions.empty())
+        {
+            state.retransmitTimer = timers.schedule(nextDue, [this, neighborIp]()
+                                                    { onRetransmitTimer(neighborIp); });
+        }
     }
 
-    sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
+    for (const auto &[wire, priority] : toSend)
+    {
+        scheduler.enqueue(neighborIp, port, wire, priority);
+    }
+}
 
-    if (inet_pton(AF_INET, destIp.c_str(), &addr.sin_addr) <= 0)
+void PacketManager::updateRto(FloodState &state, std::chrono::microseconds sample)
+{
+    // RFC 6298 : SRTT/RTTVAR lissés, RTO = SRTT + 4 * RTTVAR
+    if (!state.hasRttSample)
     {
-        std::cerr << "Invalid address: " << destIp << std::endl;
-        close(sock);
-        return;
+        state.srtt = sample;
+        state.rttvar = sample / 2;
+        state.hasRttSample = true;
+    }
+    else
+    {
+        auto delta = state.srtt > sample ? state.srtt - sample : sample - state.srtt;
+        state.rttvar = (state.rttvar * 3 + delta) / 4;
+        state.srtt = (state.srtt * 7 + sample) / 8;
     }
 
-    json responseMsg = {
-        {"type", "NEIGHBOR_RESPONSE"},
-        {"hostname", hostname},
-        {"neighbors", neighbors}};
+    auto rto = std::chrono::duration_cast<std::chrono::milliseconds>(state.srtt + state.rttvar * 4);
+    state.rto = std::clamp(rto, MIN_RTO, MAX_RTO);
+}
 
-    std::string responseStr = responseMsg.dump();
-    std::string hmac = computeHMAC(responseStr, "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
-    responseMsg["hmac"] = toHex(hmac);
+void PacketManager::handleAck(const std::string &neighborIp, const std::string &origin, int sequence, bool maxAge,
+                              bool explicitAck)
+{
+    std::lock_guard<std::mutex> lock(floodMutex);
+    auto it = floodStates.find(neighborIp);
+    if (it == floodStates.end())
+        return;
+
+    FloodState &state = it->second;
+    auto pendingIt = state.retransmitList.find(origin);
+    if (pendingIt == state.retransmitList.end())
+        return;
+
+    // Identité d'instance (RFC 2328 §13.7) : à séquence égale, l'ack d'une instance vivante ne
+    // couvre pas la purge MaxAge en attente
+    const KnownInstance &pending = pendingIt->second.instance;
+    if (TopologyDatabase::isNewer(pending.sequence, 0, pending.maxAge, sequence, 0, maxAge))
+        return;
+
+    recordKnown(state, origin, pendingIt->second.instance, false);
+
+    // Algorithme de Karn : pas d'échantillon RTT sur un LSA retransmis
+    if (explicitAck && pendingIt->second.transmissions == 1)
+    {
+        updateRto(state, std::chrono::duration_cast<std::chrono::microseconds>(
+                             timers.now() - pendingIt->second.firstSent));
+    }
+    state.retransmitList.erase(pendingIt);
+    if (explicitAck)
+        counters.acksReceived.inc();
 
-    if (sendto(sock, responseMsg.dump().c_str(), responseMsg.dump().length(), 0,
-               (sockaddr *)&addr, sizeof(addr)) < 0)
+    if (state.retransmitList.empty() && state.pendingDescriptions.empty() &&
+        state.retransmitTimer != TimerWheel::INVALID_TIMER)
     {
-        perror("sendto");
+        timers.cancel(state.retransmitTimer);
+        state.retransmitTimer = TimerWheel::INVALID_TIMER;
     }
-    close(sock);
 }
 
-void PacketManager::sendOptimizedLSA(const std::string &destIp, int port,
-                                     const nlohmann::json &currentLSA, const std::string &hostname)
+void PacketManager::handleDescriptionAck(const std::string &neighborIp, int descriptionId)
 {
-    // Calculer le hash du LSA actuel
-    std::string currentData = currentLSA.dump();
-    std::string currentHash = computeHMAC(currentData, "lsa_optimization_key");
+    std::lock_guard<std::mutex> lock(floodMutex);
+    auto it = floodStates.find(neighborIp);
+    if (it == floodStates.end())
+        return;
 
-    auto hashIt = lastSentLSAHash.find(destIp);
-    bool shouldSendFull = (hashIt == lastSentLSAHash.end() || hashIt->second != currentHash);
+    FloodState &state = it->second;
+    auto pendingIt = state.pendingDescriptions.find(descriptionId);
+    if (pendingIt == state.pendingDescriptions.end())
+        return;
 
-    if (!shouldSendFull)
+    if (pendingIt->second.transmissions == 1)
     {
-        // LSA identique, pas d'envoi nécessaire
-        return;
+        updateRto(state, std::chrono::duration_cast<std::chrono::microseconds>(
+                             timers.now() - pendingIt->second.firstSent));
     }
+    state.pendingDescriptions.erase(pendingIt);
 
-    json messageToSend;
-    auto lsaIt = lastSentLSA.find(destIp);
+    if (state.retransmitList.empty() && state.pendingDescriptions.empty() &&
+        state.retransmitTimer != TimerWheel::INVALID_TIMER)
+    {
+        timers.cancel(state.retransmitTimer);
+        state.retransmitTimer = TimerWheel::INVALID_TIMER;
+    }
+}
 
-    if (lsaIt != lastSentLSA.end())
+void PacketManager::startDatabaseExchange(const std::string &neighborIp, int port, const std::string &hostname,
+                                          const std::vector<TopologyDatabase::LsaHeader> &headers)
+{
+    // Au moins une description, même vide : elle sert d'accusé de fin d'échange
+    std::vector<std::shared_ptr<const std::string>> wires;
     {
-        // Créer un LSA différentiel
-        json diffLSA = createDifferentialLSA(lsaIt->second, currentLSA, hostname);
+        std::lock_guard<std::mutex> lock(floodMutex);
+        auto it = floodStates.find(neighborIp);
+        if (it == floodStates.end())
+            return; // Voisin retombé avant le traitement de l'événement
+        FloodState &state = it->second;
+        state.port = port;
+        state.hostname = hostname;
+        auto now = timers.now();
+
+        size_t offset = 0;
+        do
+        {
+            size_t end = std::min(offset + MAX_HEADERS_PER_DD, headers.size());
+            json headerList = json::array();
+            for (size_t i = offset; i < end; ++i)
+            {
+                const auto &h = headers[i];
+                headerList.push_back({h.origin, h.sequence, h.checksum, h.age});
+            }
 
-        // Vérifier si le différentiel est plus petit que le LSA complet
-        std::string diffStr = diffLSA.dump();
-        std::string fullStr = currentLSA.dump();
+            int descriptionId = state.nextDescriptionId++;
+            json description = {
+                {"type", "DB_DESCRIPTION"},
+                {"hostname", hostname},
+                {"dd_id", descriptionId},
+                {"more", end < headers.size()},
+                {"headers", headerList}};
+            std::string hmac = computeHMAC(description.dump(), "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
+            description["hmac"] = toHex(hmac);
+
+            PendingLSA &pending = state.pendingDescriptions[descriptionId];
+            pending.wire = std::make_shared<const std::string>(description.dump());
+            pending.priority = TransmitScheduler::Priority::Bulk;
+            pending.firstSent = now;
+            pending.lastSent = now;
+            pending.transmissions = 1;
+            wires.push_back(pending.wire);
+
+            offset = end;
+        } while (offset < headers.size());
+
+        scheduleRetransmit(state, neighborIp);
+    }
 
-        if (diffStr.size() < fullStr.size() * 0.7)
-        { // 30% d'économie minimum
-            messageToSend = diffLSA;
-            stats.differentialMessages++;
-        }
-        else
+    for (const auto &wire : wires)
+    {
+        scheduler.enqueue(neighborIp, port, wire, TransmitScheduler::Priority::Bulk);
+    }
+}
+
+void PacketManager::handleDescription(const std::string &neighborIp, int port, const std::string &hostname,
+                                      const json &msg, TopologyDatabase &topoDb)
+{
+    // Ne demander que les instances absentes ou plus récentes que les nôtres
+    json requests = json::array();
+    if (msg.contains("headers") && msg["headers"].is_array())
+    {
+        for (const auto &h : msg["headers"])
         {
-            messageToSend = currentLSA;
-            messageToSend["type"] = "LSA_FULL_COMPRESSED";
-            stats.fullMessages++;
+            if (!h.is_array() || h.size() != 4)
+                continue;
+
+            TopologyDatabase::LsaHeader header{h[0].get<std::string>(), h[1].get<int>(),
+                                               h[2].get<uint64_t>(), h[3].get<int>()};
+            recordNeighborInstance(neighborIp, header.origin,
+                                   {header.sequence, header.age >= TopologyDatabase::MAX_AGE.count(), header.checksum});
+            // Y compris notre origine : une instance plus récente déclenche la réorigination
+            if (topoDb.needsLSA(header))
+            {
+                requests.push_back(header.origin);
+            }
         }
     }
-    else
+    counters.lsaRequests.inc(requests.size());
+
+    // La requête (éventuellement vide) acquitte la description
+    sendLSRequest(neighborIp, port, hostname, requests, msg.value("dd_id", 0));
+}
+
+void PacketManager::sendLSRequest(const std::string &neighborIp, int port, const std::string &hostname,
+                                  const json &requests, int descriptionId)
+{
+    json request = {
+        {"type", "LS_REQUEST"},
+        {"hostname", hostname},
+        {"requests", requests}};
+    if (descriptionId != 0)
     {
-        // Premier envoi, envoyer LSA complet
-        messageToSend = currentLSA;
-        messageToSend["type"] = "LSA_FULL_COMPRESSED";
-        stats.fullMessages++;
+        request["dd_ack"] = descriptionId;
     }
+    std::string hmac = computeHMAC(request.dump(), "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
+    request["hmac"] = toHex(hmac);
+    sendDatagram(neighborIp, port, request.dump(), TransmitScheduler::Priority::Control);
+}
 
-    // Compression des données si elles sont importantes
-    std::string jsonStr = messageToSend.dump();
-    if (jsonStr.size() > 500)
-    { // Comprimer si > 500 bytes
-        std::string compressed = compressData(jsonStr);
-        if (compressed.size() < jsonStr.size() * 0.8)
-        { // 20% d'économie minimum
-            messageToSend = json{
-                {"type", "LSA_COMPRESSED"},
-                {"compressed_data", compressed},
-                {"hostname", hostname}};
-            stats.compressedMessages++;
-        }
-    }
+void PacketManager::maybeStartDigestSync(const std::string &neighborIp, int port, const std::string &hostname,
+                                         uint64_t remoteDigest, TopologyDatabase &topoDb)
+{
+    if (remoteDigest == topoDb.getDigestRoot())
+        return;
 
-    // Envoyer le message optimisé
-    sendLSA(destIp, port, messageToSend);
+    {
+        std::lock_guard<std::mutex> lock(floodMutex);
+        auto it = floodStates.find(neighborIp);
+        if (it == floodStates.end())
+            return;
+        FloodState &state = it->second;
+        auto now = timers.now();
+        // Écart transitoire pendant une inondation : la descente suivante tranchera
+        if (now - state.lastDigestSync < DIGEST_SYNC_HOLDDOWN)
+            return;
+        state.lastDigestSync = now;
+    }
 
-    // Mettre à jour le cache
-    lastSentLSAHash[destIp] = currentHash;
-    lastSentLSA[destIp] = currentLSA;
-    stats.totalBytesSent += messageToSend.dump().size();
+    sendDigestQuery(neighborIp, port, hostname, {1});
 }
 
-json PacketManager::createDifferentialLSA(const json &oldLSA, const json &newLSA,
-                                          const std::string &hostname)
+void PacketManager::sendDigestQuery(const std::string &neighborIp, int port, const std::string &hostname,
+                                    const std::vector<size_t> &nodes)
 {
-    json diffLSA = {
-        {"type", "LSA_DIFFERENTIAL"},
-        {"hostname", hostname},
-        {"sequence", newLSA.value("sequence", 1)},
-        {"timestamp", std::chrono::duration_cast<std::chrono::seconds>(
-                          std::chrono::system_clock::now().time_since_epoch())
-                          .count()},
-        {"changes", json::object()}};
+    for (size_t offset = 0; offset < nodes.size(); offset += MAX_DIGEST_NODES)
+    {
+        size_t end = std::min(offset + MAX_DIGEST_NODES, nodes.size());
+        json query = {
+            {"type", "DIGEST_QUERY"},
+            {"hostname", hostname},
+            {"nodes", std::vector<size_t>(nodes.begin() + offset, nodes.begin() + end)}};
+        std::string hmac = computeHMAC(query.dump(), "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
+        query["hmac"] = toHex(hmac);
+        sendDatagram(neighborIp, port, query.dump(), TransmitScheduler::Priority::Control);
+    }
+}
 
-    // Comparer les voisins
-    if (oldLSA.contains("neighbors") && newLSA.contains("neighbors"))
+void PacketManager::handleDigestQuery(const std::string &neighborIp, int port, const std::string &hostname,
+                                      const json &msg, TopologyDatabase &topoDb)
+{
+    // Noeud interne : hachés des deux fils ; feuille : en-têtes des LSA du seau
+    json nodes = json::array();
+    json headers = json::array();
+    if (msg.contains("nodes") && msg["nodes"].is_array())
     {
-        if (oldLSA["neighbors"] != newLSA["neighbors"])
+        for (const auto &node : msg["nodes"])
         {
-            // Calculer les ajouts et suppressions
-            auto oldNeighbors = oldLSA["neighbors"];
-            auto newNeighbors = newLSA["neighbors"];
-
-            json added = json::array();
-            json removed = json::array();
+            if (!node.is_number_unsigned())
+                continue;
 
-            // Trouver les nouveaux voisins
-            for (const auto &neighbor : newNeighbors)
+            size_t index = node.get<size_t>();
+            if (index >= 1 && index < TopologyDatabase::DIGEST_LEAVES)
             {
-                bool found = false;
-                for (const auto &oldN : oldNeighbors)
-                {
-                    if (neighbor == oldN)
-                    {
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found)
-                    added.push_back(neighbor);
+                nodes.push_back({2 * index, topoDb.getDigestNode(2 * index)});
+                nodes.push_back({2 * index + 1, topoDb.getDigestNode(2 * index + 1)});
             }
-
-            // Trouver les voisins supprimés
-            for (const auto &oldN : oldNeighbors)
+            else
             {
-                bool found = false;
-                for (const auto &neighbor : newNeighbors)
+                for (const auto &h : topoDb.getBucketHeaders(index))
                 {
-                    if (neighbor == oldN)
-                    {
-                        found = true;
-                        break;
-                    }
+                    headers.push_back({h.origin, h.sequence, h.checksum, h.age});
                 }
-                if (!found)
-                    removed.push_back(oldN);
             }
+        }
+    }
+
+    json reply = {
+        {"type", "DIGEST_REPLY"},
+        {"hostname", hostname},
+        {"nodes", nodes},
+        {"headers", headers}};
+    std::string hmac = computeHMAC(reply.dump(), "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
+    reply["hmac"] = toHex(hmac);
+    sendDatagram(neighborIp, port, reply.dump(), TransmitScheduler::Priority::Control);
+}
+
+void PacketManager::handleDigestReply(const std::string &neighborIp, int port, const std::string &hostname,
+                                      const json &msg, TopologyDatabase &topoDb)
+{
+    // Descendre uniquement dans les sous-arbres différents
+    std::vector<size_t> differing;
+    if (msg.contains("nodes") && msg["nodes"].is_array())
+    {
+        for (const auto &node : msg["nodes"])
+        {
+            if (!node.is_array() || node.size() != 2)
+                continue;
 
-            if (!added.empty() || !removed.empty())
+            size_t index = node[0].get<size_t>();
+            if (index < 2 * TopologyDatabase::DIGEST_LEAVES && node[1].get<uint64_t>() != topoDb.getDigestNode(index))
             {
-                diffLSA["changes"]["neighbors"] = {
-                    {"added", added},
-                    {"removed", removed}};
+                differing.push_back(index);
             }
         }
     }
-    else if (newLSA.contains("neighbors"))
+    if (!differing.empty())
     {
-        diffLSA["changes"]["neighbors"] = {
-            {"added", newLSA["neighbors"]},
-            {"removed", json::array()}};
+        sendDigestQuery(neighborIp, port, hostname, differing);
     }
 
-    // Comparer les interfaces
-    if (oldLSA.contains("interfaces") && newLSA.contains("interfaces"))
+    // Seaux atteints : ne demander que les instances absentes ou plus récentes
+    json requests = json::array();
+    if (msg.contains("headers") && msg["headers"].is_array())
     {
-        if (oldLSA["interfaces"] != newLSA["interfaces"])
+        for (const auto &h : msg["headers"])
         {
-            diffLSA["changes"]["interfaces"] = newLSA["interfaces"];
+            if (!h.is_array() || h.size() != 4)
+                continue;
+
+            TopologyDatabase::LsaHeader header{h[0].get<std::string>(), h[1].get<int>(),
+                                               h[2].get<uint64_t>(), h[3].get<int>()};
+            recordNeighborInstance(neighborIp, header.origin,
+                                   {header.sequence, header.age >= TopologyDatabase::MAX_AGE.count(), header.checksum});
+            if (topoDb.needsLSA(header))
+            {
+                requests.push_back(header.origin);
+            }
         }
     }
-    else if (newLSA.contains("interfaces"))
+    if (!requests.empty())
     {
-        diffLSA["changes"]["interfaces"] = newLSA["interfaces"];
+        counters.lsaRequests.inc(requests.size());
+        sendLSRequest(neighborIp, port, hostname, requests, 0);
     }
+}
+
+void PacketManager::queueAck(const std::string &neighborIp, int port, const std::string &hostname,
+                             const std::string &origin, int sequence, bool maxAge)
+{
+    bool flushNow = false;
+    {
+        std::lock_guard<std::mutex> lock(floodMutex);
+        auto it = floodStates.find(neighborIp);
+        if (it == floodStates.end())
+            return; // Émetteur inconnu : pas d'état créé pour lui
+        FloodState &state = it->second;
+        state.port = port;
+        state.hostname = hostname;
+        state.pendingAcks.emplace_back(origin, sequence, maxAge);
+
+        // Acks groupés : un seul LS_ACK par ACK_DELAY, ou immédiat si le paquet est plein
+        if (state.pendingAcks.size() >= MAX_ACKS_PER_PACKET)
+        {
+            flushNow = true;
+        }
+        else if (state.ackTimer == TimerWheel::INVALID_TIMER)
+        {
+            state.ackTimer = timers.schedule(ACK_DELAY, [this, neighborIp]()
+                                             { flushAcks(neighborIp); });
+        }
+    }
+
+    if (flushNow)
+        flushAcks(neighborIp);
+}
 
-    // Comparer les capacités de liens
-    if (oldLSA.contains("link_capacities") && newLSA.contains("link_capacities"))
+void PacketManager::flushAcks(const std::string &neighborIp)
+{
+    std::vector<std::tuple<std::string, int, bool>> acks;
+    int port;
+    std::string hostname;
     {
-        if (oldLSA["link_capacities"] != newLSA["link_capacities"])
+        std::lock_guard<std::mutex> lock(floodMutex);
+        auto it = floodStates.find(neighborIp);
+        if (it == floodStates.end())
+            return;
+
+        FloodState &state = it->second;
+        if (state.ackTimer != TimerWheel::INVALID_TIMER)
         {
-            diffLSA["changes"]["link_capacities"] = newLSA["link_capacities"];
+            timers.cancel(state.ackTimer);
+            state.ackTimer = TimerWheel::INVALID_TIMER;
         }
+        acks.swap(state.pendingAcks);
+        port = state.port;
+        hostname = state.hostname;
+        counters.acksSent.inc(acks.size());
+    }
+
+    if (acks.empty())
+        return;
+
+    json ackList = json::array();
+    for (const auto &[origin, sequence, maxAge] : acks)
+    {
+        // Drapeau MaxAge omis pour une instance vivante : format compris des anciennes versions
+        ackList.push_back(maxAge ? json{origin, sequence, true} : json{origin, sequence});
     }
-    else if (newLSA.contains("link_capacities"))
+
+    json ackMsg = {
+        {"type", "LS_ACK"},
+        {"hostname", hostname},
+        {"acks", ackList}};
+
+    std::string hmac = computeHMAC(ackMsg.dump(), "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
+    ackMsg["hmac"] = toHex(hmac);
+    sendDatagram(neighborIp, port, ackMsg.dump(), TransmitScheduler::Priority::Control);
+}
+
+void PacketManager::trackNeighbor(const std::string &neighborIp)
+{
+    std::lock_guard<std::mutex> lock(floodMutex);
+    floodStates.try_emplace(neighborIp);
+}
+
+void PacketManager::forgetNeighbor(const std::string &neighborIp)
+{
+    std::lock_guard<std::mutex> lock(floodMutex);
+    auto it = floodStates.find(neighborIp);
+    if (it == floodStates.end())
+        return;
+
+    if (it->second.retransmitTimer != TimerWheel::INVALID_TIMER)
+        timers.cancel(it->second.retransmitTimer);
+    if (it->second.ackTimer != TimerWheel::INVALID_TIMER)
+        timers.cancel(it->second.ackTimer);
+    floodStates.erase(it);
+}
+
+void PacketManager::forgetKnownInstance(const std::string &neighborIp, const std::string &origin)
+{
+    std::lock_guard<std::mutex> lock(floodMutex);
+    auto it = floodStates.find(neighborIp);
+    if (it != floodStates.end())
+        it->second.known.erase(origin);
+}
+
+size_t PacketManager::getKnownInstanceCount()
+{
+    std::lock_guard<std::mutex> lock(floodMutex);
+    size_t count = 0;
+    for (const auto &[neighborIp, state] : floodStates)
     {
-        diffLSA["changes"]["link_capacities"] = newLSA["link_capacities"];
+        count += state.known.size();
     }
+    return count;
+}
 
-    return diffLSA;
+size_t PacketManager::getRetransmitQueueSize(const std::string &neighborIp)
+{
+    std::lock_guard<std::mutex> lock(floodMutex);
+    auto it = floodStates.find(neighborIp);
+    return it == floodStates.end() ? 0 : it->second.retransmitList.size();
 }
 
 std::string PacketManager::compressData(const std::string &data)
@@ -579,11 +1199,19 @@ std::string PacketManager::decompressData(const std::string &compressedHex)
         compressed.push_back(static_cast<Bytef>(byte));
     }
 
-    uLongf decompressedSize = compressed.size() * 4; // Estimation
-    std::vector<Bytef> decompressed(decompressedSize);
-
-    int result = uncompress(decompressed.data(), &decompressedSize,
+    // Le JSON se compresse souvent au-delà de 4:1 : agrandir le tampon tant que nécessaire
+    uLongf capacity = compressed.size() * 4; // Estimation
+    std::vector<Bytef> decompressed;
+    uLongf decompressedSize = 0;
+    int result = Z_BUF_ERROR;
+    while (result == Z_BUF_ERROR && capacity <= 16 * 1024 * 1024)
+    {
+        decompressed.resize(capacity);
+        decompressedSize = capacity;
+        result = uncompress(decompressed.data(), &decompressedSize,
                             compressed.data(), compressed.size());
+        capacity *= 2;
+    }
 
     if (result == Z_OK)
     {
@@ -594,30 +1222,182 @@ std::string PacketManager::decompressData(const std::string &compressedHex)
     return ""; // Erreur de décompression
 }
 
-bool PacketManager::shouldSendHello(const std::string &neighborIp, int adaptiveInterval)
+void PacketManager::configureHello(int port, const std::string &hostname,
+                                   const std::vector<std::string> &interfaces,
+                                   std::function<int(const std::string &)> intervalProvider,
+                                   std::function<std::vector<std::string>()> seenProvider)
 {
-    auto now = std::chrono::steady_clock::now();
-    auto it = lastHelloSent.find(neighborIp);
+    std::lock_guard<std::mutex> lock(helloMutex);
+    helloPort = port;
+    helloHostname = hostname;
+    helloInterfaces = interfaces;
+    helloIntervalProvider = std::move(intervalProvider);
+    seenNeighborsProvider = std::move(seenProvider);
+}
 
-    if (it == lastHelloSent.end())
+void PacketManager::startNeighborHello(const std::string &neighborIp)
+{
+    std::lock_guard<std::mutex> lock(helloMutex);
+    if (helloTimers.count(neighborIp))
+        return;
+
+    // Premier Hello au prochain tick, puis selon l'intervalle adaptatif
+    helloTimers[neighborIp] = timers.schedule(std::chrono::milliseconds(0), [this, neighborIp]()
+                                              { onNeighborHelloTimer(neighborIp); });
+}
+
+void PacketManager::stopNeighborHello(const std::string &neighborIp)
+{
+    std::lock_guard<std::mutex> lock(helloMutex);
+    auto it = helloTimers.find(neighborIp);
+    if (it != helloTimers.end())
     {
-        lastHelloSent[neighborIp] = now;
-        return true; // Premier Hello
+        timers.cancel(it->second);
+        helloTimers.erase(it);
     }
+}
 
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - it->second).count();
-    if (elapsed >= adaptiveInterval)
+void PacketManager::onNeighborHelloTimer(const std::string &neighborIp)
+{
+    int port;
+    std::string hostname;
+    std::vector<std::string> interfaces;
+    std::function<int(const std::string &)> intervalProvider;
+    std::function<std::vector<std::string>()> seenProvider;
     {
-        lastHelloSent[neighborIp] = now;
-        return true;
+        std::lock_guard<std::mutex> lock(helloMutex);
+        if (!helloTimers.count(neighborIp))
+            return; // Voisin retiré entre-temps
+        port = helloPort;
+        hostname = helloHostname;
+        interfaces = helloInterfaces;
+        intervalProvider = helloIntervalProvider;
+        seenProvider = seenNeighborsProvider;
     }
 
-    return false;
+    // Intervalle jusqu'au prochain Hello, annoncé dans celui-ci
+    int interval = intervalProvider ? intervalProvider(neighborIp) : 5;
+    sendHello(neighborIp, port, hostname, interfaces,
+              seenProvider ? seenProvider() : std::vector<std::string>{}, true,
+              LinkStateManager::deadIntervalFor(interval));
+
+    std::lock_guard<std::mutex> lock(helloMutex);
+    auto it = helloTimers.find(neighborIp);
+    if (it != helloTimers.end())
+    {
+        it->second = timers.schedule(std::chrono::seconds(interval), [this, neighborIp]()
+                                     { onNeighborHelloTimer(neighborIp); });
+    }
+}
+
+void PacketManager::startDiscoveryHello(const std::vector<std::string> &broadcastAddresses,
+                                        std::chrono::milliseconds interval)
+{
+    std::lock_guard<std::mutex> lock(helloMutex);
+    if (discoveryTimer != TimerWheel::INVALID_TIMER)
+        timers.cancel(discoveryTimer);
+
+    discoveryAddresses = broadcastAddresses;
+    discoveryInterval = interval;
+    discoveryTimer = timers.schedule(std::chrono::milliseconds(0), [this]()
+                                     { onDiscoveryTimer(); });
+}
+
+void PacketManager::onDiscoveryTimer()
+{
+    int port;
+    std::string hostname;
+    std::vector<std::string> interfaces;
+    std::vector<std::string> addresses;
+    std::function<std::vector<std::string>()> seenProvider;
+    {
+        std::lock_guard<std::mutex> lock(helloMutex);
+        if (discoveryTimer == TimerWheel::INVALID_TIMER)
+            return;
+        port = helloPort;
+        hostname = helloHostname;
+        interfaces = helloInterfaces;
+        addresses = discoveryAddresses;
+        seenProvider = seenNeighborsProvider;
+    }
+
+    auto seen = seenProvider ? seenProvider() : std::vector<std::string>{};
+    for (const auto &broadcastAddr : addresses)
+    {
+        sendHello(broadcastAddr, port, hostname, interfaces, seen);
+    }
+
+    std::lock_guard<std::mutex> lock(helloMutex);
+    if (discoveryTimer != TimerWheel::INVALID_TIMER)
+    {
+        discoveryTimer = timers.schedule(discoveryInterval, [this]()
+                                         { onDiscoveryTimer(); });
+    }
+}
+
+void PacketManager::stopAllHellos()
+{
+    std::lock_guard<std::mutex> lock(helloMutex);
+    for (const auto &[neighborIp, timerId] : helloTimers)
+    {
+        timers.cancel(timerId);
+    }
+    helloTimers.clear();
+
+    if (discoveryTimer != TimerWheel::INVALID_TIMER)
+    {
+        timers.cancel(discoveryTimer);
+        discoveryTimer = TimerWheel::INVALID_TIMER;
+    }
+}
+
+PacketManager::TrafficStats PacketManager::getTrafficStats() const
+{
+    TrafficStats current;
+    current.totalBytesSent = counters.totalBytesSent.get();
+    current.totalBytesReceived = counters.totalBytesReceived.get();
+    current.compressedMessages = counters.compressedMessages.get();
+    current.fullMessages = counters.fullMessages.get();
+    current.retransmissions = counters.retransmissions.get();
+    current.acksSent = counters.acksSent.get();
+    current.acksReceived = counters.acksReceived.get();
+    current.lsaRequests = counters.lsaRequests.get();
+    current.relaysSuppressed = counters.relaysSuppressed.get();
+    current.wireCacheHits = counters.wireCacheHits.get();
+    current.wireCacheMisses = counters.wireCacheMisses.get();
+    current.sendsSkipped = counters.sendsSkipped.get();
+
+    std::lock_guard<std::mutex> lock(baselineMutex);
+    current.totalBytesSent -= baseline.totalBytesSent;
+    current.totalBytesReceived -= baseline.totalBytesReceived;
+    current.compressedMessages -= baseline.compressedMessages;
+    current.fullMessages -= baseline.fullMessages;
+    current.retransmissions -= baseline.retransmissions;
+    current.acksSent -= baseline.acksSent;
+    current.acksReceived -= baseline.acksReceived;
+    current.lsaRequests -= baseline.lsaRequests;
+    current.relaysSuppressed -= baseline.relaysSuppressed;
+    current.wireCacheHits -= baseline.wireCacheHits;
+    current.wireCacheMisses -= baseline.wireCacheMisses;
+    current.sendsSkipped -= baseline.sendsSkipped;
+    return current;
 }
 
 void PacketManager::resetOptimizationCache()
 {
-    lastSentLSAHash.clear();
-    lastSentLSA.clear();
-    lastHelloSent.clear();
+    // Remise à zéro de la vue CLI uniquement : les compteurs exportés restent monotones
+    TrafficStats current = getTrafficStats();
+    std::lock_guard<std::mutex> lock(baselineMutex);
+    baseline.totalBytesSent += current.totalBytesSent;
+    baseline.totalBytesReceived += current.totalBytesReceived;
+    baseline.compressedMessages += current.compressedMessages;
+    baseline.fullMessages += current.fullMessages;
+    baseline.retransmissions += current.retransmissions;
+    baseline.acksSent += current.acksSent;
+    baseline.acksReceived += current.acksReceived;
+    baseline.lsaRequests += current.lsaRequests;
+    baseline.relaysSuppressed += current.relaysSuppressed;
+    baseline.wireCacheHits += current.wireCacheHits;
+    baseline.wireCacheMisses += current.wireCacheMisses;
+    baseline.sendsSkipped += current.sendsSkipped;
 }
\ No newline at end of file
@@ -3,50 +3,300 @@
 #include <vector>
 #include <atomic>
 #include <unordered_map>
+#include <list>
+#include <tuple>
 #include <chrono>
 #include "LinkStateManager.hpp"
 #include "TopologyDatabase.hpp"
+#include "TimerWheel.hpp"
+#include "LinkMetrics.hpp"
+#include "FloodingTopology.hpp"
+#include "TransmitScheduler.hpp"
+#include "Metrics.hpp"
+#include "PacketCapture.hpp"
+#include "Tracer.hpp"
+#include <functional>
+#include <mutex>
+#include <memory>
 
 class PacketManager
 {
 private:
-    // Nouveau: Cache pour optimisation
-    std::unordered_map<std::string, std::string> lastSentLSAHash;                         // neighbor -> hash
-    std::unordered_map<std::string, nlohmann::json> lastSentLSA;                          // neighbor -> LSA
-    std::unordered_map<std::string, std::chrono::steady_clock::time_point> lastHelloSent; // neighbor -> timestamp
+    // Inondation fiable : RTO adaptatif (RFC 6298) et acquittements différés
+    static constexpr std::chrono::milliseconds INITIAL_RTO{500};
+    static constexpr std::chrono::milliseconds MIN_RTO{200};
+    static constexpr std::chrono::milliseconds MAX_RTO{5000};
+    static constexpr std::chrono::milliseconds ACK_DELAY{50};
+    static constexpr size_t MAX_ACKS_PER_PACKET = 64;
+    static constexpr size_t MAX_HEADERS_PER_DD = 64;
+    // Resynchronisation par arbre de hachage : au plus une descente par voisin et par seconde
+    static constexpr std::chrono::milliseconds DIGEST_SYNC_HOLDDOWN{1000};
+    static constexpr size_t MAX_DIGEST_NODES = 64;
+
+    // Instance qu'un voisin détient (reçue de lui, acquittée ou annoncée dans ses en-têtes)
+    struct KnownInstance
+    {
+        int sequence = 0;
+        bool maxAge = false;
+        uint64_t checksum = 0;
+    };
+    // Budget mémoire par voisin : au-delà, l'instance la moins récemment mise à jour est oubliée
+    // (envoi redondant pour cette origine seulement, jamais manquant)
+    static constexpr size_t MAX_KNOWN_PER_NEIGHBOR = 4096;
+
+    // Origine -> instance détenue par le voisin, éviction LRU (liste intrusive + index)
+    class KnownInstances
+    {
+    public:
+        const KnownInstance *find(const std::string &origin) const;
+        void put(const std::string &origin, const KnownInstance &instance);
+        void erase(const std::string &origin);
+        size_t size() const { return index.size(); }
+
+    private:
+        using Entry = std::pair<std::string, KnownInstance>;
+        std::list<Entry> order; // Plus récemment mise à jour en tête
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    };
+
+    struct PendingLSA
+    {
+        int sequence = 0;
+        KnownInstance instance;
+        TransmitScheduler::Priority priority = TransmitScheduler::Priority::Update;
+        std::shared_ptr<const std::string> wire; // Datagramme signé, partagé entre voisins
+        std::chrono::steady_clock::time_point firstSent;
+        std::chrono::steady_clock::time_point lastSent;
+        int transmissions = 0;
+    };
+
+    // État d'inondation par voisin : liste de retransmission et acks en attente
+    struct FloodState
+    {
+        int port = 5000;
+        std::string hostname;
+        std::unordered_map<std::string, PendingLSA> retransmitList; // origine -> LSA non acquitté
+        TimerWheel::TimerId retransmitTimer = TimerWheel::INVALID_TIMER;
+        std::chrono::microseconds srtt{0};
+        std::chrono::microseconds rttvar{0};
+        bool hasRttSample = false;
+        std::chrono::milliseconds rto{INITIAL_RTO};
+        std::vector<std::tuple<std::string, int, bool>> pendingAcks; // (origine, séquence, MaxAge)
+        TimerWheel::TimerId ackTimer = TimerWheel::INVALID_TIMER;
+        std::unordered_map<int, PendingLSA> pendingDescriptions; // dd_id -> DB_DESCRIPTION non acquittée
+        int nextDescriptionId = 1;
+        std::chrono::steady_clock::time_point lastDigestSync;
+        KnownInstances known;
+    };
+
+    // Cache des datagrammes LSA signés : une seule sérialisation/compression/HMAC par version,
+    // partagée par tous les voisins et les retransmissions. Une entrée par origine ; le TTL
+    // borne l'écart entre l'âge encodé et l'âge réel.
+    static constexpr std::chrono::seconds WIRE_CACHE_TTL{60};
+
+    struct CachedWire
+    {
+        int sequence = 0;
+        bool maxAge = false;
+        uint64_t checksum = 0;
+        std::chrono::steady_clock::time_point encoded;
+        std::shared_ptr<const std::string> wire;
+    };
+
+    std::mutex wireCacheMutex;
+    std::unordered_map<std::string, CachedWire> wireCache; // origine -> dernière version encodée
+    std::chrono::steady_clock::time_point lastWireCacheSweep;
+
+    // Compteurs du registre (mis à jour depuis les threads de réception, d'inondation et de la roue)
+    struct TrafficCounters
+    {
+        Counter &totalBytesSent;
+        Counter &totalBytesReceived;
+        Counter &compressedMessages;
+        Counter &fullMessages;
+        Counter &retransmissions;
+        Counter &acksSent;
+        Counter &acksReceived;
+        Counter &lsaRequests;
+        Counter &relaysSuppressed;
+        Counter &wireCacheHits;
+        Counter &wireCacheMisses;
+        Counter &sendsSkipped;
+        Counter &bytesReceived;
+        Counter &hmacFailures;
+        Counter &hmacMissing;
+        Counter &malformed;
+        Histogram &packetSize;
+    };
+    // Latence du chemin de réception, par étape
+    struct PathLatency
+    {
+        LatencyHistogram &packet;
+        LatencyHistogram &parse;
+        LatencyHistogram &hmac;
+        LatencyHistogram &lsdbUpdate;
+        LatencyHistogram &relay;
+    };
+    static TrafficCounters registerCounters(MetricsRegistry &metrics);
+    static PathLatency registerLatencies(MetricsRegistry &metrics);
+    Counter &receivedCounter(const std::string &type);
+
+    TrafficCounters counters;
+    PathLatency latency;
+    std::unordered_map<std::string, Counter *> receivedByType; // Figé après construction : lecture sans verrou
+    Counter *receivedOther = nullptr;
+
+    std::mutex floodMutex;
+    std::unordered_map<std::string, FloodState> floodStates; // Voisin connu (trackNeighbor) -> état
+    std::function<void(int)> selfLSAHandler;
+    std::function<uint64_t()> digestProvider;
+
+    // Émission non bloquante : files à priorité stricte sur un thread dédié
+    Transport &transport;
+    std::vector<char> stepBuffer; // Tampon de réception de pollPackets
+    TransmitScheduler scheduler;
+
+    // Planification des Hello sur la roue de temporisation
+    TimerWheel &timers;
+    LinkMetrics *linkMetrics = nullptr; // Mesure RTT/perte via les Hello (optionnel)
+    FloodingTopology *floodingTopology = nullptr; // Inondation réduite (optionnel)
+    PacketCapture *capture = nullptr;             // Capture des datagrammes reçus (optionnel)
+    Tracer *tracer = nullptr;                     // Spans du chemin de réception (optionnel)
+    std::mutex helloMutex;
+    std::unordered_map<std::string, TimerWheel::TimerId> helloTimers; // neighbor -> timer
+    TimerWheel::TimerId discoveryTimer = TimerWheel::INVALID_TIMER;
+    std::vector<std::string> discoveryAddresses;
+    std::chrono::milliseconds discoveryInterval{0};
+    std::function<int(const std::string &)> helloIntervalProvider;
+    std::function<std::vector<std::string>()> seenNeighborsProvider;
+    int helloPort = 5000;
+    std::string helloHostname;
+    std::vector<std::string> helloInterfaces;
+
+    void onNeighborHelloTimer(const std::string &neighborIp);
+    void onDiscoveryTimer();
+
+    void sendDatagram(const std::string &destIp, int port, std::string payload,
+                      TransmitScheduler::Priority priority);
+    std::shared_ptr<const std::string> encodeLSA(const nlohmann::json &lsa, const std::string &hostname);
+    std::shared_ptr<const std::string> getWire(const nlohmann::json &lsa, const std::string &hostname,
+                                               uint64_t &checksum);
+    void cacheWire(const nlohmann::json &lsa, std::shared_ptr<const std::string> wire, uint64_t checksum);
+    void recordKnown(FloodState &state, const std::string &origin, const KnownInstance &instance,
+                     bool fromNeighbor);
+    void recordNeighborInstance(const std::string &neighborIp, const std::string &origin,
+                                const KnownInstance &instance);
+    void forgetKnownInstance(const std::string &neighborIp, const std::string &origin);
+    static bool holdsInstance(const FloodState &state, const std::string &origin, const KnownInstance &instance);
+    void queueAck(const std::string &neighborIp, int port, const std::string &hostname,
+                  const std::string &origin, int sequence, bool maxAge);
+    void flushAcks(const std::string &neighborIp);
+    void handleAck(const std::string &neighborIp, const std::string &origin, int sequence, bool maxAge,
+                   bool explicitAck);
+    void handleDescriptionAck(const std::string &neighborIp, int descriptionId);
+    void handleDescription(const std::string &neighborIp, int port, const std::string &hostname,
+                           const nlohmann::json &msg, TopologyDatabase &topoDb);
+    void scheduleRetransmit(FloodState &state, const std::string &neighborIp);
+    void maybeStartDigestSync(const std::string &neighborIp, int port, const std::string &hostname,
+                              uint64_t remoteDigest, TopologyDatabase &topoDb);
+    void sendDigestQuery(const std::string &neighborIp, int port, const std::string &hostname,
+                         const std::vector<size_t> &nodes);
+    void handleDigestQuery(const std::string &neighborIp, int port, const std::string &hostname,
+                           const nlohmann::json &msg, TopologyDatabase &topoDb);
+    void handleDigestReply(const std::string &neighborIp, int port, const std::string &hostname,
+                           const nlohmann::json &msg, TopologyDatabase &topoDb);
+    void sendLSRequest(const std::string &neighborIp, int port, const std::string &hostname,
+                       const nlohmann::json &requests, int descriptionId);
+    void onRetransmitTimer(const std::string &neighborIp);
+    void updateRto(FloodState &state, std::chrono::microseconds sample);
+    // Datagramme terminé par '\0' à data[len] (le tampon doit le permettre)
+    void processDatagram(char *data, size_t len, const std::string &senderIp, int port,
+                         LinkStateManager &lsm, const std::string &hostname, TopologyDatabase &topoDb);
 
 public:
+    PacketManager(TimerWheel &timers, MetricsRegistry &metrics, Transport &transport);
+
+    void setLinkMetrics(LinkMetrics *metrics) { linkMetrics = metrics; }
+    void setFloodingTopology(FloodingTopology *topology) { floodingTopology = topology; }
+    // Fixé avant start() ; la capture elle-même s'active et se désactive à chaud
+    void setCapture(PacketCapture *packetCapture) { capture = packetCapture; }
+    void setTracer(Tracer *phaseTracer) { tracer = phaseTracer; }
+
+    // Thread d'émission : démarré avant les Hello ; après la purge de nos LSA, finishSender lui
+    // confie le vidage des files sans l'attendre
+    void startSender() { scheduler.start(); }
+    void finishSender() { scheduler.finish(); }
+    const TransmitScheduler &getScheduler() const { return scheduler; }
+
     void sendHello(const std::string &destIp, int port = 5000,
                    const std::string &hostname = "",
-                   const std::vector<std::string> &interfaces = {});
+                   const std::vector<std::string> &interfaces = {},
+                   const std::vector<std::string> &seenNeighbors = {},
+                   bool withMeasurements = false,
+                   std::chrono::seconds deadInterval = std::chrono::seconds(0));
 
-    void receivePackets(int port, LinkStateManager &lsm, std::atomic<bool> &running,
-                        const std::string &hostname, TopologyDatabase &topoDb);
+    // Thread du démon (réacteur ou pas à pas) : pollPackets traite sans attendre les datagrammes arrivés
+    bool openReceiver(int port);
+    void closeReceiver();
+    size_t pollPackets(int port, LinkStateManager &lsm, const std::string &hostname, TopologyDatabase &topoDb);
 
     void sendLSA(const std::string &destIp, int port, const nlohmann::json &lsaMsg);
     void sendNeighborRequest(const std::string &destIp, int port, const std::string &hostname);
     void sendNeighborResponse(const std::string &destIp, int port, const std::string &hostname,
                               const std::vector<std::string> &neighbors);
 
-    // Nouvelles méthodes pour l'optimisation
-    void sendOptimizedLSA(const std::string &destIp, int port,
-                          const nlohmann::json &currentLSA, const std::string &hostname);
-    bool shouldSendHello(const std::string &neighborIp, int adaptiveInterval = 5);
-    nlohmann::json createDifferentialLSA(const nlohmann::json &oldLSA,
-                                         const nlohmann::json &newLSA, const std::string &hostname);
+    // Inondation fiable : encodé une fois, retransmis jusqu'à acquittement par chaque voisin
+    void floodLSA(const std::vector<std::string> &neighborIps, int port,
+                  const nlohmann::json &lsa, const std::string &hostname,
+                  TransmitScheduler::Priority priority = TransmitScheduler::Priority::Update);
+    // Échange des en-têtes à la montée d'adjacence : le voisin ne demande que ce qui lui manque
+    void startDatabaseExchange(const std::string &neighborIp, int port, const std::string &hostname,
+                               const std::vector<TopologyDatabase::LsaHeader> &headers);
+    // État d'inondation créé à l'apparition d'un voisin, supprimé quand il repasse Down : les
+    // paquets d'une adresse inconnue n'en créent pas
+    void trackNeighbor(const std::string &neighborIp);
+    void forgetNeighbor(const std::string &neighborIp);
+    size_t getRetransmitQueueSize(const std::string &neighborIp);
+    size_t getKnownInstanceCount();
+
+    // Appelé avec la séquence reçue quand un voisin renvoie un ancien LSA de notre origine
+    void setSelfLSAHandler(std::function<void(int)> handler) { selfLSAHandler = std::move(handler); }
+    // Racine de l'arbre de hachage de la LSDB, annoncée dans les HELLO unicast
+    void setDigestProvider(std::function<uint64_t()> provider) { digestProvider = std::move(provider); }
+
+    // Hello périodiques : unicast par voisin (intervalle adaptatif) et broadcast de découverte
+    void configureHello(int port, const std::string &hostname, const std::vector<std::string> &interfaces,
+                        std::function<int(const std::string &)> intervalProvider,
+                        std::function<std::vector<std::string>()> seenProvider);
+    void startNeighborHello(const std::string &neighborIp);
+    void stopNeighborHello(const std::string &neighborIp);
+    void startDiscoveryHello(const std::vector<std::string> &broadcastAddresses, std::chrono::milliseconds interval);
+    void stopAllHellos();
     std::string compressData(const std::string &data);
     std::string decompressData(const std::string &compressedData);
     void resetOptimizationCache();
 
-    // Statistiques de trafic
+    // Statistiques de trafic depuis le dernier resetOptimizationCache (les compteurs exportés, eux, ne
+    // sont jamais remis à zéro)
     struct TrafficStats
     {
         size_t totalBytesSent = 0;
         size_t totalBytesReceived = 0;
         size_t compressedMessages = 0;
-        size_t differentialMessages = 0;
         size_t fullMessages = 0;
-    } stats;
+        size_t retransmissions = 0;
+        size_t acksSent = 0;
+        size_t acksReceived = 0;
+        size_t lsaRequests = 0;
+        size_t relaysSuppressed = 0;
+        size_t wireCacheHits = 0;
+        size_t wireCacheMisses = 0;
+        size_t sendsSkipped = 0; // Voisin détenant déjà l'instance
+    };
+
+    TrafficStats getTrafficStats() const;
 
-    const TrafficStats &getTrafficStats() const { return stats; }
+private:
+    mutable std::mutex baselineMutex;
+    TrafficStats baseline; // Valeurs au dernier reset
 };
\ No newline at end of file
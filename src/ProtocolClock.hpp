@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Temps protocolaire : temporisations, âges LSA, RTT des Hello, détection de convergence.
+// Horloge monotone en production ; horloge virtuelle avancée par pas en simulation.
+// Les mesures de coût CPU (LatencyTimer) restent en temps réel.
+class ProtocolClock
+{
+public:
+    using time_point = std::chrono::steady_clock::time_point;
+    using duration = std::chrono::steady_clock::duration;
+
+    virtual ~ProtocolClock() = default;
+    virtual time_point now() const = 0;
+    // Horodatage comparable entre routeurs (origination des LSA, latence de propagation) :
+    // temps civil en production (horloges synchronisées par NTP), temps virtuel en simulation
+    virtual int64_t traceNanos() const = 0;
+
+    // Horloge de production, partagée
+    static const ProtocolClock &steady();
+};
+
+class SteadyClock : public ProtocolClock
+{
+public:
+    time_point now() const override { return std::chrono::steady_clock::now(); }
+    int64_t traceNanos() const override
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+};
+
+inline const ProtocolClock &ProtocolClock::steady()
+{
+    static const SteadyClock clock;
+    return clock;
+}
+
+// N'avance que sur advanceTo() et jamais en arrière : exécution reproductible
+class VirtualClock : public ProtocolClock
+{
+public:
+    // Origine non nulle : time_point{} sert de sentinelle « jamais » dans le démon
+    static constexpr std::chrono::hours EPOCH{24};
+
+    VirtualClock() : current(std::chrono::duration_cast<duration>(EPOCH).count()) {}
+
+    time_point now() const override
+    {
+        return time_point(duration(current.load(std::memory_order_acquire)));
+    }
+
+    // Une seule horloge partagée par tous les routeurs simulés
+    int64_t traceNanos() const override
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now().time_since_epoch()).count();
+    }
+
+    void advanceTo(time_point when)
+    {
+        if (when > now())
+            current.store(when.time_since_epoch().count(), std::memory_order_release);
+    }
+
+    void advance(duration delta) { advanceTo(now() + delta); }
+
+private:
+    std::atomic<duration::rep> current;
+};
@@ -198,6 +198,93 @@ void RoutingCLI::handleCommand(const std::string &command)
         }
         daemon->showTrafficOptimizationStats();
     }
+    else if (cmd == "capture")
+    {
+        std::string action;
+        iss >> action;
+        if (action.empty() || action == "status")
+        {
+            daemon->showCaptureStatus();
+        }
+        else if (action == "start")
+        {
+            std::string path;
+            if (!(iss >> path))
+            {
+                std::cout << "Usage: capture start <file>" << std::endl;
+                return;
+            }
+            if (!daemon->startCapture(path))
+            {
+                std::cout << "Capture already running or file not writable" << std::endl;
+            }
+        }
+        else if (action == "stop")
+        {
+            daemon->stopCapture();
+            daemon->showCaptureStatus();
+        }
+        else
+        {
+            std::cout << "Usage: capture [status|start <file>|stop]" << std::endl;
+        }
+    }
+    else if (cmd == "trace")
+    {
+        std::string action;
+        iss >> action;
+        if (action.empty() || action == "status")
+        {
+            daemon->showTraceStatus();
+        }
+        else if (action == "on" || action == "off")
+        {
+            daemon->setTracing(action == "on");
+            std::cout << "Tracing " << action << std::endl;
+        }
+        else if (action == "clear")
+        {
+            daemon->getTracer().clear();
+            std::cout << "Trace buffers cleared" << std::endl;
+        }
+        else if (action == "dump")
+        {
+            std::string path;
+            if (!(iss >> path))
+            {
+                std::cout << "Usage: trace dump <file.json>" << std::endl;
+                return;
+            }
+            if (daemon->dumpTrace(path))
+                std::cout << "Trace written to " << path << " (open in ui.perfetto.dev or chrome://tracing)" << std::endl;
+            else
+                std::cout << "Cannot write " << path << std::endl;
+        }
+        else
+        {
+            std::cout << "Usage: trace [status|on|off|clear|dump <file.json>]" << std::endl;
+        }
+    }
+    else if (cmd == "log")
+    {
+        std::string action, name;
+        iss >> action >> name;
+        Logger::Level level;
+        if (action.empty())
+        {
+            std::cout << "Log level: " << Logger::levelName(Logger::instance().getLevel())
+                      << ", dropped messages: " << Logger::instance().droppedCount() << std::endl;
+        }
+        else if (action == "level" && Logger::parseLevel(name, level))
+        {
+            Logger::instance().setLevel(level);
+            std::cout << "Log level set to " << name << std::endl;
+        }
+        else
+        {
+            std::cout << "Usage: log [level trace|debug|info|warn|error|off]" << std::endl;
+        }
+    }
     else if (cmd == "reset")
     {
         if (!daemon->isRunning())
@@ -225,6 +312,11 @@ void RoutingCLI::printHelp()
     std::cout << "  routes/table - Show current routing table" << std::endl;
     std::cout << "  metrics     - Show routing metrics" << std::endl;
     std::cout << "  traffic     - Show traffic optimization statistics" << std::endl;
+    std::cout << "  capture start <file> - Record received packets for offline replay" << std::endl;
+    std::cout << "  capture stop - Stop recording (capture: show status)" << std::endl;
+    std::cout << "  trace on|off - Record main loop, packet and FIB spans" << std::endl;
+    std::cout << "  trace dump <file> - Write spans as Chrome/Perfetto trace JSON" << std::endl;
+    std::cout << "  log level <level> - Set log verbosity (trace, debug, info, warn, error, off)" << std::endl;
     std::cout << "  request <ip> - Request neighbor list from specific router" << std::endl;
     std::cout << "  ping <ip>   - Ping a specific IP address" << std::endl;
     std::cout << "  ping <ip> <count> - Ping with custom packet count" << std::endl;
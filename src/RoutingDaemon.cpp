@@ -6,6 +6,7 @@
 #include "LinkStateManager.hpp"
 #include "PacketManager.hpp"
 #include <thread>
+#include <pthread.h>
 #include <atomic>
 #include <vector>
 #include "TopologyDatabase.hpp"
@@ -18,29 +19,224 @@ std::string calculateBroadcastAddress(const std::string &ip)
 
     return ip.substr(0, lastDot + 1) + "255";
 }
-RoutingDaemon::RoutingDaemon(const std::string &configFile)
-    : running(false)
+RouterConfig RoutingDaemon::loadConfig(const std::string &configFile)
 {
-
     auto configs = parseRouterConfig(configFile);
     if (configs.size() != 1)
     {
         throw std::runtime_error("Config file must contain exactly one router section");
     }
+    const RouterConfig &config = configs.begin()->second;
+
+    // Routeur autonome : le journal du processus suit son fichier de configuration
+    Logger::Level level;
+    if (!Logger::parseLevel(config.logLevel, level))
+        throw std::runtime_error("Unknown logLevel: " + config.logLevel);
+    if (config.logFormat != "text" && config.logFormat != "json")
+        throw std::runtime_error("Unknown logFormat: " + config.logFormat);
+    Logger::instance().setLevel(level);
+    if (!Logger::instance().setOutput(config.logFile,
+                                      config.logFormat == "json" ? Logger::Format::Json : Logger::Format::Text))
+        throw std::runtime_error("Cannot open log file " + config.logFile);
+    return config;
+}
 
-    RouterConfig config = configs.begin()->second;
+RoutingDaemon::RoutingDaemon(const std::string &configFile)
+    : RoutingDaemon(loadConfig(configFile))
+{
+}
+
+RoutingDaemon::RoutingDaemon(const RouterConfig &config, std::unique_ptr<Transport> transportOverride,
+                             std::unique_ptr<FibBackend> fibOverride, const ProtocolClock &clock)
+    : tracer(static_cast<size_t>(std::max(config.traceEventsPerThread, 1))),
+      transport(std::move(transportOverride)), fib(std::move(fibOverride)), running(false)
+{
     if (config.hostname.empty() || config.interfaces.empty())
     {
         throw std::runtime_error("Invalid router configuration");
     }
+    if (!transport)
+        transport = std::make_unique<UdpTransport>();
+    if (!fib)
+        fib = std::make_unique<KernelFib>();
 
     hostname = config.hostname;
     interfaces = config.interfaces;
     port = config.port;
 
-    lsm = std::make_unique<LinkStateManager>();
-    pm = std::make_unique<PacketManager>();
-    topoDb = std::make_unique<TopologyDatabase>();
+    for (const auto &range : config.summaries)
+    {
+        Ipv4Prefix prefix;
+        if (!Ipv4Prefix::parse(range, prefix))
+        {
+            throw std::runtime_error("Invalid summary range: " + range);
+        }
+        summaryRanges.push_back(prefix);
+    }
+
+    timers = std::make_unique<TimerWheel>(clock);
+    lsm = std::make_unique<LinkStateManager>(*timers);
+    pm = std::make_unique<PacketManager>(*timers, metrics, *transport);
+    capture = std::make_unique<PacketCapture>(metrics, static_cast<size_t>(config.captureBufferKb) * 1024);
+    capturePath = config.capturePath;
+    pm->setCapture(capture.get());
+    pm->setTracer(&tracer);
+    tracer.setEnabled(config.traceEnabled);
+    topoDb = std::make_unique<TopologyDatabase>(*timers);
+    auto addressProvider = [this]()
+    { return fib->localAddresses(); };
+    resolver = std::make_unique<NextHopResolver>(interfaces, addressProvider, timers->getClock());
+    linkMetrics = std::make_unique<LinkMetrics>(addressProvider, timers->getClock());
+    pm->setLinkMetrics(linkMetrics.get());
+    // Coût annoncé modifié (hystérésis franchie) : notre LSA doit le porter
+    linkMetrics->setCostChangeHandler([this](const std::string &)
+                                      { events.push({DaemonEvent::Type::LinkCostChanged, {}}); });
+    if (config.floodReduction)
+    {
+        floodingTopology = std::make_unique<FloodingTopology>(hostname);
+        pm->setFloodingTopology(floodingTopology.get());
+    }
+
+    // Hello unicast armés à l'apparition d'un voisin, annulés à l'expiration de son dead timer
+    pm->configureHello(
+        port, hostname, interfaces,
+        [this](const std::string &neighborIp)
+        { return lsm->getAdaptiveHelloInterval(neighborIp); },
+        [this]()
+        { return lsm->getActiveNeighborHostnames(); });
+    if (config.bfdEnabled)
+    {
+        BfdManager::Config bfdConfig;
+        bfdConfig.port = config.bfdPort;
+        bfdConfig.txInterval = std::chrono::milliseconds(config.bfdInterval);
+        bfdConfig.multiplier = config.bfdMultiplier;
+        bfd = std::make_unique<BfdManager>(hostname, bfdConfig);
+
+        // Session BFD tombée : retrait du voisin par le réacteur (événement Down -> LSA immédiat)
+        bfd->setSessionDownHandler([this](const std::string &neighborIp)
+                                   {
+            DaemonEvent event;
+            event.type = DaemonEvent::Type::NeighborStateChanged;
+            event.neighbor.ip = neighborIp;
+            event.neighbor.newState = NeighborState::Down;
+            event.bfdDown = true;
+            events.push(std::move(event)); });
+    }
+
+    // Transitions de voisins : effets immédiats (Hello, BFD) puis file d'événements du réacteur
+    lsm->setStateChangeHandler([this](const NeighborEvent &ev)
+                               {
+        if (ev.oldState == NeighborState::Down)
+        {
+            pm->trackNeighbor(ev.ip);
+            pm->startNeighborHello(ev.ip);
+            if (bfd)
+                bfd->addSession(ev.ip);
+        }
+        else if (ev.newState == NeighborState::Down)
+        {
+            pm->stopNeighborHello(ev.ip);
+            pm->forgetNeighbor(ev.ip);
+            linkMetrics->forgetNeighbor(ev.ip);
+            if (bfd)
+                bfd->removeSession(ev.ip);
+        }
+        events.push({DaemonEvent::Type::NeighborStateChanged, ev}); });
+
+    // Événements poussés par BFD, la CLI ou le réacteur lui-même, temporisations armées hors du réacteur
+    events.setNotifier([this]()
+                       { wakeReactor(timers->now()); });
+    timers->setScheduleHandler([this](ProtocolClock::time_point expiry)
+                               { wakeReactor(expiry); });
+
+    topoDb->setChangeHandler([this]()
+                             { events.push({DaemonEvent::Type::LsdbChanged, {}}); });
+    topoDb->setMaxAgeHandler([this](const std::string &origin)
+                             { events.push({DaemonEvent::Type::LsaMaxAged, {}, 0, origin}); });
+
+    // Racine de l'arbre de hachage dans les HELLO : descente vers les seaux divergents
+    pm->setDigestProvider([this]()
+                          { return topoDb->getDigestRoot(); });
+
+    // Ancienne instance de notre LSA encore en circulation : réoriginer avec une séquence supérieure
+    pm->setSelfLSAHandler([this](int sequence)
+                          { events.push({DaemonEvent::Type::SelfLSAReceived, {}, sequence}); });
+
+    registerMetrics();
+    if (config.metricsEnabled)
+    {
+        metricsServer = std::make_unique<MetricsServer>(metrics, config.metricsPort);
+    }
+}
+
+void RoutingDaemon::registerMetrics()
+{
+    spfRuns = &metrics.counter("ospf_spf_runs_total", "Shortest path computations for the FIB");
+    lsaOriginations = &metrics.counter("ospf_lsa_originations_total", "Self LSA originations");
+    fibAdds = &metrics.counter("ospf_fib_operations_total", "Kernel route operations",
+                               {{"op", "add"}, {"result", "ok"}});
+    fibDeletes = &metrics.counter("ospf_fib_operations_total", "Kernel route operations",
+                                  {{"op", "delete"}, {"result", "ok"}});
+    fibFailures = &metrics.counter("ospf_fib_operations_total", "Kernel route operations",
+                                   {{"op", "any"}, {"result", "error"}});
+    spfLatency = &metrics.latency("ospf_spf_duration_seconds", "Shortest path computation time for the FIB");
+    fibAddLatency = &metrics.latency("ospf_fib_operation_seconds", "Kernel route programming time",
+                                     {{"op", "add"}});
+    fibDeleteLatency = &metrics.latency("ospf_fib_operation_seconds", "Kernel route programming time",
+                                        {{"op", "delete"}});
+    for (const char *stage : {"total", "parse", "hmac", "lsdb_update", "relay"})
+    {
+        // Même nom et labels que PacketManager : même instance
+        packetLatencies.emplace_back(stage, &metrics.latency("ospf_packet_processing_seconds",
+                                                             "Receive path latency, by processing stage",
+                                                             {{"stage", stage}}));
+    }
+    const char *propagationHelp = "LSA propagation latency from origination on the originating router";
+    propagationAccepted = &metrics.latency("ospf_lsa_propagation_seconds", propagationHelp, {{"stage", "accepted"}});
+    propagationSpf = &metrics.latency("ospf_lsa_propagation_seconds", propagationHelp, {{"stage", "spf"}});
+    propagationFib = &metrics.latency("ospf_lsa_propagation_seconds", propagationHelp, {{"stage", "fib"}});
+
+    metrics.gaugeCollector("ospf_neighbors", "Neighbors by adjacency state", [this]()
+                           {
+        std::map<NeighborState, double> counts{{NeighborState::Init, 0}, {NeighborState::TwoWay, 0},
+                                               {NeighborState::Full, 0}};
+        for (const auto &neighbor : lsm->getNeighbors())
+        {
+            counts[neighbor.state]++;
+        }
+        std::vector<std::pair<MetricsRegistry::Labels, double>> samples;
+        for (const auto &[state, count] : counts)
+        {
+            samples.push_back({{{"state", LinkStateManager::stateName(state)}}, count});
+        }
+        return samples; });
+    metrics.gaugeCollector("ospf_bfd_sessions", "BFD sessions by state", [this]()
+                           {
+        std::vector<std::pair<MetricsRegistry::Labels, double>> samples;
+        if (!bfd)
+            return samples;
+        std::map<BfdManager::SessionState, double> counts{{BfdManager::SessionState::Down, 0},
+                                                          {BfdManager::SessionState::Init, 0},
+                                                          {BfdManager::SessionState::Up, 0}};
+        for (const auto &[neighborIp, state] : bfd->getSessionStates())
+        {
+            counts[state]++;
+        }
+        for (const auto &[state, count] : counts)
+        {
+            samples.push_back({{{"state", BfdManager::stateName(state)}}, count});
+        }
+        return samples; });
+    metrics.gaugeCollector("ospf_lsdb_lsas", "LSAs in the link-state database", [this]()
+                           { return std::vector<std::pair<MetricsRegistry::Labels, double>>{
+                                 {{}, static_cast<double>(topoDb->getLSACount())}}; });
+    metrics.gaugeCollector("ospf_log_messages_dropped", "Log messages dropped on a full per-thread ring (process)",
+                           []()
+                           { return std::vector<std::pair<MetricsRegistry::Labels, double>>{
+                                 {{}, static_cast<double>(Logger::instance().droppedCount())}}; });
+    metrics.gaugeCollector("ospf_up", "1 while the routing daemon is running", [this]()
+                           { return std::vector<std::pair<MetricsRegistry::Labels, double>>{
+                                 {{}, running.load() ? 1.0 : 0.0}}; });
 }
 
 RoutingDaemon::~RoutingDaemon()
@@ -48,25 +244,150 @@ RoutingDaemon::~RoutingDaemon()
     stop();
 }
 
-bool RoutingDaemon::start()
+bool RoutingDaemon::start(ExecutionMode mode)
 {
     if (running.load())
     {
         return false;
     }
+    // BFD a sa propre socket et son propre thread, cadencés en temps réel
+    if (mode == ExecutionMode::Stepped && bfd)
+    {
+        LOG_ERROR("daemon", "BFD is not supported in stepped mode (set bfd=off)");
+        return false;
+    }
 
+    stepped = mode == ExecutionMode::Stepped;
     running.store(true);
-    networkStartTime = std::chrono::steady_clock::now(); // ← Nouveau
-    hasConverged = false;
+    networkStartTime = timers->now(); // ← Nouveau
+    {
+        std::lock_guard<std::mutex> lock(convergenceMutex);
+        hasConverged = false;
+    }
+    startTraceNs = timers->getClock().traceNanos();
+    episodeStartNs = 0;
+    pendingOriginNs = 0;
+
+    // Piloté par les événements : transitions de voisins et modifications de la LSDB
+    lsaPending = true; // LSA initial (réseaux locaux)
+    lastOriginationTime = std::chrono::steady_clock::time_point{};
+
+    if (!pm->openReceiver(port))
+    {
+        running.store(false);
+        return false;
+    }
+    // Pas à pas, sans thread d'émission : les paquets partent directement sur le transport
+    if (!stepped)
+    {
+        pm->startSender();
+    }
+    if (metricsServer)
+    {
+        metricsServer->start();
+    }
+    if (bfd)
+    {
+        bfd->start();
+        for (const auto &neighbor : lsm->getActiveNeighbors())
+        {
+            bfd->addSession(neighbor);
+        }
+    }
+
+    std::vector<std::string> broadcastAddresses;
+    for (const auto &iface : interfaces)
+    {
+        broadcastAddresses.push_back(calculateBroadcastAddress(iface));
+    }
+    pm->startDiscoveryHello(broadcastAddresses, DISCOVERY_INTERVAL);
+    for (const auto &neighbor : lsm->getActiveNeighbors())
+    {
+        pm->startNeighborHello(neighbor);
+    }
 
-    receiverThread = std::thread([this]()
-                                 { pm->receivePackets(port, *lsm, running, hostname, *topoDb); });
+    if (!capturePath.empty() && !capture->isActive())
+    {
+        startCapture(capturePath);
+    }
 
-    daemonThread = std::thread(&RoutingDaemon::mainLoop, this);
+    if (!stepped)
+    {
+        reactorThread = std::thread(&RoutingDaemon::runReactor, this);
+    }
 
     return true;
 }
 
+void RoutingDaemon::step()
+{
+    if (!stepped || !running.load())
+    {
+        return;
+    }
+    runOnce();
+}
+
+void RoutingDaemon::runReactor()
+{
+    pthread_setname_np(pthread_self(), "daemon-main");
+    while (running.load())
+    {
+        runOnce();
+
+        // max() avant le calcul : une temporisation armée ou un événement poussé entre-temps réveille
+        sleepingUntil.store(ProtocolClock::time_point::max());
+        auto deadline = nextDeadline();
+        sleepingUntil.store(deadline);
+        if (running.load())
+        {
+            TraceSpan span(&tracer, "daemon", "wait");
+            auto now = timers->now();
+            transport->wait(deadline - now < IDLE_WAIT ? deadline - now : IDLE_WAIT);
+        }
+        sleepingUntil.store(ProtocolClock::time_point::min());
+    }
+}
+
+void RoutingDaemon::wakeReactor(ProtocolClock::time_point due)
+{
+    if (due < sleepingUntil.load())
+    {
+        transport->wake();
+    }
+}
+
+void RoutingDaemon::runOnce()
+{
+    // Roue à jour avant les paquets : les temporisations qu'ils arment partent du tick courant
+    {
+        TraceSpan span(&tracer, "daemon", "timers");
+        timers->advance(timers->now());
+    }
+    pm->pollPackets(port, *lsm, hostname, *topoDb);
+
+    DaemonEvent event;
+    while (events.tryPop(event))
+    {
+        handleEvent(event);
+    }
+    processPending();
+}
+
+ProtocolClock::time_point RoutingDaemon::nextDeadline() const
+{
+    if (!events.empty())
+    {
+        return timers->now();
+    }
+    auto deadline = eventDeadline();
+    if (auto expiry = timers->nextExpiry())
+    {
+        deadline = std::min(deadline, *expiry);
+    }
+    return deadline;
+}
+
 void RoutingDaemon::stop()
 {
     if (!running.load())
@@ -75,15 +396,31 @@ void RoutingDaemon::stop()
     }
 
     running.store(false);
-
-    if (receiverThread.joinable())
+    transport->wake();
+    if (reactorThread.joinable())
+    {
+        reactorThread.join();
+    }
+    // Réacteur arrêté : plus aucun callback de temporisation ni de réception en parallèle
+    pm->stopAllHellos();
+    if (bfd)
     {
-        receiverThread.join();
+        bfd->stop();
     }
+    capture->stop(); // Plus de réception : fichier complet
 
-    if (daemonThread.joinable())
+    // Vieillissement prématuré : les voisins retirent nos réseaux sans attendre MaxAge
+    flushSelfLSA();
+    if (refreshTimer != TimerWheel::INVALID_TIMER)
     {
-        daemonThread.join();
+        timers->cancel(refreshTimer);
+        refreshTimer = TimerWheel::INVALID_TIMER;
+    }
+    pm->finishSender(); // Le thread d'émission vide les files (purge comprise) seul, sans bloquer l'arrêt
+    pm->closeReceiver();
+    if (metricsServer)
+    {
+        metricsServer->stop();
     }
 }
 
@@ -144,303 +481,391 @@ void RoutingDaemon::getStatus() const
 
     if (running.load() && lsm)
     {
-        auto neighbors = lsm->getActiveNeighbors();
+        auto neighbors = lsm->getNeighbors();
         std::cout << "Active Neighbors (" << neighbors.size() << "): ";
         for (const auto &neighbor : neighbors)
         {
-            std::cout << neighbor << " ";
+            std::cout << neighbor.ip << "(" << LinkStateManager::stateName(neighbor.state) << ") ";
+        }
+        std::cout << std::endl;
+    }
+
+    if (running.load() && bfd)
+    {
+        std::cout << "BFD Sessions: ";
+        for (const auto &[neighborIp, state] : bfd->getSessionStates())
+        {
+            std::cout << neighborIp << "(" << BfdManager::stateName(state) << ") ";
         }
         std::cout << std::endl;
     }
 }
 
-void RoutingDaemon::mainLoop()
+ProtocolClock::time_point RoutingDaemon::eventDeadline() const
 {
-    while (running.load())
+    auto deadline = ProtocolClock::time_point::max();
+    if (lsaPending)
+    {
+        deadline = std::min(deadline, lastOriginationTime + MIN_LS_INTERVAL);
+    }
+    if (!hasConverged && episodeStartNs != 0)
+    {
+        deadline = std::min(deadline, lastTopologyChangeTime + CONVERGENCE_STABLE_TIME);
+    }
+    return deadline;
+}
+
+void RoutingDaemon::processPending()
+{
+    // Origination limitée par MIN_LS_INTERVAL pour absorber les rafales de changements
+    auto now = timers->now();
+    if (lsaPending && now - lastOriginationTime >= MIN_LS_INTERVAL)
     {
-        auto loopStart = std::chrono::steady_clock::now();
+        lsaPending = false;
+        lastOriginationTime = now;
+        originateLSA();
+    }
 
-        // ======= PHASE 1: COMMUNICATION =======
-        // 1. Hello broadcast (découverte initiale) - TRÈS réduit
-        static int broadcastCounter = 0;
-        if (broadcastCounter % 10 == 0) // Seulement tous les 10 cycles
+    // Topologie d'inondation recalculée au plus une fois par passe, pas à chaque LSA reçu
+    if (floodingTopology)
+    {
+        floodingTopology->refresh(*topoDb);
+    }
+
+    if (topoDb->getGeneration() != lastSpfGeneration)
+    {
+        lastSpfGeneration = topoDb->getGeneration();
+        updateRoutes();
+    }
+    else
+    {
+        checkConvergence();
+    }
+}
+
+void RoutingDaemon::handleEvent(const DaemonEvent &event)
+{
+    static const char *const SPAN_NAMES[] = {"event_neighbor", "event_lsdb", "event_self_lsa", "event_max_age",
+                                             "event_refresh", "event_link_cost"};
+    TraceSpan span(&tracer, "daemon", SPAN_NAMES[static_cast<int>(event.type)]);
+
+    if (event.type == DaemonEvent::Type::SelfLSAReceived)
+    {
+        if (event.sequence >= lsaSequence)
         {
-            for (const auto &iface : interfaces)
-            {
-                std::string broadcastAddr = calculateBroadcastAddress(iface);
-                pm->sendHello(broadcastAddr, port, hostname, interfaces);
-            }
+            lsaSequence = event.sequence + 1;
+            lsaPending = true;
         }
-        broadcastCounter++;
-
-        // 2. Hello unicast aux voisins connus - PRIORITAIRE
-        auto activeNeighbors = lsm->getActiveNeighbors();
-        for (const auto &neighbor : activeNeighbors)
+        return;
+    }
+    if (event.type == DaemonEvent::Type::RefreshLSA || event.type == DaemonEvent::Type::LinkCostChanged)
+    {
+        lsaPending = true;
+        return;
+    }
+    if (event.type == DaemonEvent::Type::LsaMaxAged)
+    {
+        if (event.origin == hostname)
         {
-            int adaptiveInterval = lsm->getAdaptiveHelloInterval(neighbor);
-            if (pm->shouldSendHello(neighbor, adaptiveInterval))
-            {
-                pm->sendHello(neighbor, port, hostname, interfaces);
-            }
+            lsaPending = true; // Ne devrait pas arriver grâce au rafraîchissement
+            return;
         }
 
-        // ======= PHASE 2: NETTOYAGE (TRÈS PRUDENT) =======
-        static int purgeCounter = 0;
-        if (purgeCounter % 15 == 0) // Purger seulement tous les 30 cycles !!
+        // Propager la purge aux voisins adjacents
+        json lsa;
+        if (topoDb->getLSA(event.origin, lsa))
         {
-            lsm->purgeInactiveNeighbors();
+            std::vector<std::string> adjacentIps;
+            for (const auto &neighbor : lsm->getNeighbors(NeighborState::TwoWay))
+            {
+                adjacentIps.push_back(neighbor.ip);
+            }
+            pm->floodLSA(adjacentIps, port, lsa, hostname);
         }
-        purgeCounter++;
+        return;
+    }
+    if (event.type != DaemonEvent::Type::NeighborStateChanged)
+        return; // LsdbChanged : le SPF est déclenché par le changement de génération
 
-        // ======= PHASE 3: DÉTECTION DE STABILITÉ =======
-        auto activeNeighborHostnames = lsm->getActiveNeighborHostnames();
-        std::set<std::string> uniqueNeighbors(activeNeighborHostnames.begin(), activeNeighborHostnames.end());
-        std::vector<std::string> neighbors(uniqueNeighbors.begin(), uniqueNeighbors.end());
-        auto activeNeighborIPs = lsm->getActiveNeighbors();
+    const NeighborEvent &ev = event.neighbor;
+    if (event.bfdDown)
+    {
+        // La transition Down émise ici revient par la file comme les autres
+        lsm->removeNeighbor(ev.ip);
+        return;
+    }
 
-        // Trier pour comparaison stable
-        std::sort(neighbors.begin(), neighbors.end());
-        std::sort(activeNeighborIPs.begin(), activeNeighborIPs.end());
+    bool wasAdjacent = ev.oldState >= NeighborState::TwoWay;
+    bool isAdjacent = ev.newState >= NeighborState::TwoWay;
 
-        // Variables static pour la stabilité
-        static std::vector<std::string> lastNeighbors;
-        static std::vector<std::string> lastActiveIPs;
-        static int stableCount = 0;
-        static bool isFirstRun = true;
+    if (!wasAdjacent && isAdjacent)
+    {
+        // Nouvelle adjacence : synchroniser la base vers ce voisin puis passer Full
+        synchronizeNeighbor(ev.ip);
+        lsm->markFull(ev.ip);
+        lsaPending = true;
+    }
+    else if (wasAdjacent && !isAdjacent)
+    {
+        lsaPending = true;
+    }
+}
 
-        // Détection des changements
-        bool neighborsChanged = (neighbors != lastNeighbors);
-        bool ipsChanged = (activeNeighborIPs != lastActiveIPs);
+void RoutingDaemon::synchronizeNeighbor(const std::string &neighborIp)
+{
+    // Description de base : le voisin ne demandera que les LSA qui lui manquent
+    pm->startDatabaseExchange(neighborIp, port, hostname, topoDb->getHeaders());
+}
 
-        if (neighborsChanged || ipsChanged)
-        {
-            stableCount = 0; // Reset stabilité
-            isFirstRun = false;
-        }
-        else
-        {
-            stableCount++;
-        }
+void RoutingDaemon::originateLSA()
+{
+    TraceSpan span(&tracer, "daemon", "originate_lsa");
+    // Voisins en 2-Way ou Full, triés et dédoublonnés par hostname
+    auto adjacent = lsm->getNeighbors(NeighborState::TwoWay);
+    std::map<std::string, std::string> neighborByHostname; // hostname -> IP
+    for (const auto &neighbor : adjacent)
+    {
+        if (!neighbor.hostname.empty())
+            neighborByHostname.emplace(neighbor.hostname, neighbor.ip);
+    }
 
-        // TOUJOURS mettre à jour les références
-        lastNeighbors = neighbors;
-        lastActiveIPs = activeNeighborIPs;
+    std::vector<std::string> neighbors;
+    std::vector<std::string> neighborIps;
+    for (const auto &[neighborHostname, neighborIp] : neighborByHostname)
+    {
+        neighbors.push_back(neighborHostname);
+        neighborIps.push_back(neighborIp);
+    }
 
-        // ======= PHASE 4: ATTENTE DE STABILITÉ =======
-        if (stableCount < 5) // Augmenter le seuil à 5 cycles
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(3000)); // 3 secondes
+    // Réseaux réels des interfaces (longueur issue du netmask, /24 par défaut)
+    auto localAddresses = fib->localAddresses();
+    std::vector<Ipv4Prefix> localNetworks;
+    std::vector<json> networkInterfaces;
+    for (const auto &iface : interfaces)
+    {
+        uint32_t addr;
+        if (!parseIpv4(iface, addr))
             continue;
-        }
 
-        // ======= PHASE 5: CRÉATION ET ENVOI LSA =======
-        static std::vector<std::string> lastLSANeighbors;
-        static std::vector<std::string> lastLSAActiveIPs;
+        uint8_t prefixLength = 24;
+        auto localIt = std::find_if(localAddresses.begin(), localAddresses.end(),
+                                    [&](const LocalInterfaceAddress &a)
+                                    { return a.ip == iface; });
+        if (localIt != localAddresses.end())
+            prefixLength = localIt->prefixLength;
 
-        bool needsNewLSA = (neighbors != lastLSANeighbors) || (activeNeighborIPs != lastLSAActiveIPs);
+        Ipv4Prefix net = Ipv4Prefix::fromAddress(addr, prefixLength);
+        localNetworks.push_back(net);
 
-        if (!needsNewLSA)
+        if (localIt != localAddresses.end())
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(5000)); // 5 secondes
-            continue;
+            networkInterfaces.push_back({{"network", net.toString()},
+                                         {"interface_ip", iface},
+                                         {"interface_name", localIt->name}});
         }
+    }
 
-        // Créer et envoyer le LSA
-        lastLSANeighbors = neighbors;
-        lastLSAActiveIPs = activeNeighborIPs;
+    // Annoncer les agrégats configurés à la place des réseaux qu'ils couvrent
+    std::vector<std::string> networks;
+    for (const auto &prefix : summarizePrefixes(localNetworks, summaryRanges))
+    {
+        networks.push_back(prefix.toString());
+    }
 
+    json currentLSA = {
+        {"type", "LSA"},
+        {"hostname", hostname},
+        {"sequence_number", lsaSequence++},
+        {"age", 0},
+        {"interfaces", interfaces},
+        {"neighbors", neighbors},
+        {"networks", networks},
+        {"network_interfaces", networkInterfaces},
+        {"link_capacities", getLinkCapabilities(neighborIps)},
+        {"link_costs", getLinkCosts(neighborIps)},
+        {"link_states", getLinkStates(neighborIps)}};
+    stampOrigination(currentLSA);
+
+    std::string lsaStr = currentLSA.dump();
+    std::string hmac = computeHMAC(lsaStr, "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
+    currentLSA["hmac"] = toHex(hmac);
+
+    // Mettre à jour la topologie locale puis inonder les voisins adjacents
+    topoDb->updateLSA(currentLSA);
+    lsaOriginations->inc();
+    std::vector<std::string> adjacentIps;
+    for (const auto &neighbor : adjacent)
+    {
+        adjacentIps.push_back(neighbor.ip);
+    }
+    pm->floodLSA(adjacentIps, port, currentLSA, hostname);
 
-        // Création du LSA (code existant)
-        static int mySeq = 0;
-        std::vector<std::string> networks;
-        for (const auto &iface : interfaces)
-        {
-            size_t lastDot = iface.find_last_of('.');
-            if (lastDot != std::string::npos)
-            {
-                networks.push_back(iface.substr(0, lastDot + 1) + "0/24");
-            }
-        }
+    if (!timers->restart(refreshTimer, LS_REFRESH_TIME))
+    {
+        refreshTimer = timers->schedule(LS_REFRESH_TIME, [this]()
+                                        { events.push({DaemonEvent::Type::RefreshLSA, {}}); });
+    }
+}
 
-        std::vector<json> networkInterfaces;
-        auto ipIfacePairs = getLocalIpInterfaceMapping();
-        for (const auto &[ifaceIp, ifaceName] : ipIfacePairs)
-        {
-            if (std::find(interfaces.begin(), interfaces.end(), ifaceIp) != interfaces.end())
-            {
-                size_t lastDot = ifaceIp.find_last_of('.');
-                if (lastDot != std::string::npos)
-                {
-                    std::string net = ifaceIp.substr(0, lastDot + 1) + "0/24";
-                    networkInterfaces.push_back({{"network", net},
-                                                 {"interface_ip", ifaceIp},
-                                                 {"interface_name", ifaceName}});
-                }
-            }
-        }
+void RoutingDaemon::flushSelfLSA()
+{
+    json lsa;
+    if (!topoDb->getLSA(hostname, lsa) || TopologyDatabase::isMaxAge(lsa))
+        return;
+
+    lsa["sequence_number"] = lsaSequence++;
+    lsa["age"] = TopologyDatabase::MAX_AGE.count();
+    stampOrigination(lsa);
+    topoDb->updateLSA(lsa);
+
+    std::vector<std::string> adjacentIps;
+    for (const auto &neighbor : lsm->getNeighbors(NeighborState::TwoWay))
+    {
+        adjacentIps.push_back(neighbor.ip);
+    }
+    pm->floodLSA(adjacentIps, port, lsa, hostname);
+}
+
+void RoutingDaemon::stampOrigination(json &lsa) const
+{
+    int64_t originatedNs = timers->getClock().traceNanos();
+    uint64_t id = std::hash<std::string>{}(hostname) * 0x9e3779b97f4a7c15ull ^
+                  static_cast<uint64_t>(originatedNs) ^ (static_cast<uint64_t>(lsa.value("sequence_number", 0)) << 40);
+    char traceId[17];
+    snprintf(traceId, sizeof(traceId), "%016llx", static_cast<unsigned long long>(id));
+    lsa["originated_ns"] = originatedNs;
+    lsa["trace_id"] = traceId;
+}
+
+void RoutingDaemon::updateRoutes()
+{
+    // Instances acceptées avant cette SPF : elles seront dans la table qu'elle produit
+    auto accepted = topoDb->takeAcceptedLSAs();
+    auto spfStart = std::chrono::steady_clock::now();
+    auto newRoutingTable = topoDb->computeRoutingTable(hostname);
+    auto spfEnd = std::chrono::steady_clock::now();
+    int64_t spfNs = timers->getClock().traceNanos();
+    spfLatency->record(spfEnd - spfStart);
+    if (tracer.isEnabled())
+    {
+        tracer.record("daemon", "spf", spfStart, spfEnd, "routes", static_cast<int64_t>(newRoutingTable.table.size()));
+    }
+    spfRuns->inc();
+    bool routingTableChanged = firstRoutingRun;
 
-        json currentLSA = {
-            {"type", "LSA"},
-            {"hostname", hostname},
-            {"sequence_number", mySeq++},
-            {"interfaces", interfaces},
-            {"neighbors", neighbors},
-            {"networks", networks},
-            {"network_interfaces", networkInterfaces},
-            {"link_capacities", getLinkCapabilities()},
-            {"link_states", getLinkStates()}};
-
-        std::string lsaStr = currentLSA.dump();
-        std::string hmac = computeHMAC(lsaStr, "rreNofDO7Bdd9xObfMAbC1pDOhpRR9BX7FTk512YV");
-        currentLSA["hmac"] = toHex(hmac);
-
-        // Envoyer LSA aux voisins actifs
-        for (const auto &neighbor : activeNeighbors)
+    if (!firstRoutingRun)
+    {
+        if (newRoutingTable.table.size() != lastRoutingTable.size())
         {
-            pm->sendOptimizedLSA(neighbor, port, currentLSA, hostname);
+            routingTableChanged = true;
         }
-        if (neighborsChanged || ipsChanged)
+        else
         {
-
-            // Diffuser immédiatement tous les LSA connus
-            for (const auto &[lsaHostname, lsa] : topoDb->lsaMap)
+            for (const auto &[dest, nextHop] : newRoutingTable.table)
             {
-                for (const auto &neighbor : activeNeighbors)
+                auto it = lastRoutingTable.find(dest);
+                if (it == lastRoutingTable.end() || it->second != nextHop)
                 {
-                    pm->sendOptimizedLSA(neighbor, port, lsa, hostname);
+                    routingTableChanged = true;
+                    break;
                 }
             }
         }
+    }
 
-        static auto lastFloodTime = std::chrono::steady_clock::now();
-        auto now = std::chrono::steady_clock::now();
-
-        if (now - lastFloodTime > std::chrono::seconds(10)) // ← RÉDUIRE à 10 secondes
+    if (routingTableChanged)
+    {
+        recordTopologyChange();
+        if (firstRoutingRun)
+            firstRoutingRun = false;
+
+        // Appliquer les routes : résolution O(1) via l'index des next-hops
+        TraceSpan fibSpan(&tracer, "daemon", "fib_update");
+        resolver->refresh(*topoDb);
+        for (const auto &[dest, nextHop] : newRoutingTable.table)
         {
+            if (nextHop == "local" || nextHop == hostname)
+                continue;
+            if (dest.find('/') == std::string::npos)
+                continue;
 
-            for (const auto &[lsaHostname, lsa] : topoDb->lsaMap)
+            NextHop nh;
+            if (resolver->resolve(nextHop, nh) && !nh.ifName.empty())
             {
-                if (lsaHostname != hostname) // Ne pas re-diffuser son propre LSA
-                {
-                    for (const auto &neighbor : activeNeighbors)
-                    {
-                        pm->sendOptimizedLSA(neighbor, port, lsa, hostname);
-                    }
-                }
+                LatencyTimer fibTimer(*fibAddLatency);
+                TraceSpan span(&tracer, "fib", "fib_add");
+                (fib->addRoute(dest, nh.ip, nh.ifName) ? fibAdds : fibFailures)->inc();
             }
-
-            lastFloodTime = now;
         }
 
-        // Mettre à jour la topologie locale
-        topoDb->updateLSA(currentLSA);
-
-        // ======= PHASE 6: CALCUL DES ROUTES =======
-        static std::map<std::string, std::string> lastRoutingTable;
-        static bool firstRoutingRun = true;
-
-        auto newRoutingTable = topoDb->computeRoutingTable(hostname);
-        bool routingTableChanged = firstRoutingRun;
-
-        if (!firstRoutingRun)
+        // Retirer les préfixes disparus (LSA purgés à MaxAge ou origine injoignable)
+        for (const auto &[dest, nextHop] : lastRoutingTable)
         {
-            if (newRoutingTable.table.size() != lastRoutingTable.size())
-            {
-                routingTableChanged = true;
-            }
-            else
+            if (!newRoutingTable.table.count(dest) && dest.find('/') != std::string::npos)
             {
-                for (const auto &[dest, nextHop] : newRoutingTable.table)
-                {
-                    auto it = lastRoutingTable.find(dest);
-                    if (it == lastRoutingTable.end() || it->second != nextHop)
-                    {
-                        routingTableChanged = true;
-                        break;
-                    }
-                }
+                LatencyTimer fibTimer(*fibDeleteLatency);
+                TraceSpan span(&tracer, "fib", "fib_delete");
+                (fib->deleteRoute(dest) ? fibDeletes : fibFailures)->inc();
             }
         }
 
-        if (routingTableChanged)
-        {
-            recordTopologyChange();
-            if (firstRoutingRun)
-                firstRoutingRun = false;
-
-            // Appliquer les routes (code existant)
-            for (const auto &[dest, nextHop] : newRoutingTable.table)
-            {
-                if (nextHop == "local" || nextHop == hostname)
-                    continue;
-                if (dest.find('/') == std::string::npos)
-                    continue;
-
-                std::string nextHopIp = "";
-                std::string iface = "";
+        lastRoutingTable = std::map<std::string, std::string>(newRoutingTable.table.begin(), newRoutingTable.table.end());
+    }
 
-                // Code existant pour résoudre nextHopIp et iface...
-                auto lsaIt = topoDb->lsaMap.find(nextHop);
-                if (lsaIt != topoDb->lsaMap.end() && lsaIt->second.contains("interfaces"))
-                {
-                    const auto &nextHopIfaces = lsaIt->second["interfaces"];
-                    for (size_t i = 0; i < interfaces.size(); ++i)
-                    {
-                        const std::string &localIp = interfaces[i];
-                        size_t lastDot = localIp.find_last_of('.');
-                        if (lastDot == std::string::npos)
-                            continue;
-                        std::string localNet = localIp.substr(0, lastDot + 1);
-
-                        for (const auto &nhIp : nextHopIfaces)
-                        {
-                            size_t nhLastDot = nhIp.get<std::string>().find_last_of('.');
-                            if (nhLastDot == std::string::npos)
-                                continue;
-                            std::string nhNet = nhIp.get<std::string>().substr(0, nhLastDot + 1);
-
-                            if (localNet == nhNet)
-                            {
-                                nextHopIp = nhIp.get<std::string>();
-                                for (const auto &ni : networkInterfaces)
-                                {
-                                    if (ni["interface_ip"] == localIp)
-                                    {
-                                        iface = ni["interface_name"];
-                                        break;
-                                    }
-                                }
-                                break;
-                            }
-                        }
-                        if (!nextHopIp.empty())
-                            break;
-                    }
-                }
+    recordPropagation(accepted, spfNs, timers->getClock().traceNanos(), routingTableChanged);
+    checkConvergence();
+}
 
-                if (!nextHopIp.empty() && !iface.empty())
-                {
-                    addRoute(dest, nextHopIp, iface);
-                }
-            }
+void RoutingDaemon::recordPropagation(const std::vector<TopologyDatabase::AcceptedLSA> &accepted, int64_t spfNs,
+                                      int64_t fibNs, bool routingTableChanged)
+{
+    for (const auto &entry : accepted)
+    {
+        // Instances resynchronisées (âge non nul, antérieures au démarrage) ou purgées : pas une propagation
+        if (entry.age != 0 || entry.originatedNs < startTraceNs)
+            continue;
 
-            lastRoutingTable = std::map<std::string, std::string>(newRoutingTable.table.begin(), newRoutingTable.table.end());
-            checkConvergence();
+        // Notre propre LSA ouvre aussi l'épisode (perte d'un voisin), sans latence de propagation
+        int64_t window = std::chrono::duration_cast<std::chrono::nanoseconds>(CONVERGENCE_STABLE_TIME).count();
+        if (pendingOriginNs == 0 || fibNs - pendingAcceptedNs > window)
+        {
+            pendingOriginNs = entry.originatedNs;
+            pendingAcceptedNs = entry.acceptedNs;
         }
         else
         {
-            checkConvergence();
+            pendingOriginNs = std::min(pendingOriginNs, entry.originatedNs);
         }
+        if (entry.origin == hostname)
+            continue;
 
-        // ======= PHASE 7: SLEEP FINAL =======
-        auto loopEnd = std::chrono::steady_clock::now();
-        auto loopDuration = std::chrono::duration_cast<std::chrono::milliseconds>(loopEnd - loopStart).count();
-        int remainingSleep = std::max(2000, 4000 - static_cast<int>(loopDuration)); // Minimum 2s
+        LsaPropagation propagation{entry.origin, entry.traceId, entry.originatedNs, entry.acceptedNs, spfNs, fibNs};
+        propagationAccepted->record(std::chrono::nanoseconds(propagation.acceptedNs - propagation.originatedNs));
+        propagationSpf->record(std::chrono::nanoseconds(propagation.spfNs - propagation.originatedNs));
+        propagationFib->record(std::chrono::nanoseconds(propagation.fibNs - propagation.originatedNs));
+        if (propagationObserver)
+            propagationObserver(propagation);
+
+        std::lock_guard<std::mutex> lock(propagationMutex);
+        recentPropagations.push_back(std::move(propagation));
+        if (recentPropagations.size() > RECENT_PROPAGATIONS)
+            recentPropagations.pop_front();
+    }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(remainingSleep));
+    if (routingTableChanged)
+    {
+        if (episodeStartNs == 0)
+            episodeStartNs = pendingOriginNs != 0 ? std::min(pendingOriginNs, fibNs) : fibNs;
+        lastRouteChangeNs = fibNs;
+        pendingOriginNs = 0;
     }
 }
 
+void RoutingDaemon::setPropagationObserver(std::function<void(const LsaPropagation &)> observer)
+{
+    propagationObserver = std::move(observer);
+}
+
 void RoutingDaemon::requestNeighborsFrom(const std::string &targetIp) const
 {
     if (!running.load())
@@ -453,75 +878,42 @@ void RoutingDaemon::requestNeighborsFrom(const std::string &targetIp) const
     pm->sendNeighborRequest(targetIp, port, hostname);
 }
 
-std::vector<double> RoutingDaemon::getLinkCapabilities() const
+std::vector<double> RoutingDaemon::getLinkCapabilities(const std::vector<std::string> &neighborIps) const
 {
+    // Débit réel de l'interface de sortie (sysfs, mis en cache par LinkMetrics)
     std::vector<double> capacities;
-    auto activeNeighbors = lsm->getActiveNeighbors();
-    auto ipIfacePairs = getLocalIpInterfaceMapping();
-
-    for (const auto &neighbor : activeNeighbors)
+    for (const auto &neighbor : neighborIps)
     {
-        double capacity = 1000.0; // Valeur par défaut (1 Gbps)
-
-        // Trouver l'interface locale utilisée pour ce voisin
-        for (const auto &localIp : interfaces)
-        {
-            size_t lastDot = localIp.find_last_of('.');
-            if (lastDot == std::string::npos)
-                continue;
-            std::string localNet = localIp.substr(0, lastDot + 1);
-
-            size_t neighLastDot = neighbor.find_last_of('.');
-            if (neighLastDot == std::string::npos)
-                continue;
-            std::string neighNet = neighbor.substr(0, neighLastDot + 1);
-
-            if (localNet == neighNet)
-            {
-                // Trouver le nom de l'interface
-                for (const auto &[ip, ifaceName] : ipIfacePairs)
-                {
-                    if (ip == localIp)
-                    {
-                        // Déterminer la capacité basée sur le type d'interface
-                        if (ifaceName.find("eth") != std::string::npos ||
-                            ifaceName.find("enp") != std::string::npos)
-                        {
-                            capacity = 1000.0; // Ethernet 1 Gbps
-                        }
-                        else if (ifaceName.find("wlan") != std::string::npos ||
-                                 ifaceName.find("wifi") != std::string::npos)
-                        {
-                            capacity = 100.0; // WiFi ~100 Mbps
-                        }
-                        else if (ifaceName.find("lo") != std::string::npos)
-                        {
-                            capacity = 10000.0; // Loopback très rapide
-                        }
-                        break;
-                    }
-                }
-                break;
-            }
-        }
-
-        capacities.push_back(capacity);
+        capacities.push_back(linkMetrics->getSpeedMbps(neighbor));
     }
-
     return capacities;
 }
 
-std::vector<bool> RoutingDaemon::getLinkStates() const
+std::vector<int> RoutingDaemon::getLinkCosts(const std::vector<std::string> &neighborIps) const
 {
-    std::vector<bool> states;
-    auto activeNeighbors = lsm->getActiveNeighbors();
-
-    for (const auto &neighbor : activeNeighbors)
+    // Coût entier : débit, RTT lissé et perte mesurés
+    std::vector<int> costs;
+    for (const auto &neighbor : neighborIps)
     {
-        states.push_back(true);
+        costs.push_back(linkMetrics->getLinkCost(neighbor));
     }
+    return costs;
+}
 
-    return states;
+std::vector<bool> RoutingDaemon::getLinkStates(const std::vector<std::string> &neighborIps) const
+{
+    // Les voisins listés sont adjacents (2-Way ou Full) : liens actifs
+    return std::vector<bool>(neighborIps.size(), true);
+}
+
+static void printLatency(const std::string &label, const LatencyHistogram &histogram)
+{
+    auto ms = [&](double q)
+    { return std::chrono::duration<double, std::milli>(histogram.quantile(q)).count(); };
+
+    std::cout << std::left << std::setw(20) << label << std::right << std::fixed << std::setprecision(3)
+              << ms(0.5) << " / " << ms(0.99) << " / " << ms(0.999) << " ms (n=" << histogram.count() << ")"
+              << std::endl;
 }
 
 void RoutingDaemon::showRoutingMetrics() const
@@ -530,36 +922,86 @@ void RoutingDaemon::showRoutingMetrics() const
     std::cout << "Router: " << hostname << std::endl;
 
     // Nouvelles métriques de convergence
-    auto now = std::chrono::steady_clock::now();
+    auto now = timers->now();
     auto uptime = std::chrono::duration_cast<std::chrono::seconds>(now - networkStartTime);
 
     std::cout << "\n--- Convergence Metrics ---" << std::endl;
     std::cout << "Network uptime: " << uptime.count() << " seconds" << std::endl;
-    std::cout << "Current state: " << (hasConverged ? "Converged" : "Converging") << std::endl;
-    std::cout << "Convergence events: " << convergenceCount << std::endl;
 
-    if (!convergenceTimes.empty())
+    // Copie sous verrou : le réacteur modifie ces champs dans checkConvergence
+    bool converged;
+    int count;
+    double averageMs = 0.0;
+    std::chrono::milliseconds lastTime{0};
+    bool hasTimes;
+    std::chrono::steady_clock::time_point changeTime;
+    {
+        std::lock_guard<std::mutex> lock(convergenceMutex);
+        converged = hasConverged;
+        count = convergenceCount;
+        hasTimes = !convergenceTimes.empty();
+        if (hasTimes)
+        {
+            averageMs = getAverageConvergenceTimeLocked();
+            lastTime = convergenceTimes.back();
+        }
+        changeTime = lastTopologyChangeTime;
+    }
+
+    std::cout << "Current state: " << (converged ? "Converged" : "Converging") << std::endl;
+    std::cout << "Convergence events: " << count << std::endl;
+
+    if (hasTimes)
     {
         std::cout << "Average convergence time: " << std::fixed << std::setprecision(2)
-                  << getAverageConvergenceTime() / 1000.0 << " seconds" << std::endl;
+                  << averageMs / 1000.0 << " seconds" << std::endl;
         std::cout << "Last convergence time: " << std::fixed << std::setprecision(2)
-                  << convergenceTimes.back().count() / 1000.0 << " seconds" << std::endl;
+                  << lastTime.count() / 1000.0 << " seconds" << std::endl;
     }
 
-    if (!hasConverged && lastTopologyChangeTime != std::chrono::steady_clock::time_point{})
+    if (!converged && changeTime != std::chrono::steady_clock::time_point{})
     {
-        auto timeSinceChange = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now - lastTopologyChangeTime);
+        auto timeSinceChange = std::chrono::duration_cast<std::chrono::milliseconds>(now - changeTime);
         std::cout << "Time since last change: " << std::fixed << std::setprecision(2)
                   << timeSinceChange.count() / 1000.0 << " seconds" << std::endl;
     }
 
+    std::cout << "\n--- Latency (p50 / p99 / p999) ---" << std::endl;
+    printLatency("SPF", *spfLatency);
+    printLatency("FIB add", *fibAddLatency);
+    printLatency("FIB delete", *fibDeleteLatency);
+    for (const auto &[stage, histogram] : packetLatencies)
+    {
+        printLatency("Packet " + stage, *histogram);
+    }
+
+    std::cout << "\n--- LSA Propagation from origin (p50 / p99 / p999) ---" << std::endl;
+    printLatency("Accepted", *propagationAccepted);
+    printLatency("SPF done", *propagationSpf);
+    printLatency("FIB programmed", *propagationFib);
+    {
+        std::lock_guard<std::mutex> lock(propagationMutex);
+        for (const auto &p : recentPropagations)
+        {
+            auto ms = [&](int64_t at)
+            { return (at - p.originatedNs) / 1e6; };
+            std::cout << "  " << p.origin << " [" << p.traceId << "]: accepted +" << std::fixed
+                      << std::setprecision(1) << ms(p.acceptedNs) << " ms, spf +" << ms(p.spfNs) << " ms, fib +"
+                      << ms(p.fibNs) << " ms" << std::endl;
+        }
+    }
+
     // Ajout d'informations détaillées sur la base de données LSA
     std::cout << "\n--- LSA Database ---" << std::endl;
-    std::cout << "Known LSAs: " << topoDb->lsaMap.size() << std::endl;
-    for (const auto &[hostname_lsa, lsa] : topoDb->lsaMap)
+    auto lsas = topoDb->snapshotLSAs();
+    std::cout << "Known LSAs: " << lsas.size() << ", digest=" << std::hex << topoDb->getDigestRoot()
+              << std::dec << std::endl;
+    for (const auto &lsa : lsas)
     {
-        std::cout << "  " << hostname_lsa << ": seq=" << lsa["sequence_number"].get<int>();
+        std::cout << "  " << lsa.value("hostname", "") << ": seq=" << lsa["sequence_number"].get<int>()
+                  << ", age=" << TopologyDatabase::ageOf(lsa) << "s";
+        if (TopologyDatabase::isMaxAge(lsa))
+            std::cout << " (MaxAge)";
         if (lsa.contains("networks"))
         {
             std::cout << ", networks=" << lsa["networks"].size();
@@ -592,9 +1034,10 @@ void RoutingDaemon::showRoutingMetrics() const
     {
         std::cout << "Destination: " << dest << " -> Next Hop: " << nextHop << std::endl;
 
-        if (topoDb->lsaMap.count(nextHop))
+        // Copie sous le verrou de la LSDB : le réacteur peut retirer le LSA (vieillissement) en parallèle
+        json lsa;
+        if (topoDb->getLSA(nextHop, lsa))
         {
-            const auto &lsa = topoDb->lsaMap.at(nextHop);
             if (lsa.contains("link_capacities") && lsa.contains("neighbors"))
             {
                 const auto &neighbors = lsa["neighbors"];
@@ -642,23 +1085,7 @@ void RoutingDaemon::showRoutingTable() const
               << std::setw(10) << "Metric" << std::endl;
     std::cout << "----------------------------------------" << std::endl;
 
-    // Obtenir les interfaces réseau pour trouver les noms d'interfaces
-    auto ipIfacePairs = getLocalIpInterfaceMapping();
-    std::vector<json> networkInterfaces;
-    for (const auto &[ifaceIp, ifaceName] : ipIfacePairs)
-    {
-        if (std::find(interfaces.begin(), interfaces.end(), ifaceIp) != interfaces.end())
-        {
-            size_t lastDot = ifaceIp.find_last_of('.');
-            if (lastDot != std::string::npos)
-            {
-                std::string net = ifaceIp.substr(0, lastDot + 1) + "0/24";
-                networkInterfaces.push_back({{"network", net},
-                                             {"interface_ip", ifaceIp},
-                                             {"interface_name", ifaceName}});
-            }
-        }
-    }
+    resolver->refresh(*topoDb);
 
     for (const auto &[dest, nextHop] : routingTable.table)
     {
@@ -673,41 +1100,10 @@ void RoutingDaemon::showRoutingTable() const
         else
         {
             // Trouver l'interface de sortie
-            auto lsaIt = topoDb->lsaMap.find(nextHop);
-            if (lsaIt != topoDb->lsaMap.end() && lsaIt->second.contains("interfaces"))
+            NextHop nh;
+            if (resolver->resolve(nextHop, nh) && !nh.ifName.empty())
             {
-                const auto &nextHopIfaces = lsaIt->second["interfaces"];
-                for (size_t i = 0; i < interfaces.size(); ++i)
-                {
-                    const std::string &localIp = interfaces[i];
-                    size_t lastDot = localIp.find_last_of('.');
-                    if (lastDot == std::string::npos)
-                        continue;
-                    std::string localNet = localIp.substr(0, lastDot + 1);
-
-                    for (const auto &nhIp : nextHopIfaces)
-                    {
-                        size_t nhLastDot = nhIp.get<std::string>().find_last_of('.');
-                        if (nhLastDot == std::string::npos)
-                            continue;
-                        std::string nhNet = nhIp.get<std::string>().substr(0, nhLastDot + 1);
-
-                        if (localNet == nhNet)
-                        {
-                            for (const auto &ni : networkInterfaces)
-                            {
-                                if (ni["interface_ip"] == localIp)
-                                {
-                                    interfaceName = ni["interface_name"];
-                                    break;
-                                }
-                            }
-                            break;
-                        }
-                    }
-                    if (interfaceName != "unknown")
-                        break;
-                }
+                interfaceName = nh.ifName;
             }
         }
 
@@ -721,32 +1117,50 @@ void RoutingDaemon::showRoutingTable() const
     std::cout << "Total routes: " << routingTable.table.size() << std::endl;
 }
 
-int RoutingDaemon::getAdaptiveSleepTime() const
+bool RoutingDaemon::startCapture(const std::string &path)
 {
-    auto activeNeighbors = lsm->getActiveNeighbors();
-    int stableNeighbors = 0;
-
-    for (const auto &neighbor : activeNeighbors)
+    if (!capture->start(path, hostname, port, timers->now()))
     {
-        if (lsm->isNeighborStable(neighbor))
-        {
-            stableNeighbors++;
-        }
+        return false;
     }
+    std::cout << "Capturing received packets to " << path << std::endl;
+    return true;
+}
 
-    // Plus le réseau est stable, plus on peut attendre
-    if (stableNeighbors == activeNeighbors.size() && stableNeighbors > 0)
-    {
-        return 8000; // 8 secondes si tous les voisins sont stables
-    }
-    else if (stableNeighbors > activeNeighbors.size() / 2)
-    {
-        return 6000; // 6 secondes si majorité stable
-    }
-    else
+void RoutingDaemon::stopCapture()
+{
+    capture->stop();
+}
+
+void RoutingDaemon::showCaptureStatus() const
+{
+    auto status = capture->getStatus();
+    std::cout << "\n=== Packet Capture ===" << std::endl;
+    std::cout << "State: " << (status.active ? "active" : "stopped") << std::endl;
+    if (status.path.empty())
     {
-        return 4000; // 4 secondes si réseau instable
+        return;
     }
+    std::cout << "File: " << status.path << std::endl;
+    std::cout << "Packets captured: " << status.records << " (" << status.bytes << " bytes)" << std::endl;
+    std::cout << "Packets dropped (ring full): " << status.dropped << std::endl;
+}
+
+void RoutingDaemon::setTracing(bool on)
+{
+    tracer.setEnabled(on);
+}
+
+bool RoutingDaemon::dumpTrace(const std::string &path) const
+{
+    return tracer.dump(path, hostname);
+}
+
+void RoutingDaemon::showTraceStatus() const
+{
+    std::cout << "\n=== Phase Tracing ===" << std::endl;
+    std::cout << "State: " << (tracer.isEnabled() ? "on" : "off") << std::endl;
+    std::cout << "Spans buffered: " << tracer.eventCount() << std::endl;
 }
 
 void RoutingDaemon::showTrafficOptimizationStats() const
@@ -757,13 +1171,26 @@ void RoutingDaemon::showTrafficOptimizationStats() const
     std::cout << "Total bytes sent: " << stats.totalBytesSent << " bytes" << std::endl;
     std::cout << "Total bytes received: " << stats.totalBytesReceived << " bytes" << std::endl;
     std::cout << "Compressed messages: " << stats.compressedMessages << std::endl;
-    std::cout << "Differential messages: " << stats.differentialMessages << std::endl;
     std::cout << "Full messages: " << stats.fullMessages << std::endl;
+    std::cout << "LSA retransmissions: " << stats.retransmissions << std::endl;
+    std::cout << "LS acks sent/received: " << stats.acksSent << "/" << stats.acksReceived << std::endl;
+    std::cout << "LSAs requested after DB description: " << stats.lsaRequests << std::endl;
+    std::cout << "LSA wire cache hits/misses: " << stats.wireCacheHits << "/" << stats.wireCacheMisses << std::endl;
+    auto depths = pm->getScheduler().getQueueDepths();
+    std::cout << "Transmit queues (hello/control/update/bulk): " << depths[0] << "/" << depths[1] << "/"
+              << depths[2] << "/" << depths[3] << ", dropped: " << pm->getScheduler().getDropped() << std::endl;
+    std::cout << "Sends skipped (neighbor already has LSA): " << stats.sendsSkipped
+              << ", tracked instances: " << pm->getKnownInstanceCount() << std::endl;
+    if (floodingTopology)
+    {
+        std::cout << "Flooding topology edges: " << floodingTopology->edgeCount()
+                  << ", relays suppressed: " << stats.relaysSuppressed << std::endl;
+    }
 
     if (stats.fullMessages > 0)
     {
-        double compressionRatio = (double)(stats.compressedMessages + stats.differentialMessages) /
-                                  (stats.fullMessages + stats.compressedMessages + stats.differentialMessages) * 100;
+        double compressionRatio = (double)stats.compressedMessages /
+                                  (stats.fullMessages + stats.compressedMessages) * 100;
         std::cout << "Optimization ratio: " << std::fixed << std::setprecision(1)
                   << compressionRatio << "%" << std::endl;
     }
@@ -774,8 +1201,14 @@ void RoutingDaemon::showTrafficOptimizationStats() const
     {
         int interval = lsm->getAdaptiveHelloInterval(neighbor);
         bool stable = lsm->isNeighborStable(neighbor);
+        auto link = linkMetrics->getReport(neighbor);
         std::cout << "  " << neighbor << ": interval=" << interval
-                  << "s, stable=" << (stable ? "Yes" : "No") << std::endl;
+                  << "s, stable=" << (stable ? "Yes" : "No")
+                  << ", retransmit=" << pm->getRetransmitQueueSize(neighbor)
+                  << ", iface=" << link.ifName << ", speed=" << link.speedMbps << "Mbps"
+                  << ", srtt=" << std::fixed << std::setprecision(2) << link.srttMs << "ms"
+                  << ", loss=" << std::setprecision(1) << link.lossRate * 100 << "%"
+                  << ", cost=" << link.cost << std::endl;
     }
     std::cout << "=======================================" << std::endl;
 }
@@ -790,31 +1223,33 @@ void RoutingDaemon::resetOptimizationStats()
 
 void RoutingDaemon::recordTopologyChange()
 {
-    lastTopologyChangeTime = std::chrono::steady_clock::now();
+    auto now = timers->now();
+    std::lock_guard<std::mutex> lock(convergenceMutex);
+    lastTopologyChangeTime = now;
     hasConverged = false;
 }
 
 void RoutingDaemon::checkConvergence()
 {
-    if (hasConverged)
-        return;
+    auto now = timers->now();
+    std::lock_guard<std::mutex> lock(convergenceMutex);
 
-    auto now = std::chrono::steady_clock::now();
-
-    // Critères de convergence : pas de changement depuis X secondes
-    auto timeSinceLastChange = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now - lastTopologyChangeTime);
+    // Aucun changement de table depuis le démarrage : rien à mesurer
+    if (hasConverged || episodeStartNs == 0)
+        return;
 
-    // Considérer comme convergé si stable depuis 10 secondes
-    if (timeSinceLastChange >= std::chrono::milliseconds(10000))
+    // Épisode clos quand la table n'a plus changé depuis CONVERGENCE_STABLE_TIME
+    if (now - lastTopologyChangeTime >= CONVERGENCE_STABLE_TIME)
     {
         hasConverged = true;
         lastConvergenceTime = now;
         convergenceCount++;
 
-        // Calculer le temps de convergence depuis le dernier changement
+        // Durée réelle : de la première origination du LSA déclencheur au dernier changement du FIB,
+        // fenêtre de stabilité exclue
         auto convergenceTime = std::chrono::duration_cast<std::chrono::milliseconds>(
-            lastConvergenceTime - lastTopologyChangeTime);
+            std::chrono::nanoseconds(std::max<int64_t>(lastRouteChangeNs - episodeStartNs, 0)));
+        episodeStartNs = 0;
         convergenceTimes.push_back(convergenceTime);
 
         // Garder seulement les 10 derniers temps de convergence
@@ -825,7 +1260,7 @@ void RoutingDaemon::checkConvergence()
     }
 }
 
-double RoutingDaemon::getAverageConvergenceTime() const
+double RoutingDaemon::getAverageConvergenceTimeLocked() const
 {
     if (convergenceTimes.empty())
         return 0.0;
@@ -2,20 +2,55 @@
 #include "LinkStateManager.hpp"
 #include "PacketManager.hpp"
 #include "TopologyDatabase.hpp"
+#include "NextHopResolver.hpp"
+#include "TimerWheel.hpp"
+#include "BfdManager.hpp"
+#include "EventQueue.hpp"
+#include "LinkMetrics.hpp"
+#include "Ipv4Prefix.hpp"
+#include "FloodingTopology.hpp"
+#include "Metrics.hpp"
+#include "MetricsServer.hpp"
+#include "Transport.hpp"
+#include "FibBackend.hpp"
+#include "ProtocolClock.hpp"
+#include "PacketCapture.hpp"
+#include "Tracer.hpp"
 #include <atomic>
 #include <thread>
 #include <memory>
+#include <deque>
+#include <functional>
+#include <mutex>
 
 class RoutingDaemon
 {
 public:
     RoutingDaemon(const std::string &configFile);
+    // Transport et plan de transfert injectables (simulateur) ; nullptr : UDP et noyau
+    explicit RoutingDaemon(const RouterConfig &config, std::unique_ptr<Transport> transport = nullptr,
+                           std::unique_ptr<FibBackend> fib = nullptr,
+                           const ProtocolClock &clock = ProtocolClock::steady());
     ~RoutingDaemon();
 
-    bool start();
+    // Threaded : un réacteur (réception, temporisations, événements) et le thread d'émission.
+    // Stepped : aucun thread, le propriétaire appelle step() en avançant l'horloge (simulateur).
+    // Dans les deux modes, le même pas traite tout ce qui est prêt puis rend son prochain instant.
+    enum class ExecutionMode
+    {
+        Threaded,
+        Stepped
+    };
+
+    bool start(ExecutionMode mode = ExecutionMode::Threaded);
     void stop();
     bool isRunning() const;
 
+    // Mode Stepped : datagrammes arrivés, temporisations échues et événements à l'instant de l'horloge
+    void step();
+    // Prochain instant où step() a du travail en l'absence de nouveau datagramme
+    ProtocolClock::time_point nextDeadline() const;
+
     std::vector<std::string> getActiveNeighbors() const;
     std::vector<std::string> getActiveNeighborHostnames() const;
     void getStatus() const;
@@ -26,37 +61,163 @@ public:
     void showRoutingMetrics() const;
     void showRoutingTable() const;
     void showTrafficOptimizationStats() const;
-    int getAdaptiveSleepTime() const;
     void resetOptimizationStats();
 
+    // Capture des datagrammes reçus (rejeu hors ligne : bench/PacketReplay.cpp)
+    bool startCapture(const std::string &path);
+    void stopCapture();
+    void showCaptureStatus() const;
+
+    // Spans par phase de la boucle principale, par paquet reçu et par opération FIB (Chrome/Perfetto)
+    void setTracing(bool on);
+    bool dumpTrace(const std::string &path) const;
+    void showTraceStatus() const;
+    Tracer &getTracer() { return tracer; }
+
+    // Parcours d'une instance de LSA inondée, horodaté par ProtocolClock::traceNanos() : origination
+    // (routeur d'origine), acceptation dans la LSDB, fin de la SPF et fin de la programmation du FIB
+    struct LsaPropagation
+    {
+        std::string origin;
+        std::string traceId;
+        int64_t originatedNs = 0;
+        int64_t acceptedNs = 0;
+        int64_t spfNs = 0;
+        int64_t fibNs = 0;
+    };
+    // Appelé par le thread principal du démon après chaque SPF, pour chaque instance mesurée
+    void setPropagationObserver(std::function<void(const LsaPropagation &)> observer);
+
 private:
-    void runDaemon();
-    void mainLoop();
+    static constexpr std::chrono::seconds DISCOVERY_INTERVAL{30};
+
+    // Aucune échéance (ni temporisation, ni origination différée, ni convergence) : attente de principe
+    static constexpr std::chrono::hours IDLE_WAIT{1};
+
+    // Mode Threaded : step(), puis attente du transport jusqu'à nextDeadline() ou un réveil
+    void runReactor();
+    void runOnce();
+    // Réveille le réacteur s'il dort au-delà de 'due' (temporisation armée, événement d'un autre thread)
+    void wakeReactor(ProtocolClock::time_point due);
+    // Origination limitée et SPF après traitement des événements
+    void processPending();
+    // Prochain passage sans événement ni temporisation (origination différée, fin de convergence)
+    ProtocolClock::time_point eventDeadline() const;
+
+    struct DaemonEvent
+    {
+        enum class Type
+        {
+            NeighborStateChanged,
+            LsdbChanged,
+            SelfLSAReceived,
+            LsaMaxAged,
+            RefreshLSA,
+            LinkCostChanged
+        };
+        Type type = Type::LsdbChanged;
+        NeighborEvent neighbor{};
+        int sequence = 0;   // SelfLSAReceived : séquence de l'instance reçue
+        std::string origin{}; // LsaMaxAged : origine du LSA à purger
+        bool bfdDown = false; // NeighborStateChanged : session BFD tombée, retrait à faire par le réacteur
+    };
+
+    void handleEvent(const DaemonEvent &event);
+    void synchronizeNeighbor(const std::string &neighborIp);
+    void originateLSA();
+    void flushSelfLSA();
+    void updateRoutes();
+    // Horodatage d'origination et identifiant de trace d'une nouvelle instance de notre LSA
+    void stampOrigination(nlohmann::json &lsa) const;
+    void recordPropagation(const std::vector<TopologyDatabase::AcceptedLSA> &accepted, int64_t spfNs,
+                           int64_t fibNs, bool routingTableChanged);
+
+    // Intervalle minimal entre deux originations de notre LSA (anti-rafale)
+    static constexpr std::chrono::milliseconds MIN_LS_INTERVAL{1000};
+    // Réorigination périodique de notre LSA, bien avant TopologyDatabase::MAX_AGE
+    static constexpr std::chrono::seconds LS_REFRESH_TIME{1800};
+
+    EventQueue<DaemonEvent> events;
+    bool lsaPending = false;
+    int lsaSequence = 0;
+    TimerWheel::TimerId refreshTimer = TimerWheel::INVALID_TIMER;
+    std::chrono::steady_clock::time_point lastOriginationTime;
+    uint64_t lastSpfGeneration = 0;
 
     std::string hostname;
     std::vector<std::string> interfaces;
+    std::vector<Ipv4Prefix> summaryRanges;
     int port;
 
+    MetricsRegistry metrics; // Doit survivre à tous les composants qui y ont inscrit des compteurs
+    Tracer tracer;           // Doit survivre à pm
+    Counter *spfRuns = nullptr;
+    Counter *lsaOriginations = nullptr;
+    Counter *fibAdds = nullptr;
+    Counter *fibDeletes = nullptr;
+    Counter *fibFailures = nullptr;
+    LatencyHistogram *spfLatency = nullptr;
+    LatencyHistogram *fibAddLatency = nullptr;
+    LatencyHistogram *fibDeleteLatency = nullptr;
+    std::vector<std::pair<std::string, LatencyHistogram *>> packetLatencies; // Étapes de PacketManager
+    LatencyHistogram *propagationAccepted = nullptr;
+    LatencyHistogram *propagationSpf = nullptr;
+    LatencyHistogram *propagationFib = nullptr;
+    void registerMetrics();
+    static RouterConfig loadConfig(const std::string &configFile);
+
+    std::unique_ptr<Transport> transport; // Doit survivre à pm
+    std::unique_ptr<FibBackend> fib;
+    std::map<std::string, std::string> lastRoutingTable; // Dernière table appliquée au FIB
+    bool firstRoutingRun = true;
+
+    std::unique_ptr<TimerWheel> timers; // Doit survivre à lsm et pm (callbacks)
+    std::unique_ptr<PacketCapture> capture; // Doit survivre à pm
+    std::string capturePath;                // Capture démarrée avec le démon (config 'capture')
     std::unique_ptr<LinkStateManager> lsm;
     std::unique_ptr<PacketManager> pm;
     std::unique_ptr<TopologyDatabase> topoDb;
+    std::unique_ptr<NextHopResolver> resolver;
+    std::unique_ptr<BfdManager> bfd; // nullptr si bfd=off
+    std::unique_ptr<LinkMetrics> linkMetrics;
+    std::unique_ptr<FloodingTopology> floodingTopology; // nullptr si floodReduction=off
+    std::unique_ptr<MetricsServer> metricsServer;       // nullptr si metrics=off
 
     std::atomic<bool> running;
-    std::thread daemonThread;
-    std::thread receiverThread;
+    bool stepped = false;
+    std::thread reactorThread;
+    // Échéance de l'attente en cours du réacteur ; min() quand il travaille (aucun réveil utile)
+    std::atomic<ProtocolClock::time_point> sleepingUntil{ProtocolClock::time_point::min()};
 
-    std::vector<double> getLinkCapabilities() const;
-    std::vector<bool> getLinkStates() const;
+    std::vector<double> getLinkCapabilities(const std::vector<std::string> &neighborIps) const;
+    std::vector<int> getLinkCosts(const std::vector<std::string> &neighborIps) const;
+    std::vector<bool> getLinkStates(const std::vector<std::string> &neighborIps) const;
 
     std::chrono::steady_clock::time_point networkStartTime;
+    // Écrits par le réacteur sous convergenceMutex, lus sous ce verrou par la CLI
+    mutable std::mutex convergenceMutex;
     std::chrono::steady_clock::time_point lastConvergenceTime;
     std::chrono::steady_clock::time_point lastTopologyChangeTime;
     bool hasConverged = false;
     int convergenceCount = 0;
     std::vector<std::chrono::milliseconds> convergenceTimes;
 
+    // Table stable depuis ce délai : épisode de convergence clos
+    static constexpr std::chrono::seconds CONVERGENCE_STABLE_TIME{10};
+    // Un épisode court de la plus ancienne origination qui l'a déclenché au dernier changement du FIB
+    int64_t startTraceNs = 0;       // Instances antérieures au démarrage : resynchronisation, non mesurées
+    int64_t episodeStartNs = 0;     // 0 : aucun épisode en cours
+    int64_t lastRouteChangeNs = 0;
+    int64_t pendingOriginNs = 0;    // Plus ancienne origination acceptée sans changement de table
+    int64_t pendingAcceptedNs = 0;
+
+    static constexpr size_t RECENT_PROPAGATIONS = 10;
+    std::function<void(const LsaPropagation &)> propagationObserver;
+    mutable std::mutex propagationMutex; // recentPropagations (affichage depuis la CLI)
+    std::deque<LsaPropagation> recentPropagations;
+
     // Méthodes pour les métriques de convergence
     void recordTopologyChange();
     void checkConvergence();
-    double getAverageConvergenceTime() const;
+    double getAverageConvergenceTimeLocked() const;
 };
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "TimerWheel.hpp"
+
+TimerWheel::TimerWheel(const ProtocolClock &clock, std::chrono::milliseconds tick, size_t slotCount)
+    : clock(clock), tickDuration(tick), slots(slotCount), origin(clock.now())
+{
+}
+
+TimerWheel::~TimerWheel() = default;
+
+uint64_t TimerWheel::tickFor(Clock::time_point when) const
+{
+    if (when <= origin)
+        return 0;
+    return static_cast<uint64_t>((when - origin) / tickDuration);
+}
+
+uint64_t TimerWheel::expiryTickFor(Clock::time_point due) const
+{
+    // Mesuré depuis l'horloge, pas depuis currentTick : la roue n'avance qu'aux appels d'advance(),
+    // une temporisation armée après une période d'inactivité expirerait en avance d'autant.
+    // Arrondi au tick supérieur : une temporisation n'expire jamais en avance ; après currentTick,
+    // sinon son seau est déjà dépassé et elle attendrait un tour de roue.
+    uint64_t ticks = due <= origin ? 0 : static_cast<uint64_t>((due - origin + tickDuration - Clock::duration(1)) / tickDuration);
+    return std::max(ticks, currentTick + 1);
+}
+
+void TimerWheel::insert(Entry &&entry)
+{
+    size_t slotIndex = entry.expiryTick % slots.size();
+    TimerId id = entry.id;
+    auto &slot = slots[slotIndex];
+    slot.push_back(std::move(entry));
+    timers[id] = {slotIndex, std::prev(slot.end())};
+}
+
+TimerWheel::TimerId TimerWheel::schedule(std::chrono::milliseconds delay, Callback callback)
+{
+    TimerId id;
+    uint64_t expiryTick;
+    auto due = clock.now() + delay;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        expiryTick = expiryTickFor(due);
+        Entry entry{nextId++, expiryTick, std::move(callback)};
+        id = entry.id;
+        insert(std::move(entry));
+    }
+    if (scheduleHandler)
+        scheduleHandler(origin + tickDuration * expiryTick);
+    return id;
+}
+
+bool TimerWheel::cancel(TimerId id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = timers.find(id);
+    if (it == timers.end())
+        return false;
+
+    slots[it->second.first].erase(it->second.second);
+    timers.erase(it);
+    return true;
+}
+
+bool TimerWheel::restart(TimerId id, std::chrono::milliseconds delay)
+{
+    uint64_t expiryTick;
+    auto due = clock.now() + delay;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = timers.find(id);
+        if (it == timers.end())
+            return false;
+
+        Entry entry = std::move(*it->second.second);
+        slots[it->second.first].erase(it->second.second);
+
+        expiryTick = expiryTickFor(due);
+        entry.expiryTick = expiryTick;
+        insert(std::move(entry));
+    }
+    if (scheduleHandler)
+        scheduleHandler(origin + tickDuration * expiryTick);
+    return true;
+}
+
+void TimerWheel::advance(Clock::time_point now)
+{
+    uint64_t targetTick = tickFor(now);
+    std::vector<Callback> expired;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (currentTick < targetTick)
+        {
+            ++currentTick;
+            auto &slot = slots[currentTick % slots.size()];
+            for (auto it = slot.begin(); it != slot.end();)
+            {
+                if (it->expiryTick <= currentTick)
+                {
+                    expired.push_back(std::move(it->callback));
+                    timers.erase(it->id);
+                    it = slot.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    for (auto &callback : expired)
+    {
+        callback();
+    }
+}
+
+std::optional<TimerWheel::Clock::time_point> TimerWheel::nextExpiry() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (timers.empty())
+        return std::nullopt;
+
+    // Tour de roue à venir, seau par seau : pas de parcours de toutes les temporisations à chaque
+    // attente du réacteur quand l'échéance est proche (Hello, retransmissions, acks différés)
+    for (uint64_t tick = currentTick + 1; tick <= currentTick + slots.size(); tick++)
+    {
+        for (const auto &entry : slots[tick % slots.size()])
+        {
+            if (entry.expiryTick <= tick)
+                return origin + tickDuration * tick;
+        }
+    }
+
+    uint64_t earliest = UINT64_MAX;
+    for (const auto &[id, location] : timers)
+    {
+        earliest = std::min(earliest, location.second->expiryTick);
+    }
+    return origin + tickDuration * earliest;
+}
+
+size_t TimerWheel::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return timers.size();
+}
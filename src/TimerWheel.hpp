@@ -0,0 +1,76 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <list>
+#include <mutex>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "ProtocolClock.hpp"
+
+// Roue de temporisation hachée : insertion, annulation et réarmement en O(1).
+// Les temporisations plus longues qu'un tour de roue gardent un compteur de tours.
+// La roue n'a pas de thread : son propriétaire appelle advance() à l'échéance donnée par
+// nextExpiry() (réacteur du démon, exécution pas à pas) ; les callbacks s'y exécutent, hors verrou.
+class TimerWheel
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = uint64_t;
+    using Callback = std::function<void()>;
+
+    static constexpr TimerId INVALID_TIMER = 0;
+
+    explicit TimerWheel(const ProtocolClock &clock = ProtocolClock::steady(),
+                        std::chrono::milliseconds tick = std::chrono::milliseconds(10),
+                        size_t slotCount = 512);
+    ~TimerWheel();
+
+    TimerId schedule(std::chrono::milliseconds delay, Callback callback);
+    bool cancel(TimerId id);
+    // Réarme une temporisation existante ; false si elle a déjà expiré ou été annulée
+    bool restart(TimerId id, std::chrono::milliseconds delay);
+
+    // Traite tous les ticks échus jusqu'à 'now'
+    void advance(Clock::time_point now);
+    // Échéance de la prochaine temporisation armée
+    std::optional<Clock::time_point> nextExpiry() const;
+    // Appelé hors verrou avec l'échéance de chaque temporisation armée ou réarmée, depuis le thread
+    // appelant : réveil du propriétaire endormi jusqu'à une échéance plus tardive. Fixé avant usage.
+    void setScheduleHandler(std::function<void(Clock::time_point)> handler) { scheduleHandler = std::move(handler); }
+
+    // Temps protocolaire partagé par les composants qui utilisent cette roue
+    Clock::time_point now() const { return clock.now(); }
+    const ProtocolClock &getClock() const { return clock; }
+
+    size_t size() const;
+
+private:
+    struct Entry
+    {
+        TimerId id;
+        uint64_t expiryTick;
+        Callback callback;
+    };
+
+    using Slot = std::list<Entry>;
+
+    uint64_t tickFor(Clock::time_point when) const;
+    // Sous le verrou : premier tick à partir duquel advance() peut déclencher l'échéance 'due'
+    uint64_t expiryTickFor(Clock::time_point due) const;
+    void insert(Entry &&entry);
+
+    const ProtocolClock &clock;
+    const std::chrono::milliseconds tickDuration;
+    std::vector<Slot> slots;
+    std::unordered_map<TimerId, std::pair<size_t, Slot::iterator>> timers;
+
+    Clock::time_point origin;
+    uint64_t currentTick = 0;
+    TimerId nextId = 1;
+
+    mutable std::mutex mutex;
+    std::function<void(Clock::time_point)> scheduleHandler;
+};
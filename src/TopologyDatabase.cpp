@@ -0,0 +1,139 @@
+#include "TopologyDatabase.hpp"
+
+using json = nlohmann::json;
+
+static uint64_t fnv1a(const std::string &data)
+{
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : data)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t TopologyDatabase::checksumOf(const json &lsa)
+{
+    json content = lsa;
+    content.erase("age");
+    content.erase("type");
+    content.erase("hmac");
+
+    // FNV-1a 64 bits sur la sérialisation (clés triées par nlohmann::json)
+    return fnv1a(content.dump());
+}
+
+size_t TopologyDatabase::digestBucket(const std::string &origin)
+{
+    return fnv1a(origin) % DIGEST_LEAVES;
+}
+
+// Mélange splitmix64 : un sous-arbre vide reste à 0
+static uint64_t mixDigest(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+uint64_t TopologyDatabase::combineDigest(uint64_t left, uint64_t right)
+{
+    if (left == 0 && right == 0)
+        return 0;
+    return mixDigest(left ^ mixDigest(right));
+}
+
+void TopologyDatabase::updateDigest(const std::string &host, uint64_t delta)
+{
+    // Appelé sous lsaMutex : feuille puis chemin jusqu'à la racine
+    size_t index = DIGEST_LEAVES + digestBucket(host);
+    digestTree[index] ^= delta;
+    for (index /= 2; index >= 1; index /= 2)
+    {
+        digestTree[index] = combineDigest(digestTree[2 * index], digestTree[2 * index + 1]);
+    }
+}
+
+void TopologyDatabase::scheduleAging(const std::string &host, const json &lsa)
+{
+    // Appelé sous lsaMutex
+    LsaAging &entry = aging[host];
+    if (entry.timer != TimerWheel::INVALID_TIMER)
+        timers.cancel(entry.timer);
+
+    int age = std::min<int>(std::max(ageOf(lsa), 0), MAX_AGE.count());
+    int sequence = lsa["sequence_number"];
+    entry.installed = timers.now();
+    entry.ageAtInstall = age;
+    entry.checksum = checksumOf(lsa);
+
+    // Empreinte (origine, séquence, MaxAge, contenu) ; XOR : retrait de l'ancienne instance en O(1)
+    uint64_t state = static_cast<uint64_t>(static_cast<uint32_t>(sequence)) << 1 | (age >= MAX_AGE.count());
+    uint64_t digest = mixDigest(fnv1a(host) ^ mixDigest(entry.checksum ^ mixDigest(state)));
+    updateDigest(host, entry.digest ^ digest);
+    entry.digest = digest;
+
+    if (age >= MAX_AGE.count())
+    {
+        entry.timer = timers.schedule(MAX_AGE_HOLD, [this, host, sequence]()
+                                      { removeMaxAgeLSA(host, sequence); });
+    }
+    else
+    {
+        entry.timer = timers.schedule(MAX_AGE - std::chrono::seconds(age), [this, host, sequence]()
+                                      { expireLSA(host, sequence); });
+    }
+}
+
+int TopologyDatabase::currentAge(const std::string &host) const
+{
+    // Appelé sous lsaMutex
+    auto it = aging.find(host);
+    if (it == aging.end())
+        return 0;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+        timers.now() - it->second.installed);
+    return std::min<int>(it->second.ageAtInstall + elapsed.count(), MAX_AGE.count());
+}
+
+void TopologyDatabase::expireLSA(const std::string &host, int sequence)
+{
+    {
+        std::lock_guard<std::mutex> lock(lsaMutex);
+        auto it = lsaMap.find(host);
+        // Remplacé entre-temps par une instance plus récente
+        if (it == lsaMap.end() || it->second["sequence_number"] != sequence || isMaxAge(it->second))
+            return;
+
+        it->second["age"] = MAX_AGE.count();
+        scheduleAging(host, it->second);
+        generation.fetch_add(1, std::memory_order_release);
+    }
+
+    if (onChange)
+        onChange();
+    if (onMaxAge)
+        onMaxAge(host);
+}
+
+void TopologyDatabase::removeMaxAgeLSA(const std::string &host, int sequence)
+{
+    {
+        std::lock_guard<std::mutex> lock(lsaMutex);
+        auto it = lsaMap.find(host);
+        if (it == lsaMap.end() || it->second["sequence_number"] != sequence || !isMaxAge(it->second))
+            return;
+
+        lsaMap.erase(it);
+        updateDigest(host, aging[host].digest);
+        aging.erase(host);
+        generation.fetch_add(1, std::memory_order_release);
+    }
+
+    // Comme toute modification de la LSDB : nouvelle SPF sans attendre un autre changement
+    if (onChange)
+        onChange();
+}
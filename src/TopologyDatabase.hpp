@@ -5,33 +5,278 @@
 #include "../include/json.hpp"
 #include <iostream>
 #include "RoutingTable.hpp"
+#include "Ipv4Prefix.hpp"
+#include "LinkMetrics.hpp"
+#include "TimerWheel.hpp"
+#include "Logger.hpp"
 #include <set>
 #include <queue>
 #include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 
 class TopologyDatabase
 {
+public:
+    // Vieillissement des LSA (RFC 2328 §14) : retirés de la SPF à MaxAge puis purgés
+    static constexpr std::chrono::seconds MAX_AGE{3600};
+    static constexpr std::chrono::seconds MAX_AGE_HOLD{60}; // Conservation du LSA MaxAge le temps de l'inonder
+    static constexpr size_t DIGEST_LEAVES = 256;
+
+    // Instance tracée (trace_id, originated_ns posés par l'origine) acceptée dans la LSDB
+    struct AcceptedLSA
+    {
+        std::string origin;
+        std::string traceId;
+        int64_t originatedNs = 0;
+        int64_t acceptedNs = 0; // ProtocolClock::traceNanos() à l'installation
+        int age = 0;            // Âge reçu : > 0 pour une instance resynchronisée plutôt qu'inondée
+    };
+
 private:
     mutable std::mutex lsaMutex;
+    std::atomic<uint64_t> generation{0}; // Incrémenté à chaque modification de la LSDB
+    std::function<void()> onChange;
+    std::function<void(const std::string &)> onMaxAge;
+
+    // Une temporisation par origine sur la roue : pas de balayage périodique de la LSDB
+    struct LsaAging
+    {
+        std::chrono::steady_clock::time_point installed;
+        int ageAtInstall = 0;
+        uint64_t checksum = 0;
+        uint64_t digest = 0; // Contribution à la feuille de l'arbre de hachage
+        TimerWheel::TimerId timer = TimerWheel::INVALID_TIMER;
+    };
+    TimerWheel &timers;
+    std::unordered_map<std::string, LsaAging> aging;
+
+    // Arbre de hachage en tas (racine = 1, feuilles = [DIGEST_LEAVES, 2 * DIGEST_LEAVES)).
+    // Feuille = XOR des empreintes (origine, séquence, contenu) de son seau : mise à jour
+    // incrémentale en O(log n) à chaque installation.
+    std::vector<uint64_t> digestTree = std::vector<uint64_t>(2 * DIGEST_LEAVES, 0);
+
+    // Instances tracées acceptées depuis le dernier takeAcceptedLSAs() (borné : rejeu sans SPF)
+    static constexpr size_t MAX_PENDING_ACCEPTED = 4096;
+    std::vector<AcceptedLSA> acceptedLSAs;
+
+    void scheduleAging(const std::string &host, const nlohmann::json &lsa);
+    void updateDigest(const std::string &host, uint64_t delta);
+    void expireLSA(const std::string &host, int sequence);
+    void removeMaxAgeLSA(const std::string &host, int sequence);
+    int currentAge(const std::string &host) const;
 
 public:
     std::unordered_map<std::string, nlohmann::json> lsaMap;
 
-    bool updateLSA(const nlohmann::json &lsa)
+    explicit TopologyDatabase(TimerWheel &timers) : timers(timers) {}
+
+    static int ageOf(const nlohmann::json &lsa)
+    {
+        return lsa.value("age", 0);
+    }
+
+    static bool isMaxAge(const nlohmann::json &lsa)
+    {
+        return ageOf(lsa) >= MAX_AGE.count();
+    }
+
+    // Empreinte 64 bits du contenu (hors âge, type et HMAC)
+    static uint64_t checksumOf(const nlohmann::json &lsa);
+
+    // Instance plus récente (RFC 2328 §13.1) : séquence, puis MaxAge, puis empreinte
+    static bool isNewer(int sequence, uint64_t checksum, bool maxAge,
+                        int otherSequence, uint64_t otherChecksum, bool otherMaxAge)
+    {
+        if (sequence != otherSequence)
+            return sequence > otherSequence;
+        if (maxAge != otherMaxAge)
+            return maxAge;
+        return checksum > otherChecksum;
+    }
+
+    static bool isNewer(const nlohmann::json &lsa, const nlohmann::json &other)
+    {
+        int seq = lsa.value("sequence_number", 0);
+        int otherSeq = other.value("sequence_number", 0);
+        if (seq != otherSeq || isMaxAge(lsa) != isMaxAge(other))
+            return isNewer(seq, 0, isMaxAge(lsa), otherSeq, 0, isMaxAge(other));
+        return checksumOf(lsa) > checksumOf(other);
+    }
+
+    // En-tête échangé dans les descriptions de base (DB_DESCRIPTION)
+    struct LsaHeader
+    {
+        std::string origin;
+        int sequence = 0;
+        uint64_t checksum = 0;
+        int age = 0;
+    };
+
+    std::vector<LsaHeader> getHeaders() const
+    {
+        std::lock_guard<std::mutex> lock(lsaMutex);
+        std::vector<LsaHeader> headers;
+        headers.reserve(lsaMap.size());
+        for (const auto &[host, lsa] : lsaMap)
+        {
+            auto it = aging.find(host);
+            headers.push_back({host, lsa["sequence_number"].get<int>(),
+                               it != aging.end() ? it->second.checksum : checksumOf(lsa), currentAge(host)});
+        }
+        return headers;
+    }
+
+    static size_t digestBucket(const std::string &origin);
+    static uint64_t combineDigest(uint64_t left, uint64_t right);
+
+    // Racine annoncée dans les HELLO : égale chez deux voisins synchronisés
+    size_t getLSACount() const
+    {
+        std::lock_guard<std::mutex> lock(lsaMutex);
+        return lsaMap.size();
+    }
+
+    uint64_t getDigestRoot() const
+    {
+        std::lock_guard<std::mutex> lock(lsaMutex);
+        return digestTree[1];
+    }
+
+    uint64_t getDigestNode(size_t index) const
+    {
+        std::lock_guard<std::mutex> lock(lsaMutex);
+        return index > 0 && index < digestTree.size() ? digestTree[index] : 0;
+    }
+
+    // En-têtes des LSA d'un seau (index de feuille de l'arbre)
+    std::vector<LsaHeader> getBucketHeaders(size_t leafIndex) const
+    {
+        std::vector<LsaHeader> headers;
+        if (leafIndex < DIGEST_LEAVES || leafIndex >= 2 * DIGEST_LEAVES)
+            return headers;
+
+        std::lock_guard<std::mutex> lock(lsaMutex);
+        for (const auto &[host, lsa] : lsaMap)
+        {
+            if (DIGEST_LEAVES + digestBucket(host) != leafIndex)
+                continue;
+            auto it = aging.find(host);
+            headers.push_back({host, lsa["sequence_number"].get<int>(),
+                               it != aging.end() ? it->second.checksum : checksumOf(lsa), currentAge(host)});
+        }
+        return headers;
+    }
+
+    // Vrai si l'en-tête annonce une instance absente ou plus récente que la nôtre
+    bool needsLSA(const LsaHeader &header) const
     {
         std::lock_guard<std::mutex> lock(lsaMutex);
+        bool headerMaxAge = header.age >= MAX_AGE.count();
+        auto it = lsaMap.find(header.origin);
+        if (it == lsaMap.end())
+            return !headerMaxAge;
 
-        if (lsa.contains("hostname") && lsa.contains("sequence_number"))
+        auto agingIt = aging.find(header.origin);
+        uint64_t checksum = agingIt != aging.end() ? agingIt->second.checksum : checksumOf(it->second);
+        return isNewer(header.sequence, header.checksum, headerMaxAge,
+                       it->second["sequence_number"].get<int>(), checksum, isMaxAge(it->second));
+    }
+
+    bool updateLSA(const nlohmann::json &lsa)
+    {
+        bool updated = false;
         {
-            const std::string &host = lsa["hostname"];
-            int seq = lsa["sequence_number"];
-            if (!lsaMap.count(host) || lsaMap[host]["sequence_number"] < seq)
+            std::lock_guard<std::mutex> lock(lsaMutex);
+
+            if (lsa.contains("hostname") && lsa.contains("sequence_number"))
             {
-                lsaMap[host] = lsa;
-                return true;
+                const std::string &host = lsa["hostname"];
+                auto it = lsaMap.find(host);
+                // Un LSA MaxAge inconnu n'a rien à purger
+                bool accept = it == lsaMap.end() ? !isMaxAge(lsa) : isNewer(lsa, it->second);
+                if (accept)
+                {
+                    lsaMap[host] = lsa;
+                    scheduleAging(host, lsa);
+                    if (lsa.contains("trace_id") && acceptedLSAs.size() < MAX_PENDING_ACCEPTED)
+                    {
+                        acceptedLSAs.push_back({host, lsa.value("trace_id", ""), lsa.value("originated_ns", int64_t{0}),
+                                                timers.getClock().traceNanos(), ageOf(lsa)});
+                    }
+                    generation.fetch_add(1, std::memory_order_release);
+                    updated = true;
+                }
             }
         }
-        return false;
+
+        if (updated && onChange)
+        {
+            onChange();
+        }
+        return updated;
+    }
+
+    // Copie de l'instance courante du LSA d'une origine
+    bool getLSA(const std::string &host, nlohmann::json &out) const
+    {
+        std::lock_guard<std::mutex> lock(lsaMutex);
+        auto it = lsaMap.find(host);
+        if (it == lsaMap.end())
+            return false;
+        out = it->second;
+        out["age"] = currentAge(host);
+        return true;
+    }
+
+    // Copies de tous les LSA, âge courant inclus
+    std::vector<nlohmann::json> snapshotLSAs() const
+    {
+        std::lock_guard<std::mutex> lock(lsaMutex);
+        std::vector<nlohmann::json> lsas;
+        lsas.reserve(lsaMap.size());
+        for (const auto &[host, lsa] : lsaMap)
+        {
+            lsas.push_back(lsa);
+            lsas.back()["age"] = currentAge(host);
+        }
+        return lsas;
+    }
+
+    // Instances tracées acceptées depuis le dernier appel (propagation mesurée après la SPF)
+    std::vector<AcceptedLSA> takeAcceptedLSAs()
+    {
+        std::lock_guard<std::mutex> lock(lsaMutex);
+        return std::exchange(acceptedLSAs, {});
+    }
+
+    // Notifié (hors verrou) après chaque modification de la LSDB
+    void setChangeHandler(std::function<void()> handler)
+    {
+        onChange = std::move(handler);
+    }
+
+    // Notifié (hors verrou) quand un LSA atteint MaxAge, pour inonder la purge
+    void setMaxAgeHandler(std::function<void(const std::string &)> handler)
+    {
+        onMaxAge = std::move(handler);
+    }
+
+    uint64_t getGeneration() const
+    {
+        return generation.load(std::memory_order_acquire);
+    }
+
+    // Parcourt la LSDB sous verrou (fn(hostname, lsa))
+    template <typename Fn>
+    void forEachLSA(Fn &&fn) const
+    {
+        std::lock_guard<std::mutex> lock(lsaMutex);
+        for (const auto &[host, lsa] : lsaMap)
+        {
+            fn(host, lsa);
+        }
     }
 
     struct LinkInfo
@@ -46,19 +291,19 @@ public:
     {
         std::lock_guard<std::mutex> lock(lsaMutex);
 
-        for (const auto &[hostname, lsa] : lsaMap)
+        // Contenu de la LSDB à chaque SPF : niveau trace seulement, plus coûteux que la SPF elle-même
+        if (Logger::instance().isEnabled(Logger::Level::Trace))
         {
-            std::cout << "  " << hostname << ": seq=" << lsa["sequence_number"].get<int>();
-            if (lsa.contains("neighbors"))
+            for (const auto &[hostname, lsa] : lsaMap)
             {
-                std::cout << ", neighbors=[";
-                for (const auto &neighbor : lsa["neighbors"])
+                std::string neighbors;
+                for (const auto &neighbor : lsa.value("neighbors", nlohmann::json::array()))
                 {
-                    std::cout << neighbor.get<std::string>() << " ";
+                    neighbors += (neighbors.empty() ? "" : " ") + neighbor.get<std::string>();
                 }
-                std::cout << "]";
+                LOG_TRACE("spf", "%s: seq=%d, neighbors=[%s]", hostname.c_str(), lsa.value("sequence_number", 0),
+                          neighbors.c_str());
             }
-            std::cout << std::endl;
         }
 
         // Graphe: hostname -> voisins (vector<string>)
@@ -66,11 +311,15 @@ public:
 
         for (const auto &[hostname, lsa] : lsaMap)
         {
+            if (isMaxAge(lsa))
+                continue; // Purgé : ne participe plus au calcul
             if (lsa.contains("neighbors") && lsa.contains("link_capacities") && lsa.contains("link_states"))
             {
                 const auto &neighbors = lsa["neighbors"];
                 const auto &capacities = lsa["link_capacities"];
                 const auto &states = lsa["link_states"];
+                // Coûts mesurés si annoncés, sinon dérivés de la capacité (anciens LSA)
+                const bool hasCosts = lsa.contains("link_costs") && lsa["link_costs"].size() == neighbors.size();
 
                 for (size_t i = 0; i < neighbors.size(); ++i)
                 {
@@ -85,8 +334,8 @@ public:
                         if (!link.isActive)
                             continue;
 
-                        // Calculer le poids : inverse de la capacité + pénalité pour faible capacité
-                        link.weight = (1.0 / link.capacity) * 1000; // Normaliser
+                        link.weight = hasCosts ? lsa["link_costs"][i].get<double>()
+                                               : LinkMetrics::costForCapacity(link.capacity);
 
                         weightedGraph[hostname].push_back(link);
 
@@ -130,17 +379,38 @@ public:
             }
         }
 
-        std::set<std::string> localNetworks;
+        // Réseaux réellement connectés : "networks" peut ne porter que des agrégats
+        std::vector<Ipv4Prefix> localNetworks;
         auto it = lsaMap.find(selfHostname);
-        if (it != lsaMap.end() && it->second.contains("networks"))
+        if (it != lsaMap.end())
         {
-            for (const auto &net : it->second["networks"])
+            const auto &self = it->second;
+            auto addLocal = [&](const nlohmann::json &net)
+            {
+                Ipv4Prefix prefix;
+                if (net.is_string() && Ipv4Prefix::parse(net.get<std::string>(), prefix))
+                    localNetworks.push_back(prefix);
+            };
+            if (self.contains("network_interfaces"))
             {
-                localNetworks.insert(net);
+                for (const auto &iface : self["network_interfaces"])
+                    addLocal(iface.value("network", nlohmann::json()));
+            }
+            else if (self.contains("networks"))
+            {
+                for (const auto &net : self["networks"])
+                    addLocal(net);
             }
         }
+        // Préfixe qui recouvre un réseau connecté (inclus ou englobant) : la route connectée prime
+        auto overlapsLocal = [&](const Ipv4Prefix &prefix)
+        {
+            return std::any_of(localNetworks.begin(), localNetworks.end(), [&](const Ipv4Prefix &local)
+                               { return local.contains(prefix) || prefix.contains(local); });
+        };
 
         RoutingTable rt;
+        std::unordered_map<std::string, double> bestDistance; // Préfixe -> distance de l'annonceur retenu
         // for (const auto &[dest, distance] : dist)
         // {
         //     if (dest == selfHostname || distance == std::numeric_limits<double>::infinity())
@@ -156,11 +426,17 @@ public:
         // }
         for (const auto &[hostname, lsa] : lsaMap)
         {
-            if (lsa.contains("networks"))
+            if (lsa.contains("networks") && !isMaxAge(lsa))
             {
-                for (const auto &net : lsa["networks"])
+                for (const auto &netEntry : lsa["networks"])
                 {
-                    if (localNetworks.count(net) || hostname == selfHostname)
+                    // Forme canonique : les agrégats et les /24 passent par le même chemin
+                    Ipv4Prefix prefix;
+                    if (!netEntry.is_string() || !Ipv4Prefix::parse(netEntry.get<std::string>(), prefix))
+                        continue;
+                    const std::string net = prefix.toString();
+
+                    if (hostname == selfHostname || overlapsLocal(prefix))
                         continue;
 
                     if (dist.count(hostname) && dist.at(hostname) != std::numeric_limits<double>::infinity())
@@ -171,16 +447,14 @@ public:
                             hop = prev[hop];
                         }
 
-                        // ✅ DÉPARTAGE STABLE : Si route existe déjà, garder la lexicographiquement plus petite
-                        if (rt.table.count(net))
-                        {
-                            if (hop < rt.table[net])
-                            {
-                                rt.table[net] = hop;
-                            }
-                        }
-                        else
+                        // Réseau annoncé par plusieurs routeurs (lien de transit) : le plus proche
+                        // l'emporte, départage stable par next-hop à distance égale
+                        double distance = dist.at(hostname);
+                        auto best = bestDistance.find(net);
+                        if (best == bestDistance.end() || distance < best->second ||
+                            (distance == best->second && hop < rt.table[net]))
                         {
+                            bestDistance[net] = distance;
                             rt.table[net] = hop;
                         }
                     }
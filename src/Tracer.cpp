@@ -0,0 +1,146 @@
+#include "Tracer.hpp"
+#include <fstream>
+#include <pthread.h>
+#include <unordered_map>
+
+namespace
+{
+    std::atomic<uint64_t> nextTracerId{1};
+
+    int64_t toNanos(Tracer::Clock::time_point at)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(at.time_since_epoch()).count();
+    }
+}
+
+Tracer::ThreadBuffer::ThreadBuffer(size_t capacity, int tid, std::string threadName)
+    : capacity(capacity), events(new Event[capacity]), tid(tid), threadName(std::move(threadName))
+{
+}
+
+Tracer::Tracer(size_t eventsPerThread)
+    : id(nextTracerId.fetch_add(1)), eventsPerThread(std::max<size_t>(eventsPerThread, 1))
+{
+}
+
+Tracer::ThreadBuffer &Tracer::localBuffer()
+{
+    // Plusieurs démons par processus (simulateur) : un anneau par couple (traceur, thread)
+    thread_local std::unordered_map<uint64_t, ThreadBuffer *> cache;
+    auto it = cache.find(id);
+    if (it != cache.end())
+        return *it->second;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    char threadName[16] = {};
+    pthread_getname_np(pthread_self(), threadName, sizeof(threadName));
+    int tid = static_cast<int>(buffers.size()) + 1;
+    buffers.push_back(std::make_unique<ThreadBuffer>(
+        eventsPerThread, tid, threadName[0] ? threadName : "thread-" + std::to_string(tid)));
+    cache[id] = buffers.back().get();
+    return *buffers.back();
+}
+
+void Tracer::record(const char *category, const char *name, Clock::time_point start, Clock::time_point end,
+                    const char *argName, int64_t argValue)
+{
+    ThreadBuffer &buffer = localBuffer();
+    uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    Event &event = buffer.events[index % buffer.capacity];
+
+    // Verrou de séquence par case : le lecteur écarte une case modifiée pendant sa copie
+    event.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.category.store(category, std::memory_order_relaxed);
+    event.name.store(name, std::memory_order_relaxed);
+    event.argName.store(argName, std::memory_order_relaxed);
+    event.startNs.store(toNanos(start), std::memory_order_relaxed);
+    event.durationNs.store((end - start).count(), std::memory_order_relaxed);
+    event.argValue.store(argValue, std::memory_order_relaxed);
+    event.sequence.store(2 * index + 2, std::memory_order_release);
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &buffer : buffers)
+    {
+        buffer->floor.store(buffer->written.load());
+    }
+}
+
+size_t Tracer::eventCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const auto &buffer : buffers)
+    {
+        uint64_t written = buffer->written.load();
+        uint64_t first = std::max(buffer->floor.load(), written > buffer->capacity ? written - buffer->capacity : 0);
+        count += written - first;
+    }
+    return count;
+}
+
+void Tracer::appendChromeEvents(nlohmann::json &events, int pid, const std::string &processName) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!processName.empty())
+    {
+        events.push_back({{"name", "process_name"}, {"ph", "M"}, {"pid", pid}, {"args", {{"name", processName}}}});
+    }
+
+    for (const auto &buffer : buffers)
+    {
+        events.push_back({{"name", "thread_name"},
+                          {"ph", "M"},
+                          {"pid", pid},
+                          {"tid", buffer->tid},
+                          {"args", {{"name", buffer->threadName}}}});
+
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        uint64_t first = std::max(buffer->floor.load(), written > buffer->capacity ? written - buffer->capacity : 0);
+        for (uint64_t index = first; index < written; index++)
+        {
+            const Event &event = buffer->events[index % buffer->capacity];
+            uint64_t sequence = event.sequence.load(std::memory_order_acquire);
+            if (sequence != 2 * index + 2)
+                continue;
+            const char *category = event.category.load(std::memory_order_relaxed);
+            const char *name = event.name.load(std::memory_order_relaxed);
+            const char *argName = event.argName.load(std::memory_order_relaxed);
+            int64_t startNs = event.startNs.load(std::memory_order_relaxed);
+            int64_t durationNs = event.durationNs.load(std::memory_order_relaxed);
+            int64_t argValue = event.argValue.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (event.sequence.load(std::memory_order_relaxed) != sequence)
+                continue;
+
+            nlohmann::json entry = {{"name", name},
+                                    {"cat", category},
+                                    {"ph", "X"},
+                                    {"pid", pid},
+                                    {"tid", buffer->tid},
+                                    {"ts", startNs / 1000.0},
+                                    {"dur", durationNs / 1000.0}};
+            if (argName)
+            {
+                entry["args"] = {{argName, argValue}};
+            }
+            events.push_back(std::move(entry));
+        }
+    }
+}
+
+bool Tracer::dump(const std::string &path, const std::string &processName) const
+{
+    nlohmann::json events = nlohmann::json::array();
+    appendChromeEvents(events, 1, processName);
+
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    out << nlohmann::json{{"traceEvents", events}, {"displayTimeUnit", "ms"}}.dump();
+    return static_cast<bool>(out);
+}
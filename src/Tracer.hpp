@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../include/json.hpp"
+
+// Traçage par phases au format Chrome/Perfetto (chrome://tracing, ui.perfetto.dev). Chaque span
+// terminé occupe une case de l'anneau de son thread, écrit par ce seul thread sans verrou ; les plus
+// anciens sont écrasés. Le vidage (dump) relit les anneaux pendant l'écriture : une case en cours de
+// réécriture est ignorée (séquence par case). Désactivé, un span coûte une lecture atomique.
+// Horodatages en temps réel, comme LatencyTimer : on mesure le coût CPU, pas le temps protocolaire.
+class Tracer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t DEFAULT_EVENTS_PER_THREAD = 16384;
+
+    explicit Tracer(size_t eventsPerThread = DEFAULT_EVENTS_PER_THREAD);
+
+    void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    // Oublie les spans déjà enregistrés (les anneaux restent alloués)
+    void clear();
+
+    // Catégorie, nom et nom d'argument : chaînes statiques, seuls les pointeurs sont conservés
+    void record(const char *category, const char *name, Clock::time_point start, Clock::time_point end,
+                const char *argName = nullptr, int64_t argValue = 0);
+
+    // Événements complets ("X") et noms des threads ("M") ; pid fixé par l'appelant (un par routeur)
+    void appendChromeEvents(nlohmann::json &events, int pid, const std::string &processName) const;
+    bool dump(const std::string &path, const std::string &processName) const;
+    size_t eventCount() const;
+
+private:
+    struct Event
+    {
+        std::atomic<uint64_t> sequence{0}; // Impair : écriture en cours ; 2 * (index + 1) : case valide
+        std::atomic<const char *> category{nullptr};
+        std::atomic<const char *> name{nullptr};
+        std::atomic<const char *> argName{nullptr};
+        std::atomic<int64_t> startNs{0};
+        std::atomic<int64_t> durationNs{0};
+        std::atomic<int64_t> argValue{0};
+    };
+
+    struct ThreadBuffer
+    {
+        ThreadBuffer(size_t capacity, int tid, std::string threadName);
+
+        const size_t capacity;
+        std::unique_ptr<Event[]> events;
+        std::atomic<uint64_t> written{0};
+        std::atomic<uint64_t> floor{0}; // Premier index encore visible après clear()
+        const int tid;
+        const std::string threadName;
+    };
+
+    ThreadBuffer &localBuffer();
+
+    const uint64_t id; // Clé du cache par thread : jamais réutilisée, contrairement à une adresse
+    const size_t eventsPerThread;
+    std::atomic<bool> enabled{false};
+    mutable std::mutex mutex; // Liste des anneaux (ajout au premier span d'un thread, vidage)
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+// Span de la portée courante ; sans effet si le traceur est absent ou désactivé
+class TraceSpan
+{
+public:
+    TraceSpan(Tracer *tracer, const char *category, const char *name)
+        : tracer(tracer && tracer->isEnabled() ? tracer : nullptr), category(category), name(name)
+    {
+        if (this->tracer)
+            start = Tracer::Clock::now();
+    }
+
+    ~TraceSpan()
+    {
+        if (tracer)
+            tracer->record(category, name, start, Tracer::Clock::now(), argName, argValue);
+    }
+
+    void setArg(const char *argName, int64_t value)
+    {
+        this->argName = argName;
+        argValue = value;
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    Tracer *tracer;
+    const char *category;
+    const char *name;
+    const char *argName = nullptr;
+    int64_t argValue = 0;
+    Tracer::Clock::time_point start;
+};
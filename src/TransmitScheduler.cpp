@@ -0,0 +1,243 @@
+#include "TransmitScheduler.hpp"
+#include <algorithm>
+
+const char *const TransmitScheduler::CLASS_NAMES[PRIORITY_COUNT] = {"hello", "control", "update", "bulk"};
+
+TransmitScheduler::TransmitScheduler(Transport &transport, MetricsRegistry &metrics)
+    : transport(transport)
+{
+    for (size_t p = 0; p < PRIORITY_COUNT; ++p)
+    {
+        MetricsRegistry::Labels labels{{"class", CLASS_NAMES[p]}};
+        sentPackets[p] = &metrics.counter("ospf_tx_packets_total", "Datagrams sent, by transmit class", labels);
+        sentBytes[p] = &metrics.counter("ospf_tx_bytes_total", "Bytes sent, by transmit class", labels);
+        droppedPackets[p] = &metrics.counter("ospf_tx_dropped_total",
+                                             "Datagrams dropped on a full or stopping queue, by transmit class",
+                                             labels);
+    }
+    metrics.gaugeCollector("ospf_tx_queue_depth", "Datagrams waiting in the transmit queues, by class", [this]()
+                           {
+        auto depths = getQueueDepths();
+        std::vector<std::pair<MetricsRegistry::Labels, double>> samples;
+        for (size_t p = 0; p < PRIORITY_COUNT; ++p)
+        {
+            samples.push_back({{{"class", CLASS_NAMES[p]}}, static_cast<double>(depths[p])});
+        }
+        return samples; });
+}
+
+TransmitScheduler::~TransmitScheduler()
+{
+    stop();
+}
+
+bool TransmitScheduler::start()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running && !stopping)
+            return false;
+    }
+    // Vidage d'un arrêt précédent (finish) encore en cours : borné à DRAIN_TIMEOUT
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    running = true;
+    stopping = false;
+    worker = std::thread(&TransmitScheduler::run, this);
+    return true;
+}
+
+void TransmitScheduler::finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running)
+            return;
+        stopping = true;
+    }
+    cv.notify_all();
+}
+
+void TransmitScheduler::stop()
+{
+    finish();
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+}
+
+void TransmitScheduler::enqueue(const std::string &destIp, int port, std::string payload, Priority priority)
+{
+    enqueue(destIp, port, std::make_shared<const std::string>(std::move(payload)), priority);
+}
+
+void TransmitScheduler::enqueue(const std::string &destIp, int port,
+                                std::shared_ptr<const std::string> payload, Priority priority)
+{
+    Packet packet{destIp, port, std::move(payload), priority};
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (running && !stopping)
+        {
+            auto &queue = queues[static_cast<size_t>(priority)];
+            if (priority >= Priority::Update && queue.size() >= MAX_QUEUED_PER_CLASS)
+            {
+                droppedPackets[static_cast<size_t>(priority)]->inc();
+                return;
+            }
+            queue.push_back(std::move(packet));
+            lock.unlock();
+            cv.notify_one();
+            return;
+        }
+    }
+
+    // Ordonnanceur arrêté : envoi direct
+    transmit(packet);
+}
+
+bool TransmitScheduler::takeNext(Packet &out, std::chrono::steady_clock::duration &wait)
+{
+    auto now = std::chrono::steady_clock::now();
+    wait = std::chrono::steady_clock::duration::max();
+
+    for (size_t p = 0; p < PRIORITY_COUNT; ++p)
+    {
+        auto &queue = queues[p];
+        if (queue.empty())
+            continue;
+
+        // Hello et contrôle : jamais retardés
+        if (p < static_cast<size_t>(Priority::Update))
+        {
+            out = std::move(queue.front());
+            queue.pop_front();
+            return true;
+        }
+
+        // LSA : premier paquet dont la destination dispose de jetons (ordre FIFO par voisin)
+        size_t scanned = 0;
+        for (auto it = queue.begin(); it != queue.end() && scanned < MAX_PACING_SCAN; ++it, ++scanned)
+        {
+            auto [bucketIt, inserted] = buckets.try_emplace(it->destIp);
+            TokenBucket &bucket = bucketIt->second;
+            if (inserted)
+                bucket.lastRefill = now;
+
+            std::chrono::duration<double> elapsed = now - bucket.lastRefill;
+            bucket.tokens = std::min(PACING_BURST_BYTES, bucket.tokens + elapsed.count() * PACING_RATE_BYTES);
+            bucket.lastRefill = now;
+
+            double size = static_cast<double>(it->payload->size());
+            if (bucket.tokens >= size)
+            {
+                bucket.tokens -= size;
+                out = std::move(*it);
+                queue.erase(it);
+                return true;
+            }
+
+            auto refill = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>((size - bucket.tokens) / PACING_RATE_BYTES));
+            wait = std::min(wait, refill);
+        }
+    }
+    return false;
+}
+
+void TransmitScheduler::pruneBuckets(std::chrono::steady_clock::time_point now)
+{
+    // Sous verrou : seaux pleins et inactifs, au plus une fois par IDLE_BUCKET_TIMEOUT
+    if (now - lastPrune < IDLE_BUCKET_TIMEOUT)
+        return;
+    lastPrune = now;
+
+    for (auto it = buckets.begin(); it != buckets.end();)
+    {
+        if (now - it->second.lastRefill >= IDLE_BUCKET_TIMEOUT)
+            it = buckets.erase(it);
+        else
+            ++it;
+    }
+}
+
+void TransmitScheduler::run()
+{
+    std::chrono::steady_clock::time_point drainDeadline{};
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        if (stopping && drainDeadline == std::chrono::steady_clock::time_point{})
+            drainDeadline = std::chrono::steady_clock::now() + DRAIN_TIMEOUT;
+        if (stopping && std::chrono::steady_clock::now() >= drainDeadline)
+            break;
+
+        Packet packet;
+        std::chrono::steady_clock::duration wait;
+        if (takeNext(packet, wait))
+        {
+            lock.unlock();
+            transmit(packet);
+            lock.lock();
+            continue;
+        }
+
+        bool empty = std::all_of(queues.begin(), queues.end(), [](const auto &queue)
+                                 { return queue.empty(); });
+        if (stopping && empty)
+            break;
+
+        pruneBuckets(std::chrono::steady_clock::now());
+        if (wait == std::chrono::steady_clock::duration::max())
+        {
+            cv.wait_for(lock, std::chrono::milliseconds(stopping ? 10 : 1000));
+        }
+        else
+        {
+            cv.wait_for(lock, wait);
+        }
+    }
+
+    // Délai de vidage écoulé : le reste est abandonné (réparé par resynchronisation au redémarrage)
+    running = false;
+    for (size_t p = 0; p < PRIORITY_COUNT; ++p)
+    {
+        droppedPackets[p]->inc(queues[p].size());
+        queues[p].clear();
+    }
+}
+
+void TransmitScheduler::transmit(const Packet &packet)
+{
+    if (!transport.send(packet.destIp, packet.port, *packet.payload))
+        return;
+    sentPackets[static_cast<size_t>(packet.priority)]->inc();
+    sentBytes[static_cast<size_t>(packet.priority)]->inc(packet.payload->size());
+}
+
+std::array<size_t, TransmitScheduler::PRIORITY_COUNT> TransmitScheduler::getQueueDepths() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::array<size_t, PRIORITY_COUNT> depths{};
+    for (size_t p = 0; p < PRIORITY_COUNT; ++p)
+    {
+        depths[p] = queues[p].size();
+    }
+    return depths;
+}
+
+size_t TransmitScheduler::getDropped() const
+{
+    size_t total = 0;
+    for (const auto *counter : droppedPackets)
+    {
+        total += counter->get();
+    }
+    return total;
+}
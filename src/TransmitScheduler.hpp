@@ -0,0 +1,92 @@
+#pragma once
+#include <string>
+#include <deque>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <unordered_map>
+#include "Metrics.hpp"
+#include "Transport.hpp"
+
+// Ordonnanceur d'émission : un thread dédié devant le transport, classes à priorité stricte
+// (Hello > acks/contrôle > mises à jour LSA > synchronisation en masse) et lissage par
+// seau à jetons par destination pour les deux classes LSA. Les émetteurs ne bloquent jamais.
+// BFD garde sa propre socket et son propre thread, au-dessus de toutes ces classes.
+class TransmitScheduler
+{
+public:
+    enum class Priority
+    {
+        Hello = 0,
+        Control = 1, // LS_ACK, LS_REQUEST, requêtes d'arbre de hachage
+        Update = 2,  // Inondation et retransmissions de LSA
+        Bulk = 3     // Descriptions de base, réponses aux requêtes, réponses CLI
+    };
+    static constexpr size_t PRIORITY_COUNT = 4;
+
+    // Lissage par voisin des classes Update/Bulk
+    static constexpr double PACING_RATE_BYTES = 2'000'000.0; // octets/s
+    static constexpr double PACING_BURST_BYTES = 256 * 1024.0;
+    // Au-delà, les paquets LSA sont abandonnés (réparés par retransmission/resynchronisation)
+    static constexpr size_t MAX_QUEUED_PER_CLASS = 4096;
+
+    TransmitScheduler(Transport &transport, MetricsRegistry &metrics);
+    ~TransmitScheduler();
+
+    bool start();
+    // Arrêt sans attente : le thread vide les files (borné à DRAIN_TIMEOUT) puis se termine seul ;
+    // start() ou stop() le rejoignent. Les envois postérieurs partent directement.
+    void finish();
+    // finish() puis attente de la fin du vidage
+    void stop();
+
+    // Hors fonctionnement (CLI avant start), l'envoi est immédiat
+    void enqueue(const std::string &destIp, int port, std::shared_ptr<const std::string> payload, Priority priority);
+    void enqueue(const std::string &destIp, int port, std::string payload, Priority priority);
+
+    std::array<size_t, PRIORITY_COUNT> getQueueDepths() const;
+    size_t getDropped() const;
+
+private:
+    static constexpr std::chrono::milliseconds DRAIN_TIMEOUT{200};
+    static constexpr std::chrono::seconds IDLE_BUCKET_TIMEOUT{60};
+    static constexpr size_t MAX_PACING_SCAN = 256; // Paquets examinés par classe à chaque décision
+    static const char *const CLASS_NAMES[PRIORITY_COUNT];
+
+    struct Packet
+    {
+        std::string destIp;
+        int port;
+        std::shared_ptr<const std::string> payload;
+        Priority priority;
+    };
+
+    struct TokenBucket
+    {
+        double tokens = PACING_BURST_BYTES;
+        std::chrono::steady_clock::time_point lastRefill;
+    };
+
+    void run();
+    void transmit(const Packet &packet);
+    // Sous verrou : paquet éligible le plus prioritaire, sinon délai avant le prochain jeton
+    bool takeNext(Packet &out, std::chrono::steady_clock::duration &wait);
+    void pruneBuckets(std::chrono::steady_clock::time_point now);
+
+    Transport &transport;
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::array<std::deque<Packet>, PRIORITY_COUNT> queues;
+    std::unordered_map<std::string, TokenBucket> buckets; // destination -> jetons
+    std::chrono::steady_clock::time_point lastPrune;
+    // Compteurs exportés, par classe
+    std::array<Counter *, PRIORITY_COUNT> sentPackets{};
+    std::array<Counter *, PRIORITY_COUNT> sentBytes{};
+    std::array<Counter *, PRIORITY_COUNT> droppedPackets{};
+    bool running = false;
+    bool stopping = false;
+    std::thread worker;
+};
@@ -0,0 +1,146 @@
+#include "Transport.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+UdpTransport::UdpTransport()
+{
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0)
+        perror("eventfd");
+}
+
+UdpTransport::~UdpTransport()
+{
+    close();
+    if (txSock >= 0)
+    {
+        ::close(txSock);
+    }
+    if (wakeFd >= 0)
+    {
+        ::close(wakeFd);
+    }
+}
+
+bool UdpTransport::open(int port)
+{
+    rxSock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (rxSock < 0)
+    {
+        perror("socket");
+        return false;
+    }
+
+    // Set socket as non-blocking
+    int flags = fcntl(rxSock, F_GETFL, 0);
+    fcntl(rxSock, F_SETFL, flags | O_NONBLOCK);
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = INADDR_ANY;
+
+    if (bind(rxSock, (sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        perror("bind");
+        ::close(rxSock);
+        rxSock = -1;
+        return false;
+    }
+    return true;
+}
+
+void UdpTransport::close()
+{
+    if (rxSock >= 0)
+    {
+        ::close(rxSock);
+        rxSock = -1;
+    }
+}
+
+ssize_t UdpTransport::receive(char *buffer, size_t size, std::string &senderIp)
+{
+    sockaddr_in sender{};
+    socklen_t senderLen = sizeof(sender);
+    ssize_t len = recvfrom(rxSock, buffer, size, 0, (sockaddr *)&sender, &senderLen);
+    if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return 0;
+    if (len < 0)
+        return -1;
+
+    char ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &sender.sin_addr, ip, INET_ADDRSTRLEN);
+    senderIp = ip;
+    return len;
+}
+
+bool UdpTransport::send(const std::string &destIp, int port, const std::string &payload)
+{
+    {
+        std::lock_guard<std::mutex> lock(txMutex);
+        if (txSock < 0)
+        {
+            txSock = socket(AF_INET, SOCK_DGRAM, 0);
+            if (txSock < 0)
+            {
+                perror("socket");
+                return false;
+            }
+
+            int broadcastEnable = 1;
+            if (setsockopt(txSock, SOL_SOCKET, SO_BROADCAST, &broadcastEnable, sizeof(broadcastEnable)) < 0)
+            {
+                perror("Error: setsockopt SO_BROADCAST");
+            }
+        }
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+
+    if (inet_pton(AF_INET, destIp.c_str(), &addr.sin_addr) <= 0)
+    {
+        LOG_WARN("transport", "Invalid address: %s", destIp.c_str());
+        return false;
+    }
+
+    if (sendto(txSock, payload.data(), payload.size(), 0, (sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        LOG_WARN("transport", "sendto %s: %s", destIp.c_str(), std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void UdpTransport::wait(std::chrono::nanoseconds timeout)
+{
+    // Réveil dès l'arrivée d'un paquet (RTT Hello fiable) ou d'un événement d'un autre thread
+    pollfd fds[2] = {{rxSock, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    timespec ts{static_cast<time_t>(std::max<int64_t>(seconds.count(), 0)),
+                static_cast<long>(std::max<int64_t>((timeout - seconds).count(), 0))};
+    if (ppoll(fds, 2, &ts, nullptr) > 0 && (fds[1].revents & POLLIN))
+    {
+        uint64_t count;
+        if (::read(wakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+            perror("eventfd read");
+    }
+}
+
+void UdpTransport::wake()
+{
+    uint64_t one = 1;
+    if (::write(wakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        perror("eventfd write");
+}
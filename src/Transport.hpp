@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <chrono>
+#include <mutex>
+#include <sys/types.h>
+
+// Transport des datagrammes du protocole (Hello, LSA, acks...). UDP en production ;
+// le simulateur branche un tissu en mémoire à la place. BFD garde sa propre socket.
+class Transport
+{
+public:
+    virtual ~Transport() = default;
+
+    // Point de réception sur le port du protocole
+    virtual bool open(int port) = 0;
+    virtual void close() = 0;
+
+    // Sans attente : longueur reçue, 0 si aucun datagramme en attente, -1 si erreur
+    virtual ssize_t receive(char *buffer, size_t size, std::string &senderIp) = 0;
+    // Appelable depuis plusieurs threads ; les adresses x.x.x.255 sont diffusées
+    virtual bool send(const std::string &destIp, int port, const std::string &payload) = 0;
+
+    // Réacteur du démon : attend un datagramme, un wake() ou la fin du délai
+    virtual void wait(std::chrono::nanoseconds timeout) = 0;
+    // Depuis n'importe quel thread ; sans attente en cours, le prochain wait() rend la main aussitôt
+    virtual void wake() = 0;
+};
+
+class UdpTransport : public Transport
+{
+public:
+    UdpTransport();
+    ~UdpTransport() override;
+
+    bool open(int port) override;
+    void close() override;
+    ssize_t receive(char *buffer, size_t size, std::string &senderIp) override;
+    bool send(const std::string &destIp, int port, const std::string &payload) override;
+    void wait(std::chrono::nanoseconds timeout) override;
+    void wake() override;
+
+private:
+    int rxSock = -1;
+    int wakeFd = -1; // eventfd : réveils cumulés jusqu'au prochain wait()
+    int txSock = -1; // SO_BROADCAST, partagée par tous les émetteurs (sendto est atomique)
+    std::mutex txMutex; // Création paresseuse de txSock
+};
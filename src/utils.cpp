@@ -72,10 +72,70 @@ std::map<std::string, RouterConfig> parseRouterConfig(const std::string &configF
             {
                 currentConfig.interfacesNames = split(value, ',');
             }
+            else if (key == "summaries")
+            {
+                currentConfig.summaries = split(value, ',');
+            }
             else if (key == "port")
             {
                 currentConfig.port = std::stoi(value);
             }
+            else if (key == "bfd")
+            {
+                currentConfig.bfdEnabled = (value != "off" && value != "false" && value != "0");
+            }
+            else if (key == "bfdPort")
+            {
+                currentConfig.bfdPort = std::stoi(value);
+            }
+            else if (key == "bfdInterval")
+            {
+                currentConfig.bfdInterval = std::stoi(value);
+            }
+            else if (key == "bfdMultiplier")
+            {
+                currentConfig.bfdMultiplier = std::stoi(value);
+            }
+            else if (key == "floodReduction")
+            {
+                currentConfig.floodReduction = (value == "on" || value == "true" || value == "1");
+            }
+            else if (key == "metrics")
+            {
+                currentConfig.metricsEnabled = (value != "off" && value != "false" && value != "0");
+            }
+            else if (key == "metricsPort")
+            {
+                currentConfig.metricsPort = std::stoi(value);
+            }
+            else if (key == "capture")
+            {
+                currentConfig.capturePath = value;
+            }
+            else if (key == "captureBufferKb")
+            {
+                currentConfig.captureBufferKb = std::stoi(value);
+            }
+            else if (key == "trace")
+            {
+                currentConfig.traceEnabled = (value == "on" || value == "true" || value == "1");
+            }
+            else if (key == "traceEventsPerThread")
+            {
+                currentConfig.traceEventsPerThread = std::stoi(value);
+            }
+            else if (key == "logLevel")
+            {
+                currentConfig.logLevel = value;
+            }
+            else if (key == "logFile")
+            {
+                currentConfig.logFile = value;
+            }
+            else if (key == "logFormat")
+            {
+                currentConfig.logFormat = value;
+            }
         }
     }
 
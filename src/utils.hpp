@@ -11,13 +11,42 @@
 #include <ifaddrs.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <cstdint>
+#include "Logger.hpp"
 
 struct RouterConfig
 {
     std::string hostname;
     std::vector<std::string> interfaces;
     std::vector<std::string> interfacesNames;
+    std::vector<std::string> summaries; // Plages de résumé annoncées à la place des réseaux couverts
     int port;
+
+    // Détection de panne rapide (BFD), à activer explicitement
+    bool bfdEnabled = false;
+    int bfdPort = 3784;
+    int bfdInterval = 50; // millisecondes
+    int bfdMultiplier = 3;
+
+    // Inondation réduite sur une topologie couvrante (RFC 9667)
+    bool floodReduction = false;
+
+    // Export Prometheus (HTTP sur 127.0.0.1), à activer explicitement
+    bool metricsEnabled = false;
+    int metricsPort = 9464;
+
+    // Capture des datagrammes reçus dès le démarrage (vide : désactivée, activable depuis la CLI)
+    std::string capturePath;
+    int captureBufferKb = 4096;
+
+    // Traçage par phases (Chrome/Perfetto), activable aussi depuis la CLI
+    bool traceEnabled = false;
+    int traceEventsPerThread = 16384;
+
+    // Journal asynchrone du processus (Logger) : niveau, fichier (vide : stderr), format text|json
+    std::string logLevel = "info";
+    std::string logFile;
+    std::string logFormat = "text";
 };
 
 std::map<std::string, RouterConfig> parseRouterConfig(const std::string &configFile);
@@ -45,23 +74,33 @@ inline std::string toHex(const std::string &input)
     return oss.str();
 }
 
-inline void addRoute(const std::string &dest, const std::string &nextHop, const std::string &iface)
+inline bool addRoute(const std::string &dest, const std::string &nextHop, const std::string &iface)
 {
-    std::cout << "DEBUG addRoute: dest=" << dest << ", nextHop=" << nextHop << ", iface=" << iface << std::endl;
-    
     std::string command = "ip route replace " + dest + " via " + nextHop + " dev " + iface;
-    std::cout << "DEBUG executing: " << command << std::endl;
-    
     int result = std::system(command.c_str());
-    
+
     if (result == 0)
     {
-        std::cout << "DEBUG Route added successfully: " << dest << " via " << nextHop << " dev " << iface << std::endl;
+        LOG_DEBUG("fib", "Route added: %s via %s dev %s", dest.c_str(), nextHop.c_str(), iface.c_str());
     }
     else
     {
-        std::cout << "ERROR Failed to add route: " << command << " (exit code: " << result << ")" << std::endl;
+        LOG_ERROR("fib", "Failed to add route: %s (exit code: %d)", command.c_str(), result);
     }
+    return result == 0;
+}
+
+// Retire une route installée par addRoute (proto boot : jamais les routes connectées du noyau)
+inline bool deleteRoute(const std::string &dest)
+{
+    std::string command = "ip route del " + dest + " proto boot";
+    int result = std::system(command.c_str());
+
+    if (result != 0)
+    {
+        LOG_ERROR("fib", "Failed to delete route: %s (exit code: %d)", command.c_str(), result);
+    }
+    return result == 0;
 }
 
 inline std::vector<std::pair<std::string, std::string>> getLocalIpInterfaceMapping()
@@ -84,3 +123,56 @@ inline std::vector<std::pair<std::string, std::string>> getLocalIpInterfaceMappi
     freeifaddrs(ifaddr);
     return result;
 }
+
+struct LocalInterfaceAddress
+{
+    std::string ip;
+    std::string name;
+    uint8_t prefixLength = 24;
+
+    bool operator==(const LocalInterfaceAddress &other) const
+    {
+        return ip == other.ip && name == other.name && prefixLength == other.prefixLength;
+    }
+};
+
+// Comme getLocalIpInterfaceMapping, avec la longueur de préfixe issue du netmask
+inline std::vector<LocalInterfaceAddress> getLocalInterfaceAddresses()
+{
+    std::vector<LocalInterfaceAddress> result;
+    struct ifaddrs *ifaddr, *ifa;
+    if (getifaddrs(&ifaddr) == -1)
+        return result;
+
+    for (ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next)
+    {
+        if (ifa->ifa_addr && ifa->ifa_addr->sa_family == AF_INET)
+        {
+            char ip[INET_ADDRSTRLEN];
+            void *addr = &((struct sockaddr_in *)ifa->ifa_addr)->sin_addr;
+            inet_ntop(AF_INET, addr, ip, INET_ADDRSTRLEN);
+
+            LocalInterfaceAddress entry;
+            entry.ip = ip;
+            entry.name = ifa->ifa_name;
+            if (ifa->ifa_netmask)
+            {
+                uint32_t mask = ntohl(((struct sockaddr_in *)ifa->ifa_netmask)->sin_addr.s_addr);
+                entry.prefixLength = static_cast<uint8_t>(__builtin_popcount(mask));
+            }
+            result.push_back(entry);
+        }
+    }
+    freeifaddrs(ifaddr);
+    return result;
+}
+
+// Convertit une adresse IPv4 en entier (ordre hôte), false si invalide
+inline bool parseIpv4(const std::string &ip, uint32_t &out)
+{
+    in_addr addr{};
+    if (inet_pton(AF_INET, ip.c_str(), &addr) != 1)
+        return false;
+    out = ntohl(addr.s_addr);
+    return true;
+}
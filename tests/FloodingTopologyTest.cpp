@@ -0,0 +1,197 @@
+// Topologie d'inondation réduite : tout pont du sous-graphe est un pont du réseau, la panne d'un
+// lien redondant ne coupe donc jamais l'inondation.
+//
+// Compilation : voir README (Tests de non-régression)
+#include "../src/FloodingTopology.hpp"
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+
+namespace
+{
+    using Graph = std::map<std::string, std::set<std::string>>;
+
+    int failures = 0;
+
+    void expect(bool condition, const std::string &what)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << what << std::endl;
+            failures++;
+        }
+    }
+
+    void link(Graph &graph, const std::string &a, const std::string &b)
+    {
+        graph[a].insert(b);
+        graph[b].insert(a);
+    }
+
+    // Sous-graphe d'inondation vu par chaque routeur, à partir d'une LSDB complète
+    Graph floodingSubgraph(const Graph &graph)
+    {
+        VirtualClock clock;
+        TimerWheel timers(clock);
+        TopologyDatabase topoDb(timers);
+        for (const auto &[routerId, neighbors] : graph)
+        {
+            topoDb.updateLSA({{"type", "LSA"},
+                              {"hostname", routerId},
+                              {"sequence_number", 1},
+                              {"age", 0},
+                              {"neighbors", std::vector<std::string>(neighbors.begin(), neighbors.end())},
+                              {"networks", nlohmann::json::array()}});
+        }
+
+        Graph flooding;
+        for (const auto &[routerId, neighbors] : graph)
+        {
+            FloodingTopology topology(routerId);
+            topology.refresh(topoDb);
+            std::set<std::string> relays;
+            expect(topology.selectRelays({neighbors.begin(), neighbors.end()}, relays),
+                   routerId + " selects relays on a complete LSDB");
+            for (const auto &relay : relays)
+                flooding[routerId].insert(relay);
+        }
+        return flooding;
+    }
+
+    bool connectedWithout(const Graph &graph, const std::string &a, const std::string &b)
+    {
+        std::set<std::string> visited{a};
+        std::vector<std::string> pending{a};
+        while (!pending.empty())
+        {
+            std::string u = pending.back();
+            pending.pop_back();
+            auto it = graph.find(u);
+            if (it == graph.end())
+                continue;
+            for (const auto &v : it->second)
+            {
+                if ((u == a && v == b) || (u == b && v == a))
+                    continue;
+                if (visited.insert(v).second)
+                    pending.push_back(v);
+            }
+        }
+        return visited.count(b) > 0;
+    }
+
+    void checkNoAvoidableBridge(const std::string &name, const Graph &graph)
+    {
+        Graph flooding = floodingSubgraph(graph);
+        for (const auto &[u, relays] : flooding)
+        {
+            for (const auto &v : relays)
+            {
+                expect(flooding[v].count(u) > 0, name + ": flooding edge " + u + "-" + v + " is symmetric");
+                if (u < v && !connectedWithout(flooding, u, v) && connectedWithout(graph, u, v))
+                    expect(false, name + ": flooding edge " + u + "-" + v + " is a bridge of the subgraph only");
+            }
+        }
+    }
+}
+
+int main()
+{
+    // R racine, M et Z ses enfants reliés entre eux, chacun avec deux feuilles reliées entre elles :
+    // l'arbre complété aux feuilles garde R-M et R-Z comme ponts, M-Z doit être ajouté
+    Graph twoBranches;
+    link(twoBranches, "R0", "R1");
+    link(twoBranches, "R0", "R2");
+    link(twoBranches, "R1", "R2");
+    link(twoBranches, "R1", "R3");
+    link(twoBranches, "R1", "R4");
+    link(twoBranches, "R3", "R4");
+    link(twoBranches, "R2", "R5");
+    link(twoBranches, "R2", "R6");
+    link(twoBranches, "R5", "R6");
+    checkNoAvoidableBridge("two branches", twoBranches);
+    expect(floodingSubgraph(twoBranches)["R1"].count("R2") > 0, "two branches: M-Z link is flooded");
+
+    // Un pont du réseau reste un pont, sans faire échouer le calcul
+    Graph barbell = twoBranches;
+    link(barbell, "R6", "R7");
+    link(barbell, "R7", "R8");
+    link(barbell, "R7", "R9");
+    link(barbell, "R8", "R9");
+    checkNoAvoidableBridge("barbell", barbell);
+
+    Graph ring;
+    for (int i = 0; i < 12; i++)
+        link(ring, "R" + std::to_string(10 + i), "R" + std::to_string(10 + (i + 1) % 12));
+    checkNoAvoidableBridge("ring", ring);
+
+    Graph grid;
+    auto cell = [](int row, int column)
+    { return "R" + std::to_string(100 + row * 10 + column); };
+    for (int row = 0; row < 6; row++)
+    {
+        for (int column = 0; column < 6; column++)
+        {
+            if (column + 1 < 6)
+                link(grid, cell(row, column), cell(row, column + 1));
+            if (row + 1 < 6)
+                link(grid, cell(row, column), cell(row + 1, column));
+        }
+    }
+    checkNoAvoidableBridge("grid", grid);
+
+    std::mt19937 rng(7);
+    for (int run = 0; run < 20; run++)
+    {
+        Graph random;
+        const int routers = 30;
+        for (int i = 1; i < routers; i++)
+            link(random, "R" + std::to_string(100 + i), "R" + std::to_string(100 + rng() % i));
+        for (int extra = 0; extra < routers / 2; extra++)
+        {
+            int a = rng() % routers, b = rng() % routers;
+            if (a != b)
+                link(random, "R" + std::to_string(100 + a), "R" + std::to_string(100 + b));
+        }
+        checkNoAvoidableBridge("random " + std::to_string(run), random);
+    }
+
+    // LSA reçu entre deux passes du réacteur : adjacences changées, inonder partout jusqu'au refresh
+    {
+        VirtualClock clock;
+        TimerWheel timers(clock);
+        TopologyDatabase topoDb(timers);
+        auto lsa = [](const std::string &routerId, const std::vector<std::string> &neighbors, int sequence)
+        {
+            return nlohmann::json{{"type", "LSA"}, {"hostname", routerId}, {"sequence_number", sequence},
+                                  {"age", 0}, {"neighbors", neighbors}, {"networks", nlohmann::json::array()}};
+        };
+        for (const auto &[routerId, neighbors] : ring)
+            topoDb.updateLSA(lsa(routerId, {neighbors.begin(), neighbors.end()}, 1));
+
+        FloodingTopology topology("R10");
+        topology.refresh(topoDb);
+        std::set<std::string> relays;
+        const std::vector<std::string> adjacent{"R11", "R21"};
+        expect(topology.selectRelays(adjacent, relays), "stale: reduced flooding on a settled LSDB");
+
+        auto sameNeighbors = lsa("R15", {"R14", "R16"}, 2);
+        topoDb.updateLSA(sameNeighbors);
+        topology.noteInstalled(sameNeighbors);
+        expect(topology.selectRelays(adjacent, relays), "stale: refreshed LSA with the same neighbors keeps reduction");
+
+        auto lostLink = lsa("R15", {"R14"}, 3);
+        topoDb.updateLSA(lostLink);
+        topology.noteInstalled(lostLink);
+        expect(!topology.selectRelays(adjacent, relays), "stale: changed adjacencies flood everywhere");
+
+        topology.refresh(topoDb);
+        expect(topology.selectRelays(adjacent, relays), "stale: reduction resumes after refresh");
+    }
+
+    if (failures)
+        return EXIT_FAILURE;
+    std::cout << "flooding topology: all checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
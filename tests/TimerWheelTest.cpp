@@ -0,0 +1,100 @@
+// Roue de temporisation : une échéance est mesurée depuis l'horloge, même quand son propriétaire
+// (réacteur, exécution pas à pas) n'a pas appelé advance() depuis longtemps.
+//
+//   g++ -std=c++17 -O2 -pthread tests/TimerWheelTest.cpp src/TimerWheel.cpp -o timer_wheel_test
+#include "../src/TimerWheel.hpp"
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool condition, const std::string &what)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << what << std::endl;
+            failures++;
+        }
+    }
+
+    // Avance par pas de 1 ms jusqu'à l'expiration ; rend le délai écoulé depuis 'armed'
+    std::chrono::milliseconds runUntilFired(VirtualClock &clock, TimerWheel &wheel, const bool &fired,
+                                            ProtocolClock::time_point armed, std::chrono::seconds limit)
+    {
+        while (!fired && clock.now() - armed < limit)
+        {
+            clock.advance(std::chrono::milliseconds(1));
+            wheel.advance(clock.now());
+        }
+        return std::chrono::duration_cast<std::chrono::milliseconds>(clock.now() - armed);
+    }
+
+    void scheduleAfterIdleGap()
+    {
+        VirtualClock clock;
+        TimerWheel wheel(clock);
+        wheel.advance(clock.now());
+
+        // Aucun advance() pendant 20 s, puis temporisation de 30 s (délai de mort d'un voisin)
+        clock.advance(std::chrono::seconds(20));
+        bool fired = false;
+        auto armed = clock.now();
+        wheel.schedule(std::chrono::seconds(30), [&]()
+                       { fired = true; });
+        expect(wheel.nextExpiry() && *wheel.nextExpiry() >= armed + std::chrono::seconds(30),
+               "nextExpiry after idle gap is not before the requested delay");
+
+        auto elapsed = runUntilFired(clock, wheel, fired, armed, std::chrono::seconds(40));
+        expect(fired, "timer armed after idle gap fires");
+        expect(elapsed >= std::chrono::seconds(30), "timer armed after idle gap does not fire early");
+        expect(elapsed <= std::chrono::milliseconds(30010), "timer armed after idle gap fires within one tick");
+    }
+
+    void restartAfterIdleGap()
+    {
+        VirtualClock clock;
+        TimerWheel wheel(clock);
+        bool fired = false;
+        auto id = wheel.schedule(std::chrono::seconds(30), [&]()
+                                 { fired = true; });
+
+        // Hello reçu 25 s plus tard, roue non avancée entre-temps : réarmement pour 30 s
+        clock.advance(std::chrono::seconds(25));
+        auto armed = clock.now();
+        expect(wheel.restart(id, std::chrono::seconds(30)), "restart of a pending timer");
+
+        auto elapsed = runUntilFired(clock, wheel, fired, armed, std::chrono::seconds(40));
+        expect(fired, "restarted timer fires");
+        expect(elapsed >= std::chrono::seconds(30), "restarted timer does not fire early");
+    }
+
+    void longerThanOneRevolution()
+    {
+        // 512 seaux de 10 ms : 5,12 s par tour
+        VirtualClock clock;
+        TimerWheel wheel(clock);
+        clock.advance(std::chrono::seconds(3));
+        bool fired = false;
+        auto armed = clock.now();
+        wheel.schedule(std::chrono::seconds(12), [&]()
+                       { fired = true; });
+
+        auto elapsed = runUntilFired(clock, wheel, fired, armed, std::chrono::seconds(20));
+        expect(elapsed >= std::chrono::seconds(12) && elapsed <= std::chrono::milliseconds(12010),
+               "multi-revolution timer fires on time");
+    }
+}
+
+int main()
+{
+    scheduleAfterIdleGap();
+    restartAfterIdleGap();
+    longerThanOneRevolution();
+
+    if (failures)
+        return EXIT_FAILURE;
+    std::cout << "timer wheel: all checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
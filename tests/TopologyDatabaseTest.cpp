@@ -0,0 +1,88 @@
+// Calcul des routes sur la LSDB : un réseau connecté reste local même quand notre LSA n'en
+// annonce que l'agrégat ; la purge d'un LSA MaxAge notifie la LSDB modifiée.
+//
+// Compilation : voir README (Tests de non-régression)
+#include "../src/TopologyDatabase.hpp"
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool condition, const std::string &what)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << what << std::endl;
+            failures++;
+        }
+    }
+
+    nlohmann::json routerLSA(const std::string &hostname, const std::vector<std::string> &neighbors,
+                             const std::vector<std::string> &networks)
+    {
+        return {{"type", "LSA"},
+                {"hostname", hostname},
+                {"sequence_number", 1},
+                {"age", 0},
+                {"neighbors", neighbors},
+                {"networks", networks},
+                {"link_capacities", std::vector<double>(neighbors.size(), 100.0)},
+                {"link_states", std::vector<bool>(neighbors.size(), true)}};
+    }
+}
+
+int main()
+{
+    VirtualClock clock;
+    TimerWheel timers(clock);
+    TopologyDatabase topoDb(timers);
+
+    // R1 connecté à 10.1.1.0/24 mais n'annonce que le résumé 10.1.0.0/16
+    nlohmann::json self = routerLSA("R1", {"R2"}, {"10.1.0.0/16"});
+    self["network_interfaces"] = {{{"network", "10.1.1.0/24"}, {"interface_ip", "10.1.1.1"}, {"interface_name", "eth1"}}};
+    topoDb.updateLSA(self);
+    topoDb.updateLSA(routerLSA("R2", {"R1", "R3"}, {"10.1.1.0/24", "192.168.5.0/24"}));
+    topoDb.updateLSA(routerLSA("R3", {"R2"}, {"10.1.1.128/25", "10.0.0.0/8", "172.16.0.0/16"}));
+
+    auto table = topoDb.computeRoutingTable("R1").table;
+    expect(!table.count("10.1.1.0/24"), "connected /24 inside our summary is not routed via a neighbor");
+    expect(!table.count("10.1.1.128/25"), "more specific prefix of a connected subnet is not routed");
+    expect(!table.count("10.0.0.0/8"), "remote aggregate covering a connected subnet is not routed");
+    expect(table.count("192.168.5.0/24") && table["192.168.5.0/24"] == "R2", "remote /24 routed via R2");
+    expect(table.count("172.16.0.0/16") && table["172.16.0.0/16"] == "R2", "remote /16 routed via R2");
+
+    // LSA sans network_interfaces (ancienne version) : "networks" reste la référence
+    topoDb.updateLSA(routerLSA("R4", {}, {"192.168.5.0/24"}));
+    auto legacy = topoDb.computeRoutingTable("R4").table;
+    expect(!legacy.count("192.168.5.0/24"), "legacy LSA: advertised network stays local");
+
+    // LSA vieilli jusqu'à MaxAge puis purgé : chaque étape notifie le démon (nouvelle SPF)
+    {
+        VirtualClock agingClock;
+        TimerWheel agingTimers(agingClock);
+        TopologyDatabase agingDb(agingTimers);
+        agingDb.updateLSA(routerLSA("R9", {}, {"10.9.0.0/24"}));
+        int changes = 0;
+        agingDb.setChangeHandler([&]()
+                                 { changes++; });
+
+        agingClock.advance(TopologyDatabase::MAX_AGE);
+        agingTimers.advance(agingClock.now());
+        expect(changes == 1, "aging: reaching MaxAge notifies a change");
+
+        uint64_t generation = agingDb.getGeneration();
+        agingClock.advance(TopologyDatabase::MAX_AGE_HOLD);
+        agingTimers.advance(agingClock.now());
+        nlohmann::json purged;
+        expect(!agingDb.getLSA("R9", purged), "aging: MaxAge LSA removed after the hold time");
+        expect(changes == 2, "aging: removing a MaxAge LSA notifies a change");
+        expect(agingDb.getGeneration() != generation, "aging: removal bumps the generation");
+    }
+
+    if (failures)
+        return EXIT_FAILURE;
+    std::cout << "topology database: all checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}